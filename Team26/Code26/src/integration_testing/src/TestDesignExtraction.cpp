@@ -1,61 +1,16 @@
 #include "catch.hpp"
 
+#include <list>
+#include <sstream>
+#include <string>
+#include <vector>
+
 #include "DesignExtractor.h"
+#include "MaterialisationPolicy.h"
+#include "SimpleParser.h"
 #include "Table.h"
-
-TEST_CASE("[TestDesignExtractor] ParentT extraction") {
-  Pkb pkb;
-  SourceProcessor::DesignExtractor designExtractor(pkb);
-
-  pkb.addWhile(1);
-  pkb.addWhile(2);
-  pkb.addWhile(3);
-  pkb.addAssign(4);
-
-  pkb.addParent(1, 2);
-  pkb.addParent(2, 3);
-  pkb.addParent(3, 4);
-
-  designExtractor.extractDesignAbstractions();
-  Table parentTTable = pkb.getParentTTable();
-
-  REQUIRE(parentTTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(2) }));
-  REQUIRE(parentTTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(3) }));
-  REQUIRE(parentTTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(4) }));
-
-  REQUIRE(parentTTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromStmtNum(3) }));
-  REQUIRE(parentTTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromStmtNum(4) }));
-
-  REQUIRE(parentTTable.contains({ pkb.getIntRefFromStmtNum(3), pkb.getIntRefFromStmtNum(4) }));
-  REQUIRE(parentTTable.size() == 6);
-}
-
-TEST_CASE("[TestDesignExtractor] FollowsT extraction") {
-  Pkb pkb;
-  SourceProcessor::DesignExtractor designExtractor(pkb);
-
-  pkb.addAssign(1);
-  pkb.addAssign(2);
-  pkb.addAssign(3);
-  pkb.addAssign(4);
-
-  pkb.addFollows(1, 2);
-  pkb.addFollows(2, 3);
-  pkb.addFollows(3, 4);
-
-  designExtractor.extractDesignAbstractions();
-  Table followsTTable = pkb.getFollowsTTable();
-
-  REQUIRE(followsTTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(2) }));
-  REQUIRE(followsTTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(3) }));
-  REQUIRE(followsTTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(4) }));
-
-  REQUIRE(followsTTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromStmtNum(3) }));
-  REQUIRE(followsTTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromStmtNum(4) }));
-
-  REQUIRE(followsTTable.contains({ pkb.getIntRefFromStmtNum(3), pkb.getIntRefFromStmtNum(4) }));
-  REQUIRE(followsTTable.size() == 6);
-}
+#include "Token.h"
+#include "Tokeniser.h"
 
 TEST_CASE("[TestDesignExtractor] CallsT extraction") {
   Pkb pkb;
@@ -162,26 +117,6 @@ TEST_CASE("[TestDesignExtractor] NextT extraction") {
   REQUIRE(!(nextTTable.contains({ pkb.getIntRefFromStmtNum(8), pkb.getIntRefFromStmtNum(9) })));
 }
 
-TEST_CASE("[TestDesignExtractor] Uses(s != c, v) in container => Uses(ifs/w, v)") {
-  Pkb pkb;
-  SourceProcessor::DesignExtractor designExtractor(pkb);
-
-  pkb.addWhile(1);
-  pkb.addWhile(2);
-  pkb.addPrint(3);
-  pkb.addVar("z");
-
-  pkb.addParent(1, 2);
-  pkb.addParent(2, 3);
-  pkb.addUsesS(3, "z");
-
-  designExtractor.extractDesignAbstractions();
-  Table usesSTable = pkb.getUsesSTable();
-
-  REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromEntity("z") }));
-  REQUIRE(usesSTable.size() == 3);
-}
-
 TEST_CASE("[TestDesignExtractor] Indirect UsesP extraction") {
   Pkb pkb;
   SourceProcessor::DesignExtractor designExtractor(pkb);
@@ -252,26 +187,6 @@ TEST_CASE("[TestDesignExtractor] Uses(c, v) in container => Uses(ifs/w, v)") {
   REQUIRE(usesPTable.contains({ pkb.getIntRefFromEntity("p2"), pkb.getIntRefFromEntity("x") }));
 }
 
-TEST_CASE("[TestDesignExtractor] Modifies(s != c, v) in container => Modifies(ifs/w, v)") {
-  Pkb pkb;
-  SourceProcessor::DesignExtractor designExtractor(pkb);
-
-  pkb.addWhile(1);
-  pkb.addWhile(2);
-  pkb.addRead(3);
-  pkb.addVar("z");
-
-  pkb.addParent(1, 2);
-  pkb.addParent(2, 3);
-  pkb.addModifiesS(3, "z");
-
-  designExtractor.extractDesignAbstractions();
-  Table modifiesSTable = pkb.getModifiesSTable();
-
-  REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromEntity("z") }));
-  REQUIRE(modifiesSTable.size() == 3);
-}
-
 TEST_CASE("[TestDesignExtractor] Indirect ModifiesP extraction") {
   Pkb pkb;
   SourceProcessor::DesignExtractor designExtractor(pkb);
@@ -508,3 +423,207 @@ TEST_CASE("[TestDesignExtractor] AffectsT extraction") {
   REQUIRE(affectsTTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(11) }));
   REQUIRE(affectsTTable.contains({ pkb.getIntRefFromStmtNum(9), pkb.getIntRefFromStmtNum(12) }));
 }
+
+TEST_CASE("[TestDesignExtractor] NextBip and AffectsBip extraction match calls and returns") {
+  // Procedure B is called from both A and C, but a path entering B from A
+  // must return to A, so nothing in A reaches stmt 4 in C.
+  std::stringstream ss;
+  ss << "procedure A { x = 1; call B; }" << std::endl;      // 1, 2
+  ss << "procedure C { call B; z = y; }" << std::endl;      // 3, 4
+  ss << "procedure B { y = x; }" << std::endl;              // 5
+  std::list<Token> tokens = Tokeniser()
+    .notAllowingLeadingZeroes()
+    .consumingWhitespace()
+    .tokenise(ss);
+
+  Pkb pkb;
+  SourceProcessor::SimpleParser(pkb, tokens).parse();
+  SourceProcessor::DesignExtractor(pkb).extractAllDesignAbstractions();
+
+  Table nextBipTable = pkb.getNextBipTable();
+  REQUIRE(nextBipTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(2) }));
+  REQUIRE(nextBipTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromStmtNum(5) }));
+  REQUIRE(nextBipTable.contains({ pkb.getIntRefFromStmtNum(3), pkb.getIntRefFromStmtNum(5) }));
+  REQUIRE(nextBipTable.contains({ pkb.getIntRefFromStmtNum(5), pkb.getIntRefFromStmtNum(4) }));
+  REQUIRE(nextBipTable.size() == 4);
+
+  Table nextBipTTable = pkb.getNextBipTTable();
+  REQUIRE(nextBipTTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(5) }));
+  REQUIRE(nextBipTTable.contains({ pkb.getIntRefFromStmtNum(3), pkb.getIntRefFromStmtNum(4) }));
+  REQUIRE(!nextBipTTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(4) }));
+  REQUIRE(nextBipTTable.size() == 6);
+
+  Table affectsBipTable = pkb.getAffectsBipTable();
+  REQUIRE(affectsBipTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(5) }));
+  REQUIRE(affectsBipTable.contains({ pkb.getIntRefFromStmtNum(5), pkb.getIntRefFromStmtNum(4) }));
+  REQUIRE(affectsBipTable.size() == 2);
+
+  Table affectsBipTTable = pkb.getAffectsBipTTable();
+  REQUIRE(!affectsBipTTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(4) }));
+  REQUIRE(affectsBipTTable.size() == 2);
+}
+
+TEST_CASE("[TestDesignExtractor] NextBipT on demand matches NextBipT extraction") {
+  std::stringstream ss;
+  ss << "procedure A { while (i > 0) { call B; i = i - 1; } x = 1; }" << std::endl;  // 1-4
+  ss << "procedure B { if (x == 1) then { call C; } else { y = 2; } }" << std::endl;  // 5-7
+  ss << "procedure C { z = 3; }" << std::endl;                                         // 8
+  const std::string source = ss.str();
+
+  Pkb eagerPkb;
+  Pkb onDemandPkb;
+  for (Pkb* pkb : { &eagerPkb, &onDemandPkb }) {
+    std::stringstream sourceStream(source);
+    std::list<Token> tokens = Tokeniser()
+      .notAllowingLeadingZeroes()
+      .consumingWhitespace()
+      .tokenise(sourceStream);
+    SourceProcessor::SimpleParser(*pkb, tokens).parse();
+    const SourceProcessor::MaterialisationPolicy& policy = SourceProcessor::MaterialisationPolicy()
+      .withMode(SourceProcessor::DerivedRelation::NEXT_BIP_T, pkb == &onDemandPkb
+        ? SourceProcessor::Materialisation::LAZY
+        : SourceProcessor::Materialisation::EAGER);
+    SourceProcessor::DesignExtractor(*pkb, policy).extractAllDesignAbstractions();
+  }
+
+  const Table& eagerTable = eagerPkb.getNextBipTTable();
+  const Table& onDemandTable = onDemandPkb.getNextBipTTable();
+  REQUIRE(eagerTable.size() == onDemandTable.size());
+  for (const Row& row : eagerTable.getData()) {
+    REQUIRE(onDemandTable.contains(row));
+  }
+
+  // Stmt 8 in C returns into the loop of A through B
+  REQUIRE(onDemandTable.contains({ onDemandPkb.getIntRefFromStmtNum(8), onDemandPkb.getIntRefFromStmtNum(1) }));
+  REQUIRE(onDemandTable.contains({ onDemandPkb.getIntRefFromStmtNum(8), onDemandPkb.getIntRefFromStmtNum(8) }));
+
+  for (int stmt = 1; stmt <= 8; stmt++) {
+    const int intRef = onDemandPkb.getIntRefFromStmtNum(stmt);
+    Table expected = onDemandTable;
+    expected.filterColumn(0, { intRef });
+    const Table& rows = onDemandPkb.getNextBipTTableFrom(intRef);
+    REQUIRE(rows.size() == expected.size());
+    for (const Row& row : expected.getData()) {
+      REQUIRE(rows.contains(row));
+    }
+  }
+}
+
+TEST_CASE("[TestDesignExtractor] Lazy relations are deferred until extracted") {
+  std::stringstream ss;
+  ss << "procedure A { x = 1; while (x > 0) { x = x - 1; call B; } y = x; }" << std::endl;  // 1-5
+  ss << "procedure B { z = x; x = z; }" << std::endl;                                        // 6-7
+  const std::string source = ss.str();
+
+  Pkb eagerPkb;
+  Pkb lazyPkb;
+  std::vector<SourceProcessor::DerivedRelation> deferredRelations;
+  for (Pkb* pkb : { &eagerPkb, &lazyPkb }) {
+    std::stringstream sourceStream(source);
+    std::list<Token> tokens = Tokeniser()
+      .notAllowingLeadingZeroes()
+      .consumingWhitespace()
+      .tokenise(sourceStream);
+    SourceProcessor::SimpleParser(*pkb, tokens).parse();
+
+    const SourceProcessor::MaterialisationPolicy policy(pkb == &lazyPkb
+      ? SourceProcessor::Materialisation::LAZY
+      : SourceProcessor::Materialisation::EAGER);
+    SourceProcessor::DesignExtractor designExtractor(*pkb, policy);
+    designExtractor.extractAllDesignAbstractions();
+    deferredRelations = designExtractor.getDeferredRelations();
+  }
+
+  // Next* and NextBip* are answered on demand instead of being deferred
+  REQUIRE(deferredRelations.size() == 3);
+  REQUIRE(lazyPkb.getNextTTable().getData() == eagerPkb.getNextTTable().getData());
+  REQUIRE(lazyPkb.getAffectsTable().empty());
+  REQUIRE(lazyPkb.getAffectsTTable().empty());
+  REQUIRE(lazyPkb.getAffectsBipTTable().empty());
+  REQUIRE(lazyPkb.getNextBipTTable().size() == eagerPkb.getNextBipTTable().size());
+  REQUIRE(lazyPkb.getAffectsBipTable().size() == eagerPkb.getAffectsBipTable().size());
+
+  SourceProcessor::DesignExtractor designExtractor(lazyPkb);
+  designExtractor.extractDeferredRelation(SourceProcessor::DerivedRelation::AFFECTS);
+  designExtractor.extractDeferredRelation(SourceProcessor::DerivedRelation::AFFECTS_T);
+  designExtractor.extractDeferredRelation(SourceProcessor::DerivedRelation::AFFECTS_BIP_T);
+
+  // Entities are added in the same order, so the integer references match
+  REQUIRE(lazyPkb.getAffectsTable().getData() == eagerPkb.getAffectsTable().getData());
+  REQUIRE(lazyPkb.getAffectsTTable().getData() == eagerPkb.getAffectsTTable().getData());
+  REQUIRE(lazyPkb.getAffectsBipTTable().getData() == eagerPkb.getAffectsBipTTable().getData());
+  REQUIRE(!eagerPkb.getAffectsTTable().empty());
+}
+
+TEST_CASE("[TestDesignExtractor] Lazy relations of a single stmt are searched in both directions") {
+  std::stringstream ss;
+  ss << "procedure A { x = 1; while (x > 0) { if (y > 0) then { x = x - 1; } else { call B; } } y = x; }" << std::endl;  // 1-6
+  ss << "procedure B { z = x; read x; call C; x = z; }" << std::endl;                                                  // 7-10
+  ss << "procedure C { if (z > 0) then { z = z + 1; } else { print z; } }" << std::endl;                              // 11-13
+  const std::string source = ss.str();
+
+  Pkb eagerPkb;
+  Pkb lazyPkb;
+  for (Pkb* pkb : { &eagerPkb, &lazyPkb }) {
+    std::stringstream sourceStream(source);
+    std::list<Token> tokens = Tokeniser()
+      .notAllowingLeadingZeroes()
+      .consumingWhitespace()
+      .tokenise(sourceStream);
+    SourceProcessor::SimpleParser(*pkb, tokens).parse();
+
+    const SourceProcessor::MaterialisationPolicy policy(pkb == &lazyPkb
+      ? SourceProcessor::Materialisation::LAZY
+      : SourceProcessor::Materialisation::EAGER);
+    SourceProcessor::DesignExtractor(*pkb, policy).extractAllDesignAbstractions();
+  }
+  REQUIRE(lazyPkb.getAffectsTable().empty());
+
+  // Entities are added in the same order, so the integer references match
+  for (int stmt = 1; stmt <= 14; stmt++) {
+    const int intRef = eagerPkb.getIntRefFromStmtNum(stmt);
+    for (const size_t column : { 0, 1 }) {
+      Table expectedNextT = eagerPkb.getNextTTable();
+      Table expectedAffects = eagerPkb.getAffectsTable();
+      Table expectedNextBipT = eagerPkb.getNextBipTTable();
+      expectedNextT.filterColumn(column, { intRef });
+      expectedAffects.filterColumn(column, { intRef });
+      expectedNextBipT.filterColumn(column, { intRef });
+
+      REQUIRE((column == 0 ? lazyPkb.getNextTTableFrom(intRef) : lazyPkb.getNextTTableTo(intRef)).getData() ==
+        expectedNextT.getData());
+      REQUIRE((column == 0 ? lazyPkb.getAffectsTableFrom(intRef) : lazyPkb.getAffectsTableTo(intRef)).getData() ==
+        expectedAffects.getData());
+      REQUIRE((column == 0 ? eagerPkb.getAffectsTableFrom(intRef) : eagerPkb.getAffectsTableTo(intRef)).getData() ==
+        expectedAffects.getData());
+
+      const Table& nextBipT = column == 0 ? lazyPkb.getNextBipTTableFrom(intRef) : lazyPkb.getNextBipTTableTo(intRef);
+      REQUIRE(nextBipT.size() == expectedNextBipT.size());
+      for (const Row& row : expectedNextBipT.getData()) {
+        REQUIRE(nextBipT.contains(row));
+      }
+    }
+  }
+
+  // x = x - 1 is affected by x = 1 and by itself through the loop, but not past call B.
+  // z = x does not affect x = z, as call C modifies z in between.
+  REQUIRE(lazyPkb.getAffectsTableTo(lazyPkb.getIntRefFromStmtNum(4)).size() == 2);
+  REQUIRE(lazyPkb.getAffectsTableFrom(lazyPkb.getIntRefFromStmtNum(7)).empty());
+}
+
+TEST_CASE("[TestDesignExtractor] Automatic materialisation follows program size") {
+  SourceProcessor::ProgramStats stats{ 1000, 10, 100000, 100 };
+  const SourceProcessor::MaterialisationPolicy policy(SourceProcessor::Materialisation::AUTO, 200000);
+
+  REQUIRE(!policy.isLazy(SourceProcessor::DerivedRelation::NEXT_T, stats));
+  REQUIRE(!policy.isLazy(SourceProcessor::DerivedRelation::AFFECTS_T, stats));
+  REQUIRE(policy.isLazy(SourceProcessor::DerivedRelation::NEXT_BIP_T, stats));
+  REQUIRE(!policy.isLazy(SourceProcessor::DerivedRelation::AFFECTS_BIP_T, stats));
+
+  const SourceProcessor::MaterialisationPolicy& overridden = policy
+    .withMode(SourceProcessor::DerivedRelation::NEXT_BIP_T, SourceProcessor::Materialisation::EAGER)
+    .withMode(SourceProcessor::DerivedRelation::NEXT_T, SourceProcessor::Materialisation::LAZY);
+  REQUIRE(!overridden.isLazy(SourceProcessor::DerivedRelation::NEXT_BIP_T, stats));
+  REQUIRE(overridden.isLazy(SourceProcessor::DerivedRelation::NEXT_T, stats));
+  REQUIRE(overridden.getMode(SourceProcessor::DerivedRelation::AFFECTS) == SourceProcessor::Materialisation::AUTO);
+}
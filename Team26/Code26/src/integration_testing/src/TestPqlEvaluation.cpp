@@ -4,11 +4,16 @@
 #include <list>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 
 #include "Pkb.h"
+#include "PqlClauseCache.h"
 #include "PqlEvaluator.h"
 #include "PqlParser.h"
+#include "PqlPreparedQuery.h"
 #include "PqlQuery.h"
+#include "SpaException.h"
+#include "Table.h"
 #include "Token.h"
 #include "Tokeniser.h"
 
@@ -1852,3 +1857,129 @@ TEST_CASE("[TestPqlEvaluation] Valid Query, Complex query", "[PqlEvaluator]") {
   }
 }
 
+
+TEST_CASE("[TestPqlEvaluation] Clause results shared through the clause cache", "[PqlEvaluator][ClauseCache]") {
+  // Populate pkb to test
+  Pkb pkb = getPkb();
+  Pql::ClauseCache clauseCache(1 << 20);
+  auto evaluate = [&pkb, &clauseCache](const Pql::Entity& target, const Pql::Clause& clause) {
+    Pql::Query query;
+    query.addTarget(target);
+    query.addClause(clause);
+    std::list<std::string> evaluationResult;
+    Pql::PqlEvaluator pqlEvaluator(pkb, query, evaluationResult, &clauseCache);
+    pqlEvaluator.evaluateQuery();
+    evaluationResult.sort();
+    return evaluationResult;
+  };
+
+  // Follows(s, a) and Follows(s1, a1) differ only in the names of their synonyms
+  const Pql::Entity s(Pql::EntityType::STMT, "s");
+  const Pql::Entity a(Pql::EntityType::ASSIGN, "a");
+  const Pql::Entity s1(Pql::EntityType::STMT, "s1");
+  const Pql::Entity a1(Pql::EntityType::ASSIGN, "a1");
+  REQUIRE(evaluate(s, Pql::Clause(Pql::ClauseType::FOLLOWS, { s, a })) == std::list<std::string>{ "1", "2" });
+  REQUIRE(clauseCache.size() == 1);
+  REQUIRE(evaluate(a1, Pql::Clause(Pql::ClauseType::FOLLOWS, { s1, a1 })) == std::list<std::string>{ "2", "3" });
+  REQUIRE(evaluate(s1, Pql::Clause(Pql::ClauseType::FOLLOWS, { s1, a1 })) == std::list<std::string>{ "1", "2" });
+  REQUIRE(clauseCache.size() == 1);
+
+  // Synonyms of other types are not shared
+  const Pql::Entity ifs(Pql::EntityType::IF, "ifs");
+  REQUIRE(evaluate(s, Pql::Clause(Pql::ClauseType::FOLLOWS, { s, ifs })) == std::list<std::string>{ "3" });
+  REQUIRE(clauseCache.size() == 2);
+
+  clauseCache.clear();
+  REQUIRE(clauseCache.size() == 0);
+  REQUIRE(clauseCache.getNumBytes() == 0);
+
+  // Tables larger than the budget are not kept
+  Pql::ClauseCache smallClauseCache(1);
+  Table table({ "s" });
+  table.insertRow({ 1 });
+  smallClauseCache.add(Pql::Clause(Pql::ClauseType::FOLLOWS, { s, a }), table);
+  REQUIRE(smallClauseCache.size() == 0);
+}
+
+TEST_CASE("[TestPqlEvaluation] Least recently used clause results are evicted", "[PqlEvaluator][ClauseCache]") {
+  const Pql::Entity s(Pql::EntityType::STMT, "s");
+  const Pql::Entity a(Pql::EntityType::ASSIGN, "a");
+  const Pql::Clause follows(Pql::ClauseType::FOLLOWS, { s, a });
+  const Pql::Clause parent(Pql::ClauseType::PARENT, { s, a });
+  const Pql::Clause next(Pql::ClauseType::NEXT, { s, a });
+  Table followsTable({ "s", "a" });
+  followsTable.insertRow({ 1, 2 });
+  Table parentTable({ "s", "a" });
+  parentTable.insertRow({ 3, 4 });
+  Table nextTable({ "s", "a" });
+  nextTable.insertRow({ 5, 6 });
+
+  // Measure each table alone, then give the cache room for two of them
+  auto getNumBytes = [](const Pql::Clause& clause, const Table& table) {
+    Pql::ClauseCache clauseCache(1 << 20);
+    clauseCache.add(clause, table);
+    return clauseCache.getNumBytes();
+  };
+  const size_t followsNumBytes = getNumBytes(follows, followsTable);
+  const size_t nextNumBytes = getNumBytes(next, nextTable);
+  Pql::ClauseCache clauseCache(followsNumBytes + getNumBytes(parent, parentTable));
+
+  clauseCache.add(follows, followsTable);
+  clauseCache.add(parent, parentTable);
+  REQUIRE(clauseCache.size() == 2);
+  Table table;
+  REQUIRE(clauseCache.find(follows, table));
+
+  // Parent is now the least recently used, so it makes room for Next
+  clauseCache.add(next, nextTable);
+  REQUIRE(clauseCache.size() == 2);
+  REQUIRE(clauseCache.getNumBytes() == followsNumBytes + nextNumBytes);
+  REQUIRE_FALSE(clauseCache.find(parent, table));
+  REQUIRE(clauseCache.find(follows, table));
+  REQUIRE(table.getData() == followsTable.getData());
+  REQUIRE(clauseCache.find(next, table));
+  REQUIRE(table.getData() == nextTable.getData());
+}
+
+TEST_CASE("[TestPqlEvaluation] Prepared query evaluated with bound placeholders", "[PqlEvaluator][PreparedQuery]") {
+  // Populate pkb to test
+  Pkb pkb = getPkb();
+  const Pql::PreparedQuery preparedQuery("stmt s; Select s such that Follows($n, s) and Uses(s, \"$v\")");
+  auto execute = [&pkb, &preparedQuery](const std::unordered_map<std::string, std::string>& bindings) {
+    Pql::Query query = preparedQuery.bind(bindings);
+    std::list<std::string> evaluationResult;
+    Pql::PqlEvaluator pqlEvaluator(pkb, query, evaluationResult);
+    pqlEvaluator.evaluateQuery(preparedQuery.getClauseGroups());
+    evaluationResult.sort();
+    return evaluationResult;
+  };
+
+  REQUIRE(execute({ { "n", "3" }, { "v", "c" } }) == std::list<std::string>{ "4" });
+  REQUIRE(execute({ { "n", "003" }, { "v", "a" } }) == std::list<std::string>{ "4" });
+  REQUIRE(execute({ { "n", "1" }, { "v", "c" } }).empty());
+  REQUIRE_FALSE(preparedQuery.isBoolean());
+
+  SECTION("Invalid bindings") {
+    REQUIRE_THROWS_AS(execute({ { "n", "3" } }), Pql::SyntaxError);
+    REQUIRE_THROWS_AS(execute({ { "n", "x" }, { "v", "c" } }), Pql::SyntaxError);
+    REQUIRE_THROWS_AS(execute({ { "n", "3" }, { "v", "1" } }), Pql::SyntaxError);
+    REQUIRE_THROWS_AS(execute({ { "n", "3" }, { "v", "c" }, { "w", "c" } }), Pql::SyntaxError);
+    REQUIRE_THROWS_AS(execute({ { "n", "0" }, { "v", "c" } }), Pql::SemanticError);
+  }
+
+  SECTION("Invalid templates") {
+    REQUIRE_THROWS_AS(Pql::PreparedQuery("assign a; Select a pattern a(_, _\"x + $n\"_)"), Pql::SyntaxError);
+    REQUIRE_THROWS_AS(Pql::PreparedQuery("stmt s; Select s such that Follows($n, s) and Uses(s, \"$n\")"),
+      Pql::SyntaxError);
+    REQUIRE_THROWS_AS(Pql::PreparedQuery("stmt s; Select s such that Follows($n, t)"), Pql::SemanticError);
+  }
+
+  SECTION("Placeholders in with clauses") {
+    const Pql::PreparedQuery withQuery("constant c; Select c with c.value = $value");
+    Pql::Query query = withQuery.bind({ { "value", "3" } });
+    std::list<std::string> evaluationResult;
+    Pql::PqlEvaluator pqlEvaluator(pkb, query, evaluationResult);
+    pqlEvaluator.evaluateQuery(withQuery.getClauseGroups());
+    REQUIRE(evaluationResult == std::list<std::string>{ "3" });
+  }
+}
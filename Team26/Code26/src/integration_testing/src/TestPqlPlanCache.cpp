@@ -0,0 +1,70 @@
+#include "catch.hpp"
+
+#include <list>
+#include <sstream>
+#include <string>
+
+#include "PqlPlanCache.h"
+#include "PqlQuery.h"
+#include "Token.h"
+#include "Tokeniser.h"
+
+namespace {
+  std::string getKey(const std::string& queryString) {
+    std::stringstream ss(queryString);
+    return Pql::PlanCache::getKey(Tokeniser()
+      .allowingLeadingZeroes()
+      .notConsumingWhitespace()
+      .tokenise(ss));
+  }
+}
+
+TEST_CASE("[TestPqlPlanCache] Keys of queries", "[PlanCache]") {
+  SECTION("Whitespace and synonym names are normalised") {
+    const std::string key = getKey("stmt s; assign a; Select s such that Follows(s, a) pattern a(_, _\"x\"_)");
+    REQUIRE(getKey("stmt  s;\n assign\ta; Select s\tsuch that Follows(s, a) pattern a(_, _\"x\"_)") == key);
+    REQUIRE(getKey("stmt st; assign x; Select st such that Follows(st, x) pattern x(_, _\"x\"_)") == key);
+  }
+
+  SECTION("Queries that differ in more than naming have different keys") {
+    const std::string key = getKey("stmt s; assign a; Select s such that Follows(s, a)");
+    REQUIRE(getKey("stmt s; assign a; Select a such that Follows(s, a)") != key);
+    REQUIRE(getKey("assign a; stmt s; Select s such that Follows(s, a)") != key);
+    REQUIRE(getKey("stmt s; assign a; Select s such that Follows(s, 1)") != key);
+    REQUIRE(getKey("stmt s; assign a; Select s such that Follows*(s, a)") != key);
+    REQUIRE(getKey("stmt s; assign a; Select s such that Follows (s, a)") != key);
+    REQUIRE(getKey("stmt s; assign a; Select s such  that Follows(s, a)") != key);
+    REQUIRE(getKey("stmt s; assign a; Select s such\tthat Follows(s, a)") != key);
+  }
+
+  SECTION("Names in quotes and attribute names are not renamed") {
+    REQUIRE(getKey("procedure p; Select p with p.procName = \"p\"") !=
+      getKey("procedure q; Select q with q.procName = \"q\""));
+    REQUIRE(getKey("constant value; Select value.value") != getKey("constant c; Select c.c"));
+  }
+
+  SECTION("Synonyms named after keywords are not renamed") {
+    REQUIRE(getKey("assign pattern; Select pattern pattern pattern(_, _)") !=
+      getKey("assign a; Select a a a(_, _)"));
+    REQUIRE(getKey("stmt stmt; Select stmt") != getKey("stmt s; Select s"));
+  }
+}
+
+TEST_CASE("[TestPqlPlanCache] Least recently used plans are evicted", "[PlanCache]") {
+  Pql::PlanCache planCache(2);
+  Pql::QueryPlan plan;
+  plan.query.addTarget(Pql::Entity(Pql::EntityType::STMT, "s"));
+  planCache.add("a", plan);
+  planCache.add("b", plan);
+  REQUIRE(planCache.find("a") != nullptr);
+  planCache.add("c", plan);
+  REQUIRE(planCache.size() == 2);
+  REQUIRE(planCache.find("b") == nullptr);
+  REQUIRE(planCache.find("a") != nullptr);
+  REQUIRE(planCache.find("c")->query.getTargets() == plan.query.getTargets());
+
+  Pql::PlanCache disabledCache(0);
+  disabledCache.add("a", plan);
+  REQUIRE(disabledCache.size() == 0);
+  REQUIRE(disabledCache.find("a") == nullptr);
+}
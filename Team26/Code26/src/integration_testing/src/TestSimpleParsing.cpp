@@ -1,15 +1,21 @@
 #include "catch.hpp"
 
+#include <chrono>
+#include <functional>
 #include <iostream>
 #include <list>
 #include <sstream>
 #include <string>
 
 #include "DesignExtractor.h"
+#include "ParallelParser.h"
 #include "Pkb.h"
 #include "SimpleParser.h"
+#include "SpaException.h"
+#include "Span.h"
 #include "Table.h"
 #include "Token.h"
+#include "TokenCursor.h"
 #include "Tokeniser.h"
 
 
@@ -26,6 +32,33 @@ namespace {
       .consumingWhitespace()
       .tokenise(ss);
   }
+
+  // Procedure i has 7 statements and calls procedure i + 1, except the last which has 6
+  std::string generateProcedures(int numProcs) {
+    std::string program;
+    for (int proc = 0; proc < numProcs; proc++) {
+      program += "procedure p" + std::to_string(proc) + " {\n"
+        "  read x;\n"
+        "  while (x > " + std::to_string(proc) + ") {\n"
+        "    if (y == x) then { y = y + x * 2; } else { print y; }\n"
+        "    x = x - 1;\n"
+        "  }\n";
+      if (proc + 1 < numProcs) {
+        program += "  call p" + std::to_string(proc + 1) + ";\n";
+      }
+      program += "}\n";
+    }
+    return program;
+  }
+
+  std::string getParseError(const std::function<void()>& parse) {
+    try {
+      parse();
+    } catch (const std::exception& e) {
+      return e.what();
+    }
+    return "";
+  }
 }
 
 ///////////////
@@ -156,6 +189,161 @@ TEST_CASE("[TestSimpleParser] Multiple procedures - independent", "[SimpleParser
   }
 }
 
+TEST_CASE("[TestSimpleParser] Parsing while tokenising", "[SimpleParser][Procedures]") {
+  std::string string("procedure a{while(x<0){if(y!=x)then{call b;}else{x=x+1;}}} procedure b{print x;}");
+  const Span<char> text(string.data(), string.data() + string.size());
+  const Tokeniser tokeniser = Tokeniser().notAllowingLeadingZeroes().consumingWhitespace();
+
+  Pkb listPkb;
+  SourceProcessor::SimpleParser(listPkb, expressionStringToTokens(string)).parse();
+  Pkb cursorPkb;
+  SourceProcessor::SimpleParser(cursorPkb, TokenCursor(text, tokeniser)).parse();
+
+  REQUIRE(cursorPkb.getStmtTable().size() == 5);
+  REQUIRE(cursorPkb.getParentTTable().size() == listPkb.getParentTTable().size());
+  REQUIRE(cursorPkb.getUsesSTable().size() == listPkb.getUsesSTable().size());
+  REQUIRE(cursorPkb.getNextTable().size() == listPkb.getNextTable().size());
+  REQUIRE(cursorPkb.getCallsTable().contains({ cursorPkb.getIntRefFromEntity("a"),
+    cursorPkb.getIntRefFromEntity("b") }));
+
+  SECTION("Tokenising errors surface while parsing") {
+    std::string invalid("procedure a{x=1;} procedure b{x=01;}");
+    const Span<char> invalidText(invalid.data(), invalid.data() + invalid.size());
+    Pkb pkb;
+    SourceProcessor::SimpleParser parser(pkb, TokenCursor(invalidText, tokeniser));
+    REQUIRE_THROWS_AS(parser.parse(), TokeniserException);
+  }
+}
+
+TEST_CASE("[TestSimpleParser] Parsing procedures in parallel", "[SimpleParser][Procedures]") {
+  std::string program = generateProcedures(50);
+  const Span<char> text(program.data(), program.data() + program.size());
+  const Tokeniser tokeniser = Tokeniser().notAllowingLeadingZeroes().consumingWhitespace();
+
+  Pkb sequentialPkb;
+  SourceProcessor::SimpleParser(sequentialPkb, TokenCursor(text, tokeniser)).parse();
+  Pkb parallelPkb;
+  SourceProcessor::ParallelParser(parallelPkb, text, tokeniser, 4, 1).parse();
+
+  REQUIRE(parallelPkb.getStmtTable().size() == 349);
+  REQUIRE(parallelPkb.getTableSizes() == sequentialPkb.getTableSizes());
+  REQUIRE(parallelPkb.getIntRefFromEntity("p49") == sequentialPkb.getIntRefFromEntity("p49"));
+  REQUIRE(parallelPkb.getIntRefFromStmtNum(349) == sequentialPkb.getIntRefFromStmtNum(349));
+  REQUIRE(parallelPkb.getParentTTable().getData() == sequentialPkb.getParentTTable().getData());
+  REQUIRE(parallelPkb.getModifiesPTable().getData() == sequentialPkb.getModifiesPTable().getData());
+  REQUIRE(parallelPkb.getNextTable().getData() == sequentialPkb.getNextTable().getData());
+  REQUIRE(parallelPkb.getCallProcTable().getData() == sequentialPkb.getCallProcTable().getData());
+  REQUIRE(parallelPkb.getPatternAssignTable().getData() ==
+    sequentialPkb.getPatternAssignTable().getData());
+  REQUIRE(parallelPkb.getParentTable().contains({ parallelPkb.getIntRefFromStmtNum(9),
+    parallelPkb.getIntRefFromStmtNum(10) }));
+
+  SECTION("Errors are those of parsing sequentially") {
+    for (const std::string& invalid : { program + "procedure p0 { x = 1; }",
+      program + "procedure q { x = 01; }", program + "procedure q { x = 1; } }",
+      "procedure q { while (x) { x = 1; } }" + program }) {
+      const Span<char> invalidText(invalid.data(), invalid.data() + invalid.size());
+      Pkb pkb;
+      const std::string error = getParseError([&]() {
+        SourceProcessor::ParallelParser(pkb, invalidText, tokeniser, 4, 1).parse();
+      });
+      REQUIRE_FALSE(error.empty());
+      REQUIRE(error == getParseError([&]() {
+        SourceProcessor::SimpleParser(pkb, TokenCursor(invalidText, tokeniser)).parse();
+      }));
+    }
+  }
+}
+
+// Hidden from the default run; run with `integration_testing [benchmark]`
+TEST_CASE("[TestSimpleParser] Parsing time by number of threads", "[.][benchmark]") {
+  std::string program = generateProcedures(20000);
+  const Span<char> text(program.data(), program.data() + program.size());
+  const Tokeniser tokeniser = Tokeniser().notAllowingLeadingZeroes().consumingWhitespace();
+
+  for (const size_t numThreads : { 1, 2, 4, 8 }) {
+    Pkb pkb;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    SourceProcessor::ParallelParser(pkb, text, tokeniser, numThreads).parse();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << numThreads << " threads: " << elapsed.count() << " s" << std::endl;
+    REQUIRE(pkb.getStmtTable().size() == 139999);
+  }
+}
+
+TEST_CASE("[TestSimpleParser] Parsing deep nesting and long expressions", "[SimpleParser][Procedures]") {
+  const Tokeniser tokeniser = Tokeniser().notAllowingLeadingZeroes().consumingWhitespace();
+
+  SECTION("Deeply nested statement lists") {
+    // Containers alternate between while and if, and each if also has a print in its else branch
+    const int depth = 10000;
+    std::string program = "procedure p {\n";
+    for (int level = 0; level < depth; level++) {
+      program += level % 2 == 0 ? "while (c < 1) {\n" : "if (c < 1) then {\n";
+    }
+    program += "x = y;\n";
+    for (int level = depth - 1; level >= 0; level--) {
+      program += level % 2 == 0 ? "}\n" : "} else { print x; }\n";
+    }
+    program += "}\n";
+    const Span<char> text(program.data(), program.data() + program.size());
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const SourceProcessor::PkbFragment fragment = SourceProcessor::SimpleParser(TokenCursor(text, tokeniser))
+      .parseFragment();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    REQUIRE(fragment.getNumStmts() == depth + 1 + depth / 2);
+    REQUIRE(elapsed.count() < 10);
+  }
+
+  SECTION("Long expressions") {
+    const int numOperands = 100000;
+    std::string expr = "v0";
+    for (int operand = 1; operand < numOperands; operand++) {
+      expr += (operand % 2 == 0 ? " + v" : " * v") + std::to_string(operand);
+    }
+    const std::string nested = std::string(numOperands, '(') + "v0" + std::string(numOperands, ')');
+    std::string program = "procedure p {\n"
+      "x = " + expr + ";\n"
+      "y = " + nested + ";\n"
+      "while ((" + expr + " < " + nested + ") && (" + nested + " > 1)) { print x; }\n"
+      "}\n";
+    const Span<char> text(program.data(), program.data() + program.size());
+
+    Pkb pkb;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    SourceProcessor::SimpleParser(pkb, TokenCursor(text, tokeniser)).parse();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    REQUIRE(pkb.getStmtTable().size() == 4);
+    REQUIRE(pkb.getUsesPTable().size() == numOperands + 1);
+    REQUIRE(pkb.getPatternWhileTable().size() == numOperands);
+    REQUIRE(elapsed.count() < 10);
+  }
+
+  SECTION("Nested relations are those of parsing recursively") {
+    const int depth = 100;
+    std::string program = "procedure p {\n";
+    for (int level = 0; level < depth; level++) {
+      program += "while (c < 1) {\n";
+    }
+    program += "x = y;\n" + std::string(depth, '}') + "\n}\n";
+    const Span<char> text(program.data(), program.data() + program.size());
+
+    Pkb pkb;
+    SourceProcessor::SimpleParser(pkb, TokenCursor(text, tokeniser)).parse();
+
+    REQUIRE(pkb.getParentTable().size() == depth);
+    REQUIRE(pkb.getParentTTable().size() == depth * (depth + 1) / 2);
+    REQUIRE(pkb.getParentTTable().contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(depth + 1) }));
+    REQUIRE(pkb.getUsesSTable().size() == (depth + 1) + depth);
+    REQUIRE(pkb.getModifiesSTable().size() == depth + 1);
+    REQUIRE(pkb.getModifiesSTable().contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromEntity("x") }));
+    REQUIRE(pkb.getUsesPTable().size() == 2);
+  }
+}
+
 TEST_CASE("[TestSimpleParser] Multiple procedures - Direct calls", "[SimpleParser][Procedures]") {
   std::string string("procedure a{x=1;call b;call c;} procedure b{y=2;} procedure c{print z;}");
   std::list<Token> simpleProg = expressionStringToTokens(string);
@@ -527,7 +715,7 @@ TEST_CASE("[TestSimpleParser] Valid assign statement - Basic", "[SimpleParser][A
     REQUIRE(usesSTable.size() == 1);
     REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromEntity("x") }));
     REQUIRE(modifiesSTable.size() == 1);
-    REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromEntity("x"), pkb.getIntRefFromEntity(expectedPostFixString) }));
+    REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromEntity("x"), pkb.getExprFromPostfixExpr(expectedPostFixString) }));
     REQUIRE(patternAssignTable.size() == 1);
   }
 
@@ -560,7 +748,7 @@ TEST_CASE("[TestSimpleParser] Valid assign statement - Basic", "[SimpleParser][A
     REQUIRE(stmtTable.size() == 1);
     REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromEntity("x") }));
     REQUIRE(modifiesSTable.size() == 1);
-    REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromEntity("x"), pkb.getIntRefFromEntity(expectedPostFixString) }));
+    REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromEntity("x"), pkb.getExprFromPostfixExpr(expectedPostFixString) }));
     REQUIRE(patternAssignTable.size() == 1);
   }
 
@@ -602,8 +790,8 @@ TEST_CASE("[TestSimpleParser] Valid assign statement - Basic", "[SimpleParser][A
     REQUIRE(modifiesSTable.size() == 2);
     REQUIRE(followsTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(2) }));
     REQUIRE(followsTable.size() == 1);
-    REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromEntity("x"), pkb.getIntRefFromEntity(expectedPostFixString1) }));
-    REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromEntity("y"), pkb.getIntRefFromEntity(expectedPostFixString2) }));
+    REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromEntity("x"), pkb.getExprFromPostfixExpr(expectedPostFixString1) }));
+    REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromEntity("y"), pkb.getExprFromPostfixExpr(expectedPostFixString2) }));
     REQUIRE(patternAssignTable.size() == 2);
   }
 }
@@ -654,7 +842,7 @@ TEST_CASE("[TestSimpleParser] Valid assign statement - Advanced", "[SimpleParser
     REQUIRE(usesSTable.size() == 9);
     REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromEntity("z") }));
     REQUIRE(modifiesSTable.size() == 1);
-    REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromEntity("z"), pkb.getIntRefFromEntity(expectedPostFixString) }));
+    REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromEntity("z"), pkb.getExprFromPostfixExpr(expectedPostFixString) }));
     REQUIRE(patternAssignTable.size() == 1);
   }
 
@@ -708,7 +896,7 @@ TEST_CASE("[TestSimpleParser] Valid assign statement - Advanced", "[SimpleParser
     REQUIRE(usesSTable.size() == 4);
     REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromEntity("c") }));
     REQUIRE(modifiesSTable.size() == 1);
-    REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromEntity("c"), pkb.getIntRefFromEntity(expectedPostFixString) }));
+    REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromEntity("c"), pkb.getExprFromPostfixExpr(expectedPostFixString) }));
     REQUIRE(patternAssignTable.size() == 1);
   }
 }
@@ -854,12 +1042,14 @@ TEST_CASE("[TestSimpleParser] Valid if statement - Basic", "[SimpleParser][If]")
   REQUIRE(usesSTable.size() == 2);
   REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromEntity("x") }));
   REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(3), pkb.getIntRefFromEntity("y") }));
-  REQUIRE(modifiesSTable.size() == 2);
+  REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromEntity("x") }));
+  REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromEntity("y") }));
+  REQUIRE(modifiesSTable.size() == 4);
   REQUIRE(followsTable.size() == 0);
   REQUIRE(parentTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(2) }));
   REQUIRE(parentTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(3) }));
   REQUIRE(parentTable.size() == 2);
-  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromEntity("x"), pkb.getIntRefFromEntity(expectedPostFixString) }));
+  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromEntity("x"), pkb.getExprFromPostfixExpr(expectedPostFixString) }));
   REQUIRE(patternAssignTable.size() == 1);
 
   SECTION("With DE relations") {
@@ -970,11 +1160,11 @@ TEST_CASE("[TestSimpleParser] Valid if statement - Singly nested if", "[SimplePa
   REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(5), pkb.getIntRefFromEntity("read") }));
   REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(6), pkb.getIntRefFromEntity("x") }));
   REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(7), pkb.getIntRefFromEntity("y") }));
-  REQUIRE(usesSTable.size() == 9);
+  REQUIRE(usesSTable.size() == 17);
   REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(4), pkb.getIntRefFromEntity("x") }));
   REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(6), pkb.getIntRefFromEntity("y") }));
   REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(7), pkb.getIntRefFromEntity("x") }));
-  REQUIRE(modifiesSTable.size() == 3);
+  REQUIRE(modifiesSTable.size() == 8);
   REQUIRE(followsTable.size() == 0);
   REQUIRE(parentTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(2) }));
   REQUIRE(parentTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(5) }));
@@ -983,8 +1173,8 @@ TEST_CASE("[TestSimpleParser] Valid if statement - Singly nested if", "[SimplePa
   REQUIRE(parentTable.contains({ pkb.getIntRefFromStmtNum(5), pkb.getIntRefFromStmtNum(6) }));
   REQUIRE(parentTable.contains({ pkb.getIntRefFromStmtNum(5), pkb.getIntRefFromStmtNum(7) }));
   REQUIRE(parentTable.size() == 6);
-  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(6), pkb.getIntRefFromEntity("y"), pkb.getIntRefFromEntity(expectedPostFixString1) }));
-  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(7), pkb.getIntRefFromEntity("x"), pkb.getIntRefFromEntity(expectedPostFixString2) }));
+  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(6), pkb.getIntRefFromEntity("y"), pkb.getExprFromPostfixExpr(expectedPostFixString1) }));
+  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(7), pkb.getIntRefFromEntity("x"), pkb.getExprFromPostfixExpr(expectedPostFixString2) }));
   REQUIRE(patternAssignTable.size() == 2);
 
   SECTION("With DE relations") {
@@ -1134,14 +1324,14 @@ TEST_CASE("[TestSimpleParser] Valid if statement - Doubly nested if", "[SimplePa
   REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(7), pkb.getIntRefFromEntity("b") }));
   REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(9), pkb.getIntRefFromEntity("f") }));
   REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(9), pkb.getIntRefFromEntity("g") }));
-  REQUIRE(usesSTable.size() == 6);
+  REQUIRE(usesSTable.size() == 18);
   REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromEntity("x1") }));
   REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(4), pkb.getIntRefFromEntity("x") }));
   REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(6), pkb.getIntRefFromEntity("z") }));
   REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(8), pkb.getIntRefFromEntity("z") }));
   REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(9), pkb.getIntRefFromEntity("c") }));
   REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(10), pkb.getIntRefFromEntity("d") }));
-  REQUIRE(modifiesSTable.size() == 6);
+  REQUIRE(modifiesSTable.size() == 18);
   REQUIRE(followsTable.contains({ pkb.getIntRefFromStmtNum(4), pkb.getIntRefFromStmtNum(5) }));
   REQUIRE(followsTable.contains({ pkb.getIntRefFromStmtNum(6), pkb.getIntRefFromStmtNum(7) }));
   REQUIRE(followsTable.contains({ pkb.getIntRefFromStmtNum(9), pkb.getIntRefFromStmtNum(10) }));
@@ -1156,10 +1346,10 @@ TEST_CASE("[TestSimpleParser] Valid if statement - Doubly nested if", "[SimplePa
   REQUIRE(parentTable.contains({ pkb.getIntRefFromStmtNum(7), pkb.getIntRefFromStmtNum(9) }));
   REQUIRE(parentTable.contains({ pkb.getIntRefFromStmtNum(7), pkb.getIntRefFromStmtNum(10) }));
   REQUIRE(parentTable.size() == 9);
-  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromEntity("x1"), pkb.getIntRefFromEntity(expectedPostFixString1) }));
-  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(6), pkb.getIntRefFromEntity("z"), pkb.getIntRefFromEntity(expectedPostFixString2) }));
-  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(8), pkb.getIntRefFromEntity("z"), pkb.getIntRefFromEntity(expectedPostFixString3) }));
-  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(9), pkb.getIntRefFromEntity("c"), pkb.getIntRefFromEntity(expectedPostFixString4) }));
+  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromEntity("x1"), pkb.getExprFromPostfixExpr(expectedPostFixString1) }));
+  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(6), pkb.getIntRefFromEntity("z"), pkb.getExprFromPostfixExpr(expectedPostFixString2) }));
+  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(8), pkb.getIntRefFromEntity("z"), pkb.getExprFromPostfixExpr(expectedPostFixString3) }));
+  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(9), pkb.getIntRefFromEntity("c"), pkb.getExprFromPostfixExpr(expectedPostFixString4) }));
   REQUIRE(patternAssignTable.size() == 4);
 
   SECTION("With DE relations") {
@@ -1398,7 +1588,7 @@ TEST_CASE("[TestSimpleParser] Valid while statement - Basic", "[SimpleParser][Wh
   REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(3), pkb.getIntRefFromEntity("print") }));
   REQUIRE(usesSTable.size() == 4);
   REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromEntity("read") }));
-  REQUIRE(modifiesSTable.size() == 1);
+  REQUIRE(modifiesSTable.size() == 2);
   REQUIRE(followsTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(3) }));
   REQUIRE(followsTable.size() == 1);
   REQUIRE(parentTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(2) }));
@@ -1505,10 +1695,10 @@ TEST_CASE("[TestSimpleParser] Valid while statement - Singly nested while", "[Si
   REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(4), pkb.getIntRefFromEntity("i") }));
   REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(5), pkb.getIntRefFromEntity("i") }));
   REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(6), pkb.getIntRefFromEntity("while") }));
-  REQUIRE(usesSTable.size() == 6);
+  REQUIRE(usesSTable.size() == 7);
   REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromEntity("while") }));
   REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(4), pkb.getIntRefFromEntity("i") }));
-  REQUIRE(modifiesSTable.size() == 2);
+  REQUIRE(modifiesSTable.size() == 4);
   REQUIRE(followsTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(2) }));
   REQUIRE(followsTable.contains({ pkb.getIntRefFromStmtNum(3), pkb.getIntRefFromStmtNum(5) }));
   REQUIRE(followsTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromStmtNum(6) }));
@@ -1517,7 +1707,7 @@ TEST_CASE("[TestSimpleParser] Valid while statement - Singly nested while", "[Si
   REQUIRE(parentTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromStmtNum(5) }));
   REQUIRE(parentTable.contains({ pkb.getIntRefFromStmtNum(3), pkb.getIntRefFromStmtNum(4) }));
   REQUIRE(parentTable.size() == 3);
-  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(4), pkb.getIntRefFromEntity("i"), pkb.getIntRefFromEntity(expectedPostFixString) }));
+  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(4), pkb.getIntRefFromEntity("i"), pkb.getExprFromPostfixExpr(expectedPostFixString) }));
   REQUIRE(patternAssignTable.size() == 1);
 
   SECTION("With DE relations") {
@@ -1662,13 +1852,13 @@ TEST_CASE("[TestSimpleParser] Valid while statement - Doubly nested while", "[Si
   REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(6), pkb.getIntRefFromEntity("if") }));
   REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(7), pkb.getIntRefFromEntity("while") }));
   REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(8), pkb.getIntRefFromEntity("call") }));
-  REQUIRE(usesSTable.size() == 11);
+  REQUIRE(usesSTable.size() == 24);
   REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromEntity("print") }));
   REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(5), pkb.getIntRefFromEntity("read") }));
   REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(6), pkb.getIntRefFromEntity("if") }));
   REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(7), pkb.getIntRefFromEntity("while") }));
   REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(8), pkb.getIntRefFromEntity("call") }));
-  REQUIRE(modifiesSTable.size() == 5);
+  REQUIRE(modifiesSTable.size() == 12);
   REQUIRE(followsTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(8) }));
   REQUIRE(followsTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromStmtNum(3) }));
   REQUIRE(followsTable.contains({ pkb.getIntRefFromStmtNum(3), pkb.getIntRefFromStmtNum(7) }));
@@ -1681,11 +1871,11 @@ TEST_CASE("[TestSimpleParser] Valid while statement - Doubly nested while", "[Si
   REQUIRE(parentTable.contains({ pkb.getIntRefFromStmtNum(3), pkb.getIntRefFromStmtNum(6) }));
   REQUIRE(parentTable.contains({ pkb.getIntRefFromStmtNum(4), pkb.getIntRefFromStmtNum(5) }));
   REQUIRE(parentTable.size() == 6);
-  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromEntity("print"), pkb.getIntRefFromEntity(expectedPostFixString1) }));
-  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(5), pkb.getIntRefFromEntity("read"), pkb.getIntRefFromEntity(expectedPostFixString2) }));
-  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(6), pkb.getIntRefFromEntity("if"), pkb.getIntRefFromEntity(expectedPostFixString3) }));
-  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(7), pkb.getIntRefFromEntity("while"), pkb.getIntRefFromEntity(expectedPostFixString4) }));
-  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(8), pkb.getIntRefFromEntity("call"), pkb.getIntRefFromEntity(expectedPostFixString5) }));
+  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromEntity("print"), pkb.getExprFromPostfixExpr(expectedPostFixString1) }));
+  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(5), pkb.getIntRefFromEntity("read"), pkb.getExprFromPostfixExpr(expectedPostFixString2) }));
+  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(6), pkb.getIntRefFromEntity("if"), pkb.getExprFromPostfixExpr(expectedPostFixString3) }));
+  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(7), pkb.getIntRefFromEntity("while"), pkb.getExprFromPostfixExpr(expectedPostFixString4) }));
+  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(8), pkb.getIntRefFromEntity("call"), pkb.getExprFromPostfixExpr(expectedPostFixString5) }));
   REQUIRE(patternAssignTable.size() == 5);
 
   SECTION("With DE relations") {
@@ -1898,12 +2088,12 @@ TEST_CASE("[TestSimpleParser] Loops - Nested/follows if/while loops", "[SimplePa
   REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(7), pkb.getIntRefFromEntity("life") }));
   REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(8), pkb.getIntRefFromEntity("bad") }));
   REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(9), pkb.getIntRefFromEntity("nu7z") }));
-  REQUIRE(usesSTable.size() == 9);
+  REQUIRE(usesSTable.size() == 16);
   REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromEntity("D33z") }));
   REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(3), pkb.getIntRefFromEntity("life") }));
   REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(5), pkb.getIntRefFromEntity("print") }));
   REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(7), pkb.getIntRefFromEntity("D33z") }));
-  REQUIRE(modifiesSTable.size() == 4);
+  REQUIRE(modifiesSTable.size() == 10);
   REQUIRE(followsTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(2) }));
   REQUIRE(followsTable.contains({ pkb.getIntRefFromStmtNum(3), pkb.getIntRefFromStmtNum(4) }));
   REQUIRE(followsTable.contains({ pkb.getIntRefFromStmtNum(4), pkb.getIntRefFromStmtNum(8) }));
@@ -1916,9 +2106,9 @@ TEST_CASE("[TestSimpleParser] Loops - Nested/follows if/while loops", "[SimplePa
   REQUIRE(parentTable.contains({ pkb.getIntRefFromStmtNum(6), pkb.getIntRefFromStmtNum(7) }));
   REQUIRE(parentTable.contains({ pkb.getIntRefFromStmtNum(8), pkb.getIntRefFromStmtNum(9) }));
   REQUIRE(parentTable.size() == 7);
-  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(3), pkb.getIntRefFromEntity("life"), pkb.getIntRefFromEntity(expectedPostFixString1) }));
-  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(5), pkb.getIntRefFromEntity("print"), pkb.getIntRefFromEntity(expectedPostFixString2) }));
-  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(7), pkb.getIntRefFromEntity("D33z"), pkb.getIntRefFromEntity(expectedPostFixString3) }));
+  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(3), pkb.getIntRefFromEntity("life"), pkb.getExprFromPostfixExpr(expectedPostFixString1) }));
+  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(5), pkb.getIntRefFromEntity("print"), pkb.getExprFromPostfixExpr(expectedPostFixString2) }));
+  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(7), pkb.getIntRefFromEntity("D33z"), pkb.getExprFromPostfixExpr(expectedPostFixString3) }));
   REQUIRE(patternAssignTable.size() == 3);
 
   SECTION("With DE relations") {
@@ -2128,17 +2318,17 @@ TEST_CASE("[TestSimpleParser] Loops - Random example", "[SimpleParser][Assign][I
   REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(4), pkb.getIntRefFromEntity("else") }));
   REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(5), pkb.getIntRefFromEntity("call") }));
   REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(5), pkb.getIntRefFromEntity("procedure") }));
-  REQUIRE(usesSTable.size() == 15);
+  REQUIRE(usesSTable.size() == 23);
   REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(3), pkb.getIntRefFromEntity("read") }));
   REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(5), pkb.getIntRefFromEntity("print") }));
-  REQUIRE(modifiesSTable.size() == 2);
+  REQUIRE(modifiesSTable.size() == 7);
   REQUIRE(followsTable.size() == 0);
   REQUIRE(parentTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(2) }));
   REQUIRE(parentTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromStmtNum(3) }));
   REQUIRE(parentTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromStmtNum(4) }));
   REQUIRE(parentTable.contains({ pkb.getIntRefFromStmtNum(4), pkb.getIntRefFromStmtNum(5) }));
   REQUIRE(parentTable.size() == 4);
-  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(5), pkb.getIntRefFromEntity("print"), pkb.getIntRefFromEntity(expectedPostFixString) }));
+  REQUIRE(patternAssignTable.contains({ pkb.getIntRefFromStmtNum(5), pkb.getIntRefFromEntity("print"), pkb.getExprFromPostfixExpr(expectedPostFixString) }));
   REQUIRE(patternAssignTable.size() == 1);
 
   SECTION("With DE relations") {
@@ -2256,6 +2446,69 @@ TEST_CASE("[TestSimpleParser] Loops - Random example, but with extra parenthesis
   REQUIRE_THROWS(parser.parse());
 }
 
+//////////////////////////////////////////
+// Structural relations during parsing //
+//////////////////////////////////////////
+
+TEST_CASE("[TestSimpleParser] ParentT relation", "[SimpleParser][ParentT]") {
+  std::string string("procedure p{while(a==1){while(b==1){while(c==1){x=1;}}}}");
+  std::list<Token> simpleProg = expressionStringToTokens(string);
+  Pkb pkb;
+  SourceProcessor::SimpleParser parser(pkb, simpleProg);
+  parser.parse();
+
+  Table parentTTable = pkb.getParentTTable();
+
+  REQUIRE(parentTTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(2) }));
+  REQUIRE(parentTTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(3) }));
+  REQUIRE(parentTTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(4) }));
+  REQUIRE(parentTTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromStmtNum(3) }));
+  REQUIRE(parentTTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromStmtNum(4) }));
+  REQUIRE(parentTTable.contains({ pkb.getIntRefFromStmtNum(3), pkb.getIntRefFromStmtNum(4) }));
+  REQUIRE(parentTTable.size() == 6);
+}
+
+TEST_CASE("[TestSimpleParser] FollowsT relation", "[SimpleParser][FollowsT]") {
+  std::string string("procedure p{x=1;y=2;if(x==y)then{z=3;}else{z=4;}w=5;}");
+  std::list<Token> simpleProg = expressionStringToTokens(string);
+  Pkb pkb;
+  SourceProcessor::SimpleParser parser(pkb, simpleProg);
+  parser.parse();
+
+  Table followsTTable = pkb.getFollowsTTable();
+
+  REQUIRE(followsTTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(2) }));
+  REQUIRE(followsTTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(3) }));
+  REQUIRE(followsTTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(6) }));
+  REQUIRE(followsTTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromStmtNum(3) }));
+  REQUIRE(followsTTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromStmtNum(6) }));
+  REQUIRE(followsTTable.contains({ pkb.getIntRefFromStmtNum(3), pkb.getIntRefFromStmtNum(6) }));
+  REQUIRE(followsTTable.size() == 6);
+}
+
+TEST_CASE("[TestSimpleParser] Uses and Modifies in containers", "[SimpleParser][Uses][Modifies]") {
+  std::string string("procedure p{while(a==1){if(b==1)then{read z;}else{print y;}}}");
+  std::list<Token> simpleProg = expressionStringToTokens(string);
+  Pkb pkb;
+  SourceProcessor::SimpleParser parser(pkb, simpleProg);
+  parser.parse();
+
+  Table usesSTable = pkb.getUsesSTable();
+  Table modifiesSTable = pkb.getModifiesSTable();
+
+  REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromEntity("a") }));
+  REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromEntity("b") }));
+  REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromEntity("y") }));
+  REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromEntity("b") }));
+  REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromEntity("y") }));
+  REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(4), pkb.getIntRefFromEntity("y") }));
+  REQUIRE(usesSTable.size() == 6);
+  REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromEntity("z") }));
+  REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(2), pkb.getIntRefFromEntity("z") }));
+  REQUIRE(modifiesSTable.contains({ pkb.getIntRefFromStmtNum(3), pkb.getIntRefFromEntity("z") }));
+  REQUIRE(modifiesSTable.size() == 3);
+}
+
 /////////////////////////////
 // Next and NextT relation //
 /////////////////////////////
@@ -2581,18 +2834,18 @@ TEST_CASE("[TestSimpleParser] CFG - Example CFG (Figure 5) - Advanced SPA requir
   parser.parse();
 
   SECTION("CFG") {
-    std::vector<int> stmt1 = pkb.getNextStmtsFromCfg(1);
-    std::vector<int> stmt2 = pkb.getNextStmtsFromCfg(2);
-    std::vector<int> stmt3 = pkb.getNextStmtsFromCfg(3);
-    std::vector<int> stmt4 = pkb.getNextStmtsFromCfg(4);
-    std::vector<int> stmt5 = pkb.getNextStmtsFromCfg(5);
-    std::vector<int> stmt6 = pkb.getNextStmtsFromCfg(6);
-    std::vector<int> stmt7 = pkb.getNextStmtsFromCfg(7);
-    std::vector<int> stmt8 = pkb.getNextStmtsFromCfg(8);
-    std::vector<int> stmt9 = pkb.getNextStmtsFromCfg(9);
-    std::vector<int> stmt10 = pkb.getNextStmtsFromCfg(10);
-    std::vector<int> stmt11 = pkb.getNextStmtsFromCfg(11);
-    std::vector<int> stmt12 = pkb.getNextStmtsFromCfg(12);
+    Span<int> stmt1 = pkb.getNextStmtsFromCfg(1);
+    Span<int> stmt2 = pkb.getNextStmtsFromCfg(2);
+    Span<int> stmt3 = pkb.getNextStmtsFromCfg(3);
+    Span<int> stmt4 = pkb.getNextStmtsFromCfg(4);
+    Span<int> stmt5 = pkb.getNextStmtsFromCfg(5);
+    Span<int> stmt6 = pkb.getNextStmtsFromCfg(6);
+    Span<int> stmt7 = pkb.getNextStmtsFromCfg(7);
+    Span<int> stmt8 = pkb.getNextStmtsFromCfg(8);
+    Span<int> stmt9 = pkb.getNextStmtsFromCfg(9);
+    Span<int> stmt10 = pkb.getNextStmtsFromCfg(10);
+    Span<int> stmt11 = pkb.getNextStmtsFromCfg(11);
+    Span<int> stmt12 = pkb.getNextStmtsFromCfg(12);
 
     REQUIRE(std::find(stmt1.begin(), stmt1.end(), 2) != stmt1.end());
     REQUIRE(stmt1.size() == 1);
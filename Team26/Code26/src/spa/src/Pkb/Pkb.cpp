@@ -2,14 +2,22 @@
 
 #include <assert.h>
 
+#include <algorithm>
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "AffectsSearch.h"
+#include "BipReachability.h"
 #include "Cfg.h"
+#include "ExprDag.h"
+#include "LoopNestingForest.h"
+#include "Profiler.h"
+#include "Span.h"
 #include "Table.h"
 
 Pkb::Pkb() {}
@@ -19,7 +27,54 @@ void Pkb::initialiseCfgBip(const std::list<std::string>& topoProc) {
   for (const std::pair<int, std::string>& callProcPair : callIntRefToProcMapper) {
     callStmtToProcMapper.emplace(getStmtNumFromIntRef(callProcPair.first), callProcPair.second);
   }
-  cfg.initialiseCfgBip(topoProc, procStartMapper, procEndMapper, callStmtToProcMapper);
+  cfg.freeze(); // The dummy end nodes are added after parsing
+  cfg.initialiseCfgBip(topoProc, procStartMapper, callStmtToProcMapper);
+}
+
+void Pkb::initialiseNextBipReachability(const bool isOnDemand) {
+  nextBipReachability = Cfg::BipReachability(cfg);
+  isNextBipTOnDemand = isOnDemand;
+}
+
+void Pkb::initialiseLoopNestingForest(const bool isOnDemand) {
+  std::vector<int> stmtToParent(getMaxStmtNum() + 1, 0);
+  for (const Row& row : parentTable.getData()) {
+    stmtToParent[getStmtNumFromIntRef(row[1])] = getStmtNumFromIntRef(row[0]);
+  }
+  std::vector<int> procStartStmts;
+  for (const std::pair<const std::string, int>& procAndStart : procStartMapper) {
+    procStartStmts.push_back(procAndStart.second);
+  }
+
+  loopNestingForest = Cfg::LoopNestingForest(cfg, stmtToParent, procStartStmts);
+  isNextTOnDemand = isOnDemand;
+}
+
+void Pkb::initialiseAffectsSearch(const bool isOnDemand) {
+  isAffectsOnDemand = isOnDemand;
+  if (!isOnDemand) {
+    affectsSearch = Cfg::AffectsSearch();
+    return;
+  }
+
+  std::unordered_set<int> assignStmts;
+  for (const int assignIntRef : assignIntRefs) {
+    assignStmts.insert(getStmtNumFromIntRef(assignIntRef));
+  }
+  std::unordered_map<int, std::vector<int>> stmtToVarsModified;
+  for (const Row& row : modifiesSTable.getData()) {
+    if (ifIntRefs.count(row[0]) == 0 && whileIntRefs.count(row[0]) == 0) {
+      stmtToVarsModified[getStmtNumFromIntRef(row[0])].push_back(row[1]);
+    }
+  }
+  std::unordered_map<int, std::vector<int>> stmtToVarsUsed;
+  for (const Row& row : usesSTable.getData()) {
+    if (assignIntRefs.count(row[0]) == 1) {
+      stmtToVarsUsed[getStmtNumFromIntRef(row[0])].push_back(row[1]);
+    }
+  }
+
+  affectsSearch = Cfg::AffectsSearch(getMaxStmtNum(), assignStmts, stmtToVarsModified, stmtToVarsUsed);
 }
 
 void Pkb::addProcRange(const std::string proc, const int first, const int last) {
@@ -43,12 +98,22 @@ void Pkb::addCfgEdge(const int from, const int to) {
   }
 }
 
+void Pkb::freezeCfg() {
+  cfg.freeze();
+}
+
 void Pkb::addPatternIf(const int stmtNum, const std::string& var) {
-  patternIfTable.insertRow({ addEntity(std::to_string(stmtNum)), addEntity(var) });
+  const int stmtIntRef = addEntity(std::to_string(stmtNum));
+  const int varIntRef = addEntity(var);
+  patternIfTable.insertRow({ stmtIntRef, varIntRef });
+  addPosting(varToPatternIfStmts, varIntRef, stmtIntRef);
 }
 
 void Pkb::addPatternWhile(const int stmtNum, const std::string& var) {
-  patternWhileTable.insertRow({ addEntity(std::to_string(stmtNum)), addEntity(var) });
+  const int stmtIntRef = addEntity(std::to_string(stmtNum));
+  const int varIntRef = addEntity(var);
+  patternWhileTable.insertRow({ stmtIntRef, varIntRef });
+  addPosting(varToPatternWhileStmts, varIntRef, stmtIntRef);
 }
 
 void Pkb::addCalls(const std::string& caller, const std::string& called) {
@@ -208,7 +273,14 @@ void Pkb::addUsesP(const std::string& proc, const std::string& var) {
 }
 
 void Pkb::addPatternAssign(const int stmtNum, const std::string& lhs, const std::string& rhs) {
-  patternAssignTable.insertRow({ addEntity(std::to_string(stmtNum)), addEntity(lhs), addEntity(rhs) });
+  const int stmtIntRef = addEntity(std::to_string(stmtNum));
+  const int lhsIntRef = addEntity(lhs);
+  const int rhsExpr = exprDag.addPostfixExpr(rhs, [this](const std::string& name) { return addEntity(name); });
+  if (!patternAssignTable.contains({ stmtIntRef, lhsIntRef, rhsExpr })) {
+    patternAssignTable.insertRow({ stmtIntRef, lhsIntRef, rhsExpr });
+    indexPatternAssign(stmtIntRef, lhsIntRef, rhsExpr);
+  }
+  addPosting(lhsToPatternAssignStmts, lhsIntRef, stmtIntRef);
 }
 
 // Getters
@@ -228,15 +300,47 @@ Table Pkb::getParentTTable() const { return parentTTable; }
 Table Pkb::getUsesSTable() const { return usesSTable; }
 Table Pkb::getModifiesSTable() const { return modifiesSTable; }
 Table Pkb::getPatternAssignTable() const { return patternAssignTable; }
+
+Table Pkb::getPatternAssignLhsTableWithVars(const std::unordered_set<int>& varIntRefs) const {
+  return getPostingsTable(lhsToPatternAssignStmts, varIntRefs);
+}
+
+Table Pkb::getPatternAssignTableWithSubExpr(const int subExpr) const {
+  Table result(3);
+  if (subExprToPatternAssignRows.count(subExpr) == 1) {
+    result.insertRows(subExprToPatternAssignRows.at(subExpr));
+  }
+  return result;
+}
 Table Pkb::getCallTable() const { return callTable; }
 Table Pkb::getCallsTable() const { return callsTable; }
 Table Pkb::getCallsTTable() const { return callsTTable; }
 Table Pkb::getNextTable() const { return nextTable; }
-Table Pkb::getNextTTable() const { return nextTTable; }
+Table Pkb::getNextTTable() const {
+  if (!isNextTOnDemand) {
+    return nextTTable;
+  }
+
+  Table table{ 2 };
+  loopNestingForest.forEachNextT([this, &table](int prev, int next) {
+    table.insertRow({ getIntRefFromStmtNum(prev), getIntRefFromStmtNum(next) });
+  });
+  return table;
+}
 Table Pkb::getAffectsTable() const { return affectsTable; }
 Table Pkb::getAffectsTTable() const { return affectsTTable; }
 Table Pkb::getNextBipTable() const { return nextBipTable; }
-Table Pkb::getNextBipTTable() const { return nextBipTTable; }
+Table Pkb::getNextBipTTable() const {
+  if (!isNextBipTOnDemand) {
+    return nextBipTTable;
+  }
+
+  Table table{ 2 };
+  nextBipReachability.forEachReachable([this, &table](int prev, int next) {
+    table.insertRow({ getIntRefFromStmtNum(prev), getIntRefFromStmtNum(next) });
+  });
+  return table;
+}
 Table Pkb::getAffectsBipTable() const { return affectsBipTable; }
 Table Pkb::getAffectsBipTTable() const { return affectsBipTTable; }
 Table Pkb::getUsesPTable() const { return usesPTable; }
@@ -247,6 +351,14 @@ Table Pkb::getPrintVarTable() const { return printVarTable; }
 Table Pkb::getPatternIfTable() const { return patternIfTable; }
 Table Pkb::getPatternWhileTable() const { return patternWhileTable; }
 
+Table Pkb::getPatternIfTableWithVars(const std::unordered_set<int>& varIntRefs) const {
+  return getPostingsTable(varToPatternIfStmts, varIntRefs);
+}
+
+Table Pkb::getPatternWhileTableWithVars(const std::unordered_set<int>& varIntRefs) const {
+  return getPostingsTable(varToPatternWhileStmts, varIntRefs);
+}
+
 std::unordered_set<int> Pkb::getVarIntRefs() const { return varIntRefs; }
 std::unordered_set<int> Pkb::getStmtIntRefs() const{ return stmtIntRefs; }
 std::unordered_set<int> Pkb::getProcIntRefs() const{ return procIntRefs; }
@@ -270,6 +382,10 @@ std::string Pkb::getEntityFromIntRef(const int intRef) const {
   return intRefToEntityMapper.at(intRef);
 }
 
+int Pkb::getExprFromPostfixExpr(const std::string& postfixExpr) const {
+  return exprDag.findPostfixExpr(postfixExpr, [this](const std::string& name) { return getIntRefFromEntity(name); });
+}
+
 int Pkb::getIntRefFromStmtNum(const int stmtNum) const {
   return getIntRefFromEntity(std::to_string(stmtNum));
 }
@@ -326,10 +442,14 @@ std::string Pkb::getVarNameFromPrintStmtIntRef(const int intRef) const {
   return printIntRefToVarMapper.at(intRef);
 }
 
-std::vector<int> Pkb::getNextStmtsFromCfg(const int stmtNum) const {
+Span<int> Pkb::getNextStmtsFromCfg(const int stmtNum) const {
   return cfg.getNeighbours(stmtNum);
 }
 
+Span<int> Pkb::getPrevStmtsFromCfg(const int stmtNum) const {
+  return cfg.getPredecessors(stmtNum);
+}
+
 int Pkb::getStartStmtFromProc(const std::string& proc) const {
   return procStartMapper.at(proc);
 }
@@ -345,6 +465,82 @@ std::string Pkb::getProcFromStmt(const int stmt) const {
   return "";
 }
 
+int Pkb::getMaxStmtNum() const {
+  int maxStmt = 0;
+  for (const int stmtIntRef : stmtIntRefs) {
+    maxStmt = std::max(maxStmt, getStmtNumFromIntRef(stmtIntRef));
+  }
+  return maxStmt;
+}
+
+void Pkb::indexPatternAssign(const int stmtIntRef, const int lhsIntRef, const int rhsExpr) {
+  std::vector<int> stack{ rhsExpr };
+  std::unordered_set<int> subExprs;
+  while (!stack.empty()) {
+    const int expr = stack.back();
+    stack.pop_back();
+    if (!subExprs.insert(expr).second) {
+      continue;
+    }
+
+    std::vector<int>& rows = subExprToPatternAssignRows[expr];
+    rows.push_back(stmtIntRef);
+    rows.push_back(lhsIntRef);
+    rows.push_back(rhsExpr);
+
+    const ExprDag::Node& node = exprDag.getNode(expr);
+    if (node.op != ExprDag::LEAF) {
+      stack.push_back(node.left);
+      stack.push_back(node.right);
+    }
+  }
+}
+
+void Pkb::addPosting(std::unordered_map<int, std::vector<int>>& postings, const int varIntRef,
+  const int stmtIntRef) {
+  std::vector<int>& stmts = postings[varIntRef];
+  // Statements are mostly indexed in ascending order, so the common case appends
+  if (stmts.empty() || stmts.back() < stmtIntRef) {
+    stmts.push_back(stmtIntRef);
+    return;
+  }
+  const std::vector<int>::iterator it = std::lower_bound(stmts.begin(), stmts.end(), stmtIntRef);
+  if (*it != stmtIntRef) {
+    stmts.insert(it, stmtIntRef);
+  }
+}
+
+Table Pkb::getPostingsTable(const std::unordered_map<int, std::vector<int>>& postings,
+  const std::unordered_set<int>& varIntRefs) {
+  std::vector<int> values;
+  auto addRows = [&values](const int varIntRef, const std::vector<int>& stmts) {
+    for (const int stmtIntRef : stmts) {
+      values.push_back(stmtIntRef);
+      values.push_back(varIntRef);
+    }
+  };
+
+  // Look up the smaller of the two sides
+  if (varIntRefs.size() < postings.size()) {
+    for (const int varIntRef : varIntRefs) {
+      const auto it = postings.find(varIntRef);
+      if (it != postings.end()) {
+        addRows(varIntRef, it->second);
+      }
+    }
+  } else {
+    for (const auto& entry : postings) {
+      if (varIntRefs.count(entry.first) == 1) {
+        addRows(entry.first, entry.second);
+      }
+    }
+  }
+
+  Table table(2);
+  table.insertRows(values);
+  return table;
+}
+
 int Pkb::addEntity(const std::string& entity) {
   if (entityToIntRefMapper.count(entity) == 0) {
     const int intRef = entityToIntRefMapper.size();
@@ -354,6 +550,164 @@ int Pkb::addEntity(const std::string& entity) {
   return entityToIntRefMapper[entity];
 }
 
-std::vector<std::shared_ptr<Cfg::BipNode>> Pkb::getStartBipNodes() const {
-  return cfg.getStartBipNodes();
+const Cfg::Cfg& Pkb::getCfg() const {
+  assert(cfg.isFrozen());
+  return cfg;
+}
+
+const Cfg::CfgBip& Pkb::getCfgBip() const {
+  return cfg.getCfgBip();
+}
+
+const Cfg::BipReachability& Pkb::getNextBipReachability() const {
+  return nextBipReachability;
+}
+
+const Cfg::LoopNestingForest& Pkb::getLoopNestingForest() const {
+  return loopNestingForest;
+}
+
+Table Pkb::getNextTTableFrom(const int stmtIntRef) const {
+  if (!isNextTOnDemand) {
+    Table table = nextTTable;
+    table.filterColumn(0, { stmtIntRef });
+    return table;
+  }
+
+  Table table{ 2 };
+  if (stmtIntRefs.count(stmtIntRef) == 0) {
+    return table;
+  }
+  for (const Cfg::StmtRange& range : loopNestingForest.getNextTRanges(getStmtNumFromIntRef(stmtIntRef))) {
+    for (int next = range.first; next <= range.second; next++) {
+      table.insertRow({ stmtIntRef, getIntRefFromStmtNum(next) });
+    }
+  }
+  return table;
+}
+
+Table Pkb::getNextTTableTo(const int stmtIntRef) const {
+  if (!isNextTOnDemand) {
+    Table table = nextTTable;
+    table.filterColumn(1, { stmtIntRef });
+    return table;
+  }
+
+  Table table{ 2 };
+  if (stmtIntRefs.count(stmtIntRef) == 0) {
+    return table;
+  }
+  for (const Cfg::StmtRange& range : loopNestingForest.getPrevTRanges(getStmtNumFromIntRef(stmtIntRef))) {
+    for (int prev = range.first; prev <= range.second; prev++) {
+      table.insertRow({ getIntRefFromStmtNum(prev), stmtIntRef });
+    }
+  }
+  return table;
+}
+
+Table Pkb::getAffectsTableFrom(const int stmtIntRef) const {
+  if (!isAffectsOnDemand) {
+    Table table = affectsTable;
+    table.filterColumn(0, { stmtIntRef });
+    return table;
+  }
+
+  Table table{ 2 };
+  if (stmtIntRefs.count(stmtIntRef) == 0) {
+    return table;
+  }
+  for (const int affected : affectsSearch.getAffected(cfg, getStmtNumFromIntRef(stmtIntRef))) {
+    table.insertRow({ stmtIntRef, getIntRefFromStmtNum(affected) });
+  }
+  return table;
+}
+
+Table Pkb::getAffectsTableTo(const int stmtIntRef) const {
+  if (!isAffectsOnDemand) {
+    Table table = affectsTable;
+    table.filterColumn(1, { stmtIntRef });
+    return table;
+  }
+
+  Table table{ 2 };
+  if (stmtIntRefs.count(stmtIntRef) == 0) {
+    return table;
+  }
+  for (const int affecter : affectsSearch.getAffecters(cfg, getStmtNumFromIntRef(stmtIntRef))) {
+    table.insertRow({ getIntRefFromStmtNum(affecter), stmtIntRef });
+  }
+  return table;
+}
+
+Table Pkb::getNextBipTTableFrom(const int stmtIntRef) const {
+  if (!isNextBipTOnDemand) {
+    Table table = nextBipTTable;
+    table.filterColumn(0, { stmtIntRef });
+    return table;
+  }
+
+  Table table{ 2 };
+  if (stmtIntRefs.count(stmtIntRef) == 0) {
+    return table;
+  }
+  for (const int next : nextBipReachability.getReachableStmts(getStmtNumFromIntRef(stmtIntRef))) {
+    table.insertRow({ stmtIntRef, getIntRefFromStmtNum(next) });
+  }
+  return table;
+}
+
+Table Pkb::getNextBipTTableTo(const int stmtIntRef) const {
+  if (!isNextBipTOnDemand) {
+    Table table = nextBipTTable;
+    table.filterColumn(1, { stmtIntRef });
+    return table;
+  }
+
+  Table table{ 2 };
+  if (stmtIntRefs.count(stmtIntRef) == 0) {
+    return table;
+  }
+  for (const int prev : nextBipReachability.getReachingStmts(getStmtNumFromIntRef(stmtIntRef))) {
+    table.insertRow({ getIntRefFromStmtNum(prev), stmtIntRef });
+  }
+  return table;
+}
+
+Profiler::TableSizes Pkb::getTableSizes() const {
+  return {
+    { "varTable", varTable.size() },
+    { "stmtTable", stmtTable.size() },
+    { "procTable", procTable.size() },
+    { "constTable", constTable.size() },
+    { "ifTable", ifTable.size() },
+    { "whileTable", whileTable.size() },
+    { "readTable", readTable.size() },
+    { "printTable", printTable.size() },
+    { "assignTable", assignTable.size() },
+    { "callTable", callTable.size() },
+    { "followsTable", followsTable.size() },
+    { "followsTTable", followsTTable.size() },
+    { "parentTable", parentTable.size() },
+    { "parentTTable", parentTTable.size() },
+    { "usesSTable", usesSTable.size() },
+    { "usesPTable", usesPTable.size() },
+    { "modifiesSTable", modifiesSTable.size() },
+    { "modifiesPTable", modifiesPTable.size() },
+    { "callsTable", callsTable.size() },
+    { "callsTTable", callsTTable.size() },
+    { "nextTable", nextTable.size() },
+    { "nextTTable", nextTTable.size() },
+    { "affectsTable", affectsTable.size() },
+    { "affectsTTable", affectsTTable.size() },
+    { "nextBipTable", nextBipTable.size() },
+    { "nextBipTTable", nextBipTTable.size() },
+    { "affectsBipTable", affectsBipTable.size() },
+    { "affectsBipTTable", affectsBipTTable.size() },
+    { "callProcTable", callProcTable.size() },
+    { "readVarTable", readVarTable.size() },
+    { "printVarTable", printVarTable.size() },
+    { "patternAssignTable", patternAssignTable.size() },
+    { "patternIfTable", patternIfTable.size() },
+    { "patternWhileTable", patternWhileTable.size() }
+  };
 }
@@ -6,12 +6,27 @@
 #include <unordered_set>
 #include <vector>
 
+#include "AffectsSearch.h"
+#include "BipReachability.h"
 #include "Cfg.h"
+#include "ExprDag.h"
+#include "LoopNestingForest.h"
+#include "Profiler.h"
+#include "Span.h"
 #include "Table.h"
 
 class Pkb {
 private:
+  // Loads facts into the tables in bulk, see PkbBuilder
+  friend class PkbBuilder;
+
   Cfg::Cfg cfg;
+  Cfg::BipReachability nextBipReachability;
+  bool isNextBipTOnDemand = false;
+  Cfg::LoopNestingForest loopNestingForest;
+  bool isNextTOnDemand = false;
+  Cfg::AffectsSearch affectsSearch;
+  bool isAffectsOnDemand = false;
 
   Table varTable{ 1 };
   Table stmtTable{ 1 };
@@ -49,7 +64,7 @@ private:
   Table readVarTable{ 2 };
   Table printVarTable{ 2 };
 
-  Table patternAssignTable{ 3 };
+  Table patternAssignTable{ 3 }; // {stmt, lhs, node of the rhs in exprDag}
   Table patternIfTable{ 2 };
   Table patternWhileTable{ 2 };
 
@@ -65,6 +80,16 @@ private:
   std::unordered_set<int> assignIntRefs;
   std::unordered_set<int> callIntRefs;
 
+  // Right hand sides of assign statements, with variables and constants as integer references
+  ExprDag exprDag;
+  // Rows of patternAssignTable, one after another, by every subexpression of their rhs
+  std::unordered_map<int, std::vector<int>> subExprToPatternAssignRows;
+  // Statements of the rows of patternIfTable, patternWhileTable and patternAssignTable by the
+  // variable in their second column, in ascending order of integer reference
+  std::unordered_map<int, std::vector<int>> varToPatternIfStmts;
+  std::unordered_map<int, std::vector<int>> varToPatternWhileStmts;
+  std::unordered_map<int, std::vector<int>> lhsToPatternAssignStmts;
+
   std::unordered_map<int, std::string> intRefToEntityMapper;
   std::unordered_map<std::string, int> entityToIntRefMapper;
 
@@ -83,11 +108,37 @@ public:
   Pkb();
 
   /**
-   * Initialises the CFGBip.
+   * Initialises the CFGBip, freezing the CFG first.
    * 
    */
   void initialiseCfgBip(const std::list<std::string>& topoProc);
 
+  /**
+   * Summarises the CFGBip for NextBip* queries. Requires that the CFGBip be initialised.
+   *
+   * @param isOnDemand Whether NextBip* is computed from the summary when queried instead of
+   *     being read from nextBipTTable.
+   */
+  void initialiseNextBipReachability(const bool isOnDemand);
+
+  /**
+   * Builds the loop nesting forest for Next* queries. Requires that the CFG be frozen and
+   * that all Parent relations be filled in.
+   *
+   * @param isOnDemand Whether Next* is computed from the forest when queried instead of
+   *     being read from nextTTable.
+   */
+  void initialiseLoopNestingForest(const bool isOnDemand);
+
+  /**
+   * Indexes the statements for searching Affects from or to a single statement. Requires
+   * that the CFG be frozen and that all Modifies and Uses relations be filled in.
+   *
+   * @param isOnDemand Whether Affects of a single statement is searched for when queried
+   *     instead of being read from affectsTable, i.e. whether affectsTable is not filled in.
+   */
+  void initialiseAffectsSearch(const bool isOnDemand);
+
   /**
    * Adds the range of statement numbers that belong to a procedure.
    *
@@ -114,6 +165,12 @@ public:
    */
   void addCfgEdge(const int from, const int to);
 
+  /**
+   * Lays out the CFG edges added so far for traversal. Required after the last edge is added
+   * and before the CFG is read; does nothing if the CFG is already frozen.
+   */
+  void freezeCfg();
+
   /**
    * Adds a variable name into varTable.
    *
@@ -329,7 +386,8 @@ public:
   void addAffectsBipT(const int affecter, const int affected);
 
   /**
-   * Adds the Row {stmtNum, lhs, rhs} into patternAssignTable.
+   * Adds the Row {stmtNum, lhs, rhs} into patternAssignTable, with rhs given by its node in
+   * the expression DAG (see getExprFromPostfixExpr).
    *
    * @param stmtNum Statement number of the assign statement
    * @param lhs String of the left hand side of the assign statement
@@ -458,6 +516,24 @@ public:
    */
   Table getPatternAssignTable() const;
 
+  /**
+   * Finds the rows of patternAssignTable whose right hand side has the given expression as a
+   * subexpression (or is the expression), from an index built as the rows are added.
+   *
+   * @param subExpr Node of the expression, see getExprFromPostfixExpr.
+   * @return Rows {stmt, lhs, rhs} of patternAssignTable.
+   */
+  Table getPatternAssignTableWithSubExpr(const int subExpr) const;
+
+  /**
+   * Finds the statements and left hand sides of the rows of patternAssignTable with any of the
+   * given variables on the left hand side, from the statements indexed by each variable.
+   *
+   * @param varIntRefs Integer references of the variables of interest.
+   * @return Rows {stmt, lhs} of patternAssignTable without the rhs column.
+   */
+  Table getPatternAssignLhsTableWithVars(const std::unordered_set<int>& varIntRefs) const;
+
   /**
    * @return callTable
    */
@@ -483,11 +559,47 @@ public:
    */
   Table getNextTTable() const;
 
+  /**
+   * Finds the rows of nextTTable with the given statement as the first column. When
+   * Next* is computed on demand, only the rows of the given statement are computed.
+   *
+   * @param stmtIntRef Integer reference of the statement of interest.
+   * @return Rows {stmtIntRef, next} of nextTTable.
+   */
+  Table getNextTTableFrom(const int stmtIntRef) const;
+
+  /**
+   * Finds the rows of nextTTable with the given statement as the second column. When
+   * Next* is computed on demand, only the rows of the given statement are computed.
+   *
+   * @param stmtIntRef Integer reference of the statement of interest.
+   * @return Rows {prev, stmtIntRef} of nextTTable.
+   */
+  Table getNextTTableTo(const int stmtIntRef) const;
+
   /**
    * @return affectsTable
    */
   Table getAffectsTable() const;
 
+  /**
+   * Finds the rows of affectsTable with the given statement as the first column. When
+   * affectsTable is not filled in, only the rows of the given statement are searched for.
+   *
+   * @param stmtIntRef Integer reference of the statement of interest.
+   * @return Rows {stmtIntRef, affected} of affectsTable.
+   */
+  Table getAffectsTableFrom(const int stmtIntRef) const;
+
+  /**
+   * Finds the rows of affectsTable with the given statement as the second column. When
+   * affectsTable is not filled in, only the rows of the given statement are searched for.
+   *
+   * @param stmtIntRef Integer reference of the statement of interest.
+   * @return Rows {affecter, stmtIntRef} of affectsTable.
+   */
+  Table getAffectsTableTo(const int stmtIntRef) const;
+
   /**
    * @return affectsTTable
    */
@@ -503,6 +615,24 @@ public:
    */
   Table getNextBipTTable() const;
 
+  /**
+   * Finds the rows of nextBipTTable with the given statement as the first column. When
+   * NextBip* is computed on demand, only the rows of the given statement are computed.
+   *
+   * @param stmtIntRef Integer reference of the statement of interest.
+   * @return Rows {stmtIntRef, next} of nextBipTTable.
+   */
+  Table getNextBipTTableFrom(const int stmtIntRef) const;
+
+  /**
+   * Finds the rows of nextBipTTable with the given statement as the second column. When
+   * NextBip* is computed on demand, only the rows of the given statement are computed.
+   *
+   * @param stmtIntRef Integer reference of the statement of interest.
+   * @return Rows {prev, stmtIntRef} of nextBipTTable.
+   */
+  Table getNextBipTTableTo(const int stmtIntRef) const;
+
   /**
    * @return affectsBipTable
    */
@@ -548,6 +678,24 @@ public:
    */
   Table getPatternWhileTable() const;
 
+  /**
+   * Finds the rows of patternIfTable with any of the given variables, from the statements
+   * indexed by each variable.
+   *
+   * @param varIntRefs Integer references of the variables of interest.
+   * @return Rows {stmt, var} of patternIfTable.
+   */
+  Table getPatternIfTableWithVars(const std::unordered_set<int>& varIntRefs) const;
+
+  /**
+   * Finds the rows of patternWhileTable with any of the given variables, from the statements
+   * indexed by each variable.
+   *
+   * @param varIntRefs Integer references of the variables of interest.
+   * @return Rows {stmt, var} of patternWhileTable.
+   */
+  Table getPatternWhileTableWithVars(const std::unordered_set<int>& varIntRefs) const;
+
   /**
    * @return varIntRefs
    */
@@ -615,6 +763,17 @@ public:
    */
   std::string getEntityFromIntRef(const int intRef) const;
 
+  /**
+   * Returns the node of an expression in the right hand side of some assign statement, as
+   * stored in the third column of patternAssignTable.
+   * Returns -1 if no assign statement has the expression in its right hand side.
+   *
+   * @param postfixExpr String of the postfix form of the expression.
+   * @return Node of the expression.
+   */
+  int getExprFromPostfixExpr(const std::string& postfixExpr) const;
+
+
   /**
    * Returns the integer reference of a given statement number.
    * Returns -1 if statement number does not exist.
@@ -704,12 +863,21 @@ public:
 
   /**
    * Finds the set of stmts that can be directly executed after the given stmt number in the CFG.
-   * If there are no nodes following, an empty set is returned.
+   * If there are no nodes following, an empty set is returned. Requires that the CFG be frozen.
    *
    * @param stmtNum Statement number of interest.
-   * @return std::vector<int> List of nodes.
+   * @return Span<int> List of nodes, valid until the CFG is frozen again.
    */
-  std::vector<int> getNextStmtsFromCfg(const int stmtNum) const;
+  Span<int> getNextStmtsFromCfg(const int stmtNum) const;
+
+  /**
+   * Finds the set of stmts that can be directly executed before the given stmt number in the CFG.
+   * If there are no nodes preceding, an empty set is returned. Requires that the CFG be frozen.
+   *
+   * @param stmtNum Statement number of interest.
+   * @return Span<int> List of nodes, valid until the CFG is frozen again.
+   */
+  Span<int> getPrevStmtsFromCfg(const int stmtNum) const;
 
   /**
    * Finds the first statement of a given procedure.
@@ -736,13 +904,77 @@ public:
   std::string getProcFromStmt(const int stmt) const;
 
   /**
-   * Gets the list of pointers to the startNodes of relevant topo-sorted procedures in the CFGBip.
+   * Gets the CFG, with its basic blocks. Requires that the CFG be frozen.
+   *
+   * @return Cfg::Cfg The CFG.
+   */
+  const Cfg::Cfg& getCfg() const;
+
+  /**
+   * Gets the graphs of all procedures in the CFGBip, in topological order of the call graph.
+   *
+   * @return Cfg::CfgBip Graphs of all procedures in the CFGBip.
+   */
+  const Cfg::CfgBip& getCfgBip() const;
+
+  /**
+   * Gets the number of rows in every table, for profiling.
    *
-   * @return std::vector<std::shared_ptr<Cfg::BipNode>> List of pointers to the startNodes of relevant topo-sorted procedures in the CFGBip.
+   * @return Profiler::TableSizes Name and number of rows of each table.
    */
-  std::vector<std::shared_ptr<Cfg::BipNode>> getStartBipNodes() const;
+  Profiler::TableSizes getTableSizes() const;
+
+  /**
+   * Gets the summary of the CFGBip used for NextBip* queries.
+   *
+   * @return Cfg::BipReachability Summary of the CFGBip.
+   */
+  const Cfg::BipReachability& getNextBipReachability() const;
+
+  /**
+   * Gets the loop nesting forest used for Next* queries.
+   *
+   * @return Cfg::LoopNestingForest Loop nesting forest of the program.
+   */
+  const Cfg::LoopNestingForest& getLoopNestingForest() const;
 
 private:
+  /**
+   * Finds the largest statement number of the program.
+   *
+   * @return The largest statement number, 0 if there are no statements.
+   */
+  int getMaxStmtNum() const;
+
+  /**
+   * Indexes a row of patternAssignTable by every distinct subexpression of its right hand side.
+   *
+   * @param stmtIntRef Integer reference of the assign statement.
+   * @param lhsIntRef Integer reference of the variable on the left hand side.
+   * @param rhsExpr Node of the right hand side.
+   */
+  void indexPatternAssign(const int stmtIntRef, const int lhsIntRef, const int rhsExpr);
+
+  /**
+   * Adds a statement to those indexed by a variable, keeping them in ascending order.
+   *
+   * @param postings Statements indexed by each variable.
+   * @param varIntRef Integer reference of the variable.
+   * @param stmtIntRef Integer reference of the statement, ignored if already indexed.
+   */
+  static void addPosting(std::unordered_map<int, std::vector<int>>& postings, const int varIntRef,
+    const int stmtIntRef);
+
+  /**
+   * Merges the statements indexed by any of the given variables into rows {stmt, var}.
+   *
+   * @param postings Statements indexed by each variable.
+   * @param varIntRefs Integer references of the variables of interest.
+   * @return Rows {stmt, var} for every statement indexed by a variable of interest.
+   */
+  static Table getPostingsTable(const std::unordered_map<int, std::vector<int>>& postings,
+    const std::unordered_set<int>& varIntRefs);
+
   /**
    * Adds the given entity to the PKB if not yet added and returns the integer reference of the entity.
    * 
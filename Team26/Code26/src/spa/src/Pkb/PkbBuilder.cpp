@@ -0,0 +1,299 @@
+#include "PkbBuilder.h"
+
+#include <assert.h>
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Pkb.h"
+#include "Table.h"
+
+namespace {
+  /**
+   * Sorts rows of values laid out one row after another and removes duplicate rows.
+   *
+   * @param values Values of the rows, replaced by those of the distinct rows in ascending order.
+   * @param numColumns Number of values in each row.
+   */
+  void sortUniqueRows(std::vector<int>& values, const size_t numColumns) {
+    if (numColumns == 1) {
+      std::sort(values.begin(), values.end());
+      values.erase(std::unique(values.begin(), values.end()), values.end());
+      return;
+    }
+
+    const size_t numRows = values.size() / numColumns;
+    std::vector<size_t> order(numRows);
+    for (size_t row = 0; row < numRows; row++) {
+      order[row] = row * numColumns;
+    }
+    auto isRowLess = [&values, numColumns](size_t first, size_t second) {
+      return std::lexicographical_compare(values.begin() + first, values.begin() + first + numColumns,
+        values.begin() + second, values.begin() + second + numColumns);
+    };
+    std::sort(order.begin(), order.end(), isRowLess);
+
+    std::vector<int> uniqueValues;
+    uniqueValues.reserve(values.size());
+    for (size_t i = 0; i < numRows; i++) {
+      if (i > 0 && !isRowLess(order[i - 1], order[i])) {
+        continue;
+      }
+      uniqueValues.insert(uniqueValues.end(), values.begin() + order[i], values.begin() + order[i] + numColumns);
+    }
+    values.swap(uniqueValues);
+  }
+}
+
+PkbBuilder::PkbBuilder(Pkb& pkb) : pkb(pkb) {
+}
+
+int PkbBuilder::getStmtIntRef(const int stmtNum) {
+  assert(stmtNum > 0);
+  if ((size_t)stmtNum >= stmtNumToIntRef.size()) {
+    stmtNumToIntRef.resize(std::max((size_t)stmtNum + 1, stmtNumToIntRef.size() * 2), -1);
+  }
+  if (stmtNumToIntRef[stmtNum] == -1) {
+    stmtNumToIntRef[stmtNum] = pkb.addEntity(std::to_string(stmtNum));
+  }
+  return stmtNumToIntRef[stmtNum];
+}
+
+void PkbBuilder::appendStmts(const Buffer buffer, const int first, const int second) {
+  buffers[buffer].push_back(getStmtIntRef(first));
+  buffers[buffer].push_back(getStmtIntRef(second));
+}
+
+void PkbBuilder::appendStmtEntity(const Buffer buffer, const int stmtNum, const int intRef) {
+  buffers[buffer].push_back(getStmtIntRef(stmtNum));
+  buffers[buffer].push_back(intRef);
+}
+
+void PkbBuilder::appendTypedStmt(const Buffer buffer, const int stmtNum) {
+  const int stmtIntRef = getStmtIntRef(stmtNum);
+  buffers[buffer].push_back(stmtIntRef);
+  buffers[STMT].push_back(stmtIntRef);
+}
+
+Table& PkbBuilder::getTable(const Buffer buffer) {
+  switch (buffer) {
+  case VAR: return pkb.varTable;
+  case STMT: return pkb.stmtTable;
+  case PROC: return pkb.procTable;
+  case CONST: return pkb.constTable;
+  case IF: return pkb.ifTable;
+  case WHILE: return pkb.whileTable;
+  case READ: return pkb.readTable;
+  case PRINT: return pkb.printTable;
+  case ASSIGN: return pkb.assignTable;
+  case CALL: return pkb.callTable;
+  case FOLLOWS: return pkb.followsTable;
+  case FOLLOWS_T: return pkb.followsTTable;
+  case PARENT: return pkb.parentTable;
+  case PARENT_T: return pkb.parentTTable;
+  case USES_S: return pkb.usesSTable;
+  case USES_P: return pkb.usesPTable;
+  case MODIFIES_S: return pkb.modifiesSTable;
+  case MODIFIES_P: return pkb.modifiesPTable;
+  case CALLS: return pkb.callsTable;
+  case CALLS_T: return pkb.callsTTable;
+  case NEXT: return pkb.nextTable;
+  case NEXT_T: return pkb.nextTTable;
+  case AFFECTS: return pkb.affectsTable;
+  case AFFECTS_T: return pkb.affectsTTable;
+  case NEXT_BIP: return pkb.nextBipTable;
+  case NEXT_BIP_T: return pkb.nextBipTTable;
+  case AFFECTS_BIP: return pkb.affectsBipTable;
+  case AFFECTS_BIP_T: return pkb.affectsBipTTable;
+  case CALL_PROC: return pkb.callProcTable;
+  case READ_VAR: return pkb.readVarTable;
+  case PRINT_VAR: return pkb.printVarTable;
+  case PATTERN_ASSIGN: return pkb.patternAssignTable;
+  case PATTERN_IF: return pkb.patternIfTable;
+  case PATTERN_WHILE: return pkb.patternWhileTable;
+  default:
+    assert(false);
+    return pkb.varTable;
+  }
+}
+
+std::unordered_set<int>* PkbBuilder::getIntRefs(const Buffer buffer) {
+  switch (buffer) {
+  case VAR: return &pkb.varIntRefs;
+  case STMT: return &pkb.stmtIntRefs;
+  case PROC: return &pkb.procIntRefs;
+  case CONST: return &pkb.constIntRefs;
+  case IF: return &pkb.ifIntRefs;
+  case WHILE: return &pkb.whileIntRefs;
+  case READ: return &pkb.readIntRefs;
+  case PRINT: return &pkb.printIntRefs;
+  case ASSIGN: return &pkb.assignIntRefs;
+  case CALL: return &pkb.callIntRefs;
+  default: return nullptr;
+  }
+}
+
+std::unordered_map<int, std::string>* PkbBuilder::getNameMapper(const Buffer buffer) {
+  switch (buffer) {
+  case CALL_PROC: return &pkb.callIntRefToProcMapper;
+  case READ_VAR: return &pkb.readIntRefToVarMapper;
+  case PRINT_VAR: return &pkb.printIntRefToVarMapper;
+  default: return nullptr;
+  }
+}
+
+std::unordered_map<int, std::vector<int>>* PkbBuilder::getPostings(const Buffer buffer) {
+  switch (buffer) {
+  case PATTERN_ASSIGN: return &pkb.lhsToPatternAssignStmts;
+  case PATTERN_IF: return &pkb.varToPatternIfStmts;
+  case PATTERN_WHILE: return &pkb.varToPatternWhileStmts;
+  default: return nullptr;
+  }
+}
+
+int PkbBuilder::addEntity(const std::string& entity) {
+  return pkb.addEntity(entity);
+}
+
+int PkbBuilder::addExprLeaf(const int nameIntRef) {
+  return pkb.exprDag.addLeaf(nameIntRef);
+}
+
+int PkbBuilder::addExprOperator(const char op, const int left, const int right) {
+  return pkb.exprDag.addOperator(op, left, right);
+}
+
+void PkbBuilder::addCfgEdge(const int from, const int to) {
+  pkb.cfg.addEdge(from, to);
+  if (to < 0) {
+    assert(from > 0);
+  } else {
+    addNext(from, to);
+  }
+}
+
+void PkbBuilder::addProcRange(const std::string& proc, const int first, const int last) {
+  pkb.addProcRange(proc, first, last);
+}
+
+void PkbBuilder::addProcStartEnd(const std::string& proc, const int start, const std::vector<int>& end) {
+  pkb.addProcStartEnd(proc, start, end);
+}
+
+void PkbBuilder::addVar(const int varIntRef) { buffers[VAR].push_back(varIntRef); }
+void PkbBuilder::addStmt(const int stmtNum) { buffers[STMT].push_back(getStmtIntRef(stmtNum)); }
+void PkbBuilder::addProc(const int procIntRef) { buffers[PROC].push_back(procIntRef); }
+void PkbBuilder::addConst(const int constIntRef) { buffers[CONST].push_back(constIntRef); }
+void PkbBuilder::addIf(const int stmtNum) { appendTypedStmt(IF, stmtNum); }
+void PkbBuilder::addWhile(const int stmtNum) { appendTypedStmt(WHILE, stmtNum); }
+void PkbBuilder::addRead(const int stmtNum) { appendTypedStmt(READ, stmtNum); }
+void PkbBuilder::addPrint(const int stmtNum) { appendTypedStmt(PRINT, stmtNum); }
+void PkbBuilder::addAssign(const int stmtNum) { appendTypedStmt(ASSIGN, stmtNum); }
+void PkbBuilder::addCall(const int stmtNum) { appendTypedStmt(CALL, stmtNum); }
+
+void PkbBuilder::addFollows(const int followed, const int follower) {
+  assert(followed < follower);
+  appendStmts(FOLLOWS, followed, follower);
+}
+
+void PkbBuilder::addFollowsT(const int followed, const int follower) {
+  assert(followed < follower);
+  appendStmts(FOLLOWS_T, followed, follower);
+}
+
+void PkbBuilder::addParent(const int parent, const int child) {
+  assert(parent < child);
+  appendStmts(PARENT, parent, child);
+}
+
+void PkbBuilder::addParentT(const int parent, const int child) {
+  assert(parent < child);
+  appendStmts(PARENT_T, parent, child);
+}
+
+void PkbBuilder::addUsesS(const int stmtNum, const int varIntRef) { appendStmtEntity(USES_S, stmtNum, varIntRef); }
+void PkbBuilder::addModifiesS(const int stmtNum, const int varIntRef) { appendStmtEntity(MODIFIES_S, stmtNum, varIntRef); }
+
+void PkbBuilder::addUsesP(const int procIntRef, const int varIntRef) {
+  buffers[USES_P].push_back(procIntRef);
+  buffers[USES_P].push_back(varIntRef);
+}
+
+void PkbBuilder::addModifiesP(const int procIntRef, const int varIntRef) {
+  buffers[MODIFIES_P].push_back(procIntRef);
+  buffers[MODIFIES_P].push_back(varIntRef);
+}
+
+void PkbBuilder::addCalls(const int callerIntRef, const int calledIntRef) {
+  buffers[CALLS].push_back(callerIntRef);
+  buffers[CALLS].push_back(calledIntRef);
+}
+
+void PkbBuilder::addCallsT(const int callerIntRef, const int calledIntRef) {
+  buffers[CALLS_T].push_back(callerIntRef);
+  buffers[CALLS_T].push_back(calledIntRef);
+}
+
+void PkbBuilder::addNext(const int prev, const int next) { appendStmts(NEXT, prev, next); }
+void PkbBuilder::addNextT(const int prev, const int next) { appendStmts(NEXT_T, prev, next); }
+void PkbBuilder::addAffects(const int affecter, const int affected) { appendStmts(AFFECTS, affecter, affected); }
+void PkbBuilder::addAffectsT(const int affecter, const int affected) { appendStmts(AFFECTS_T, affecter, affected); }
+void PkbBuilder::addNextBip(const int prev, const int next) { appendStmts(NEXT_BIP, prev, next); }
+void PkbBuilder::addNextBipT(const int prev, const int next) { appendStmts(NEXT_BIP_T, prev, next); }
+void PkbBuilder::addAffectsBip(const int affecter, const int affected) { appendStmts(AFFECTS_BIP, affecter, affected); }
+void PkbBuilder::addAffectsBipT(const int affecter, const int affected) { appendStmts(AFFECTS_BIP_T, affecter, affected); }
+void PkbBuilder::addCallProc(const int stmtNum, const int procIntRef) { appendStmtEntity(CALL_PROC, stmtNum, procIntRef); }
+void PkbBuilder::addReadVar(const int stmtNum, const int varIntRef) { appendStmtEntity(READ_VAR, stmtNum, varIntRef); }
+void PkbBuilder::addPrintVar(const int stmtNum, const int varIntRef) { appendStmtEntity(PRINT_VAR, stmtNum, varIntRef); }
+
+void PkbBuilder::addPatternAssign(const int stmtNum, const int lhsIntRef, const int rhsIntRef) {
+  appendStmtEntity(PATTERN_ASSIGN, stmtNum, lhsIntRef);
+  buffers[PATTERN_ASSIGN].push_back(rhsIntRef);
+}
+
+void PkbBuilder::addPatternIf(const int stmtNum, const int varIntRef) { appendStmtEntity(PATTERN_IF, stmtNum, varIntRef); }
+void PkbBuilder::addPatternWhile(const int stmtNum, const int varIntRef) { appendStmtEntity(PATTERN_WHILE, stmtNum, varIntRef); }
+
+void PkbBuilder::build() {
+  for (int buffer = 0; buffer < NUM_BUFFERS; buffer++) {
+    std::vector<int>& values = buffers[buffer];
+    if (values.empty()) {
+      continue;
+    }
+
+    Table& table = getTable((Buffer)buffer);
+    const size_t numColumns = table.getHeader().size();
+    sortUniqueRows(values, numColumns);
+    if (buffer == PATTERN_ASSIGN) {
+      for (size_t row = 0; row < values.size(); row += numColumns) {
+        if (!table.contains({ values[row], values[row + 1], values[row + 2] })) {
+          pkb.indexPatternAssign(values[row], values[row + 1], values[row + 2]);
+        }
+      }
+    }
+    table.insertRows(values);
+
+    std::unordered_set<int>* intRefs = getIntRefs((Buffer)buffer);
+    if (intRefs != nullptr) {
+      intRefs->reserve(intRefs->size() + values.size());
+      intRefs->insert(values.begin(), values.end());
+    }
+    std::unordered_map<int, std::vector<int>>* postings = getPostings((Buffer)buffer);
+    if (postings != nullptr) {
+      for (size_t row = 0; row < values.size(); row += numColumns) {
+        Pkb::addPosting(*postings, values[row + 1], values[row]);
+      }
+    }
+    std::unordered_map<int, std::string>* nameMapper = getNameMapper((Buffer)buffer);
+    if (nameMapper != nullptr) {
+      for (size_t row = 0; row < values.size(); row += numColumns) {
+        (*nameMapper)[values[row]] = pkb.getEntityFromIntRef(values[row + 1]);
+      }
+    }
+
+    std::vector<int>().swap(values);
+  }
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Pkb.h"
+#include "Table.h"
+
+/**
+ * Loads facts into a Pkb in bulk. Facts are appended to a flat buffer per table as they
+ * are added, and only inserted into the tables of the Pkb by build(), which sorts each
+ * buffer, removes duplicate rows and inserts the rest with space reserved for all of them.
+ *
+ * Statements are given by their statement numbers, and all other entities by their integer
+ * references in the Pkb (see addEntity), so that the entity of a statement is only looked
+ * up once however many facts it appears in, and other entities not at all.
+ *
+ * Facts added since the last build() are not visible in the Pkb, except for CFG edges,
+ * procedure ranges and expressions, which are added to the Pkb directly.
+ */
+class PkbBuilder {
+private:
+  enum Buffer {
+    VAR, STMT, PROC, CONST, IF, WHILE, READ, PRINT, ASSIGN, CALL, FOLLOWS, FOLLOWS_T, PARENT,
+    PARENT_T, USES_S, USES_P, MODIFIES_S, MODIFIES_P, CALLS, CALLS_T, NEXT, NEXT_T, AFFECTS,
+    AFFECTS_T, NEXT_BIP, NEXT_BIP_T, AFFECTS_BIP, AFFECTS_BIP_T, CALL_PROC, READ_VAR, PRINT_VAR,
+    PATTERN_ASSIGN, PATTERN_IF, PATTERN_WHILE, NUM_BUFFERS
+  };
+
+  Pkb& pkb;
+  // Values of the rows of each table, one row after another
+  std::vector<int> buffers[NUM_BUFFERS];
+  // Integer reference of each statement number, -1 if not looked up yet
+  std::vector<int> stmtNumToIntRef;
+
+  /**
+   * Returns the integer reference of a statement, adding its entity to the Pkb if new.
+   *
+   * @param stmtNum Statement number of the statement.
+   * @returns Integer reference of the statement.
+   */
+  int getStmtIntRef(const int stmtNum);
+
+  /**
+   * Appends a row of statements to a buffer.
+   *
+   * @param buffer Buffer of the table of the row.
+   * @param first Statement number in the first column.
+   * @param second Statement number in the second column.
+   */
+  void appendStmts(const Buffer buffer, const int first, const int second);
+
+  /**
+   * Appends a row with a statement and another entity to a buffer.
+   *
+   * @param buffer Buffer of the table of the row.
+   * @param stmtNum Statement number in the first column.
+   * @param intRef Integer reference in the second column.
+   */
+  void appendStmtEntity(const Buffer buffer, const int stmtNum, const int intRef);
+
+  /**
+   * Appends a statement to the buffer of a type of statement and to that of all statements.
+   *
+   * @param buffer Buffer of the type of statement.
+   * @param stmtNum Statement number of the statement.
+   */
+  void appendTypedStmt(const Buffer buffer, const int stmtNum);
+
+  /**
+   * Returns the table of the Pkb filled from a buffer.
+   *
+   * @param buffer Buffer of interest.
+   * @returns Table filled from the buffer.
+   */
+  Table& getTable(const Buffer buffer);
+
+  /**
+   * Returns the set of integer references of the Pkb filled from a buffer with one column.
+   *
+   * @param buffer Buffer of interest.
+   * @returns Set filled from the buffer, nullptr if there is none.
+   */
+  std::unordered_set<int>* getIntRefs(const Buffer buffer);
+
+  /**
+   * Returns the mapper of the Pkb from statements to names filled from a buffer with two
+   * columns.
+   *
+   * @param buffer Buffer of interest.
+   * @returns Mapper filled from the buffer, nullptr if there is none.
+   */
+  std::unordered_map<int, std::string>* getNameMapper(const Buffer buffer);
+
+  /**
+   * Returns the statements of the Pkb indexed by variable filled from a buffer of a pattern
+   * table.
+   *
+   * @param buffer Buffer of interest.
+   * @returns Statements indexed by the variable in the second column of each row, nullptr if
+   *     there are none.
+   */
+  std::unordered_map<int, std::vector<int>>* getPostings(const Buffer buffer);
+
+public:
+  /**
+   * Constructs a builder with no facts.
+   *
+   * @param pkb The Pkb to load facts into.
+   */
+  explicit PkbBuilder(Pkb& pkb);
+
+  /**
+   * Adds an entity to the Pkb if not yet added.
+   *
+   * @param entity Entity to be added.
+   * @returns Integer reference of the entity.
+   */
+  int addEntity(const std::string& entity);
+
+  /**
+   * Adds a variable or constant to the expression DAG of the Pkb if not yet added.
+   *
+   * @param nameIntRef Integer reference of the variable or constant.
+   * @returns Node of the variable or constant.
+   */
+  int addExprLeaf(const int nameIntRef);
+
+  /**
+   * Adds an expression applying an operator to two expressions to the expression DAG of the
+   * Pkb if not yet added.
+   *
+   * @param op Operator of the expression.
+   * @param left Node of the left operand.
+   * @param right Node of the right operand.
+   * @returns Node of the expression.
+   */
+  int addExprOperator(const char op, const int left, const int right);
+
+  /**
+   * Adds a directed edge into the CFG of the Pkb, and to Next if it leads to a statement.
+   *
+   * @param from Statement number of the statement executed first.
+   * @param to Statement number of the statement which can be executed immediately after,
+   *     or a negative dummy node.
+   */
+  void addCfgEdge(const int from, const int to);
+
+  /**
+   * Adds the range of statement numbers that belong to a procedure into the Pkb.
+   *
+   * @param proc Procedure in question.
+   * @param first Statement number of the first statement in the procedure.
+   * @param last Last statement number in the procedure.
+   */
+  void addProcRange(const std::string& proc, const int first, const int last);
+
+  /**
+   * Adds a procedure's first and last statement numbers in the control flow path into the Pkb.
+   *
+   * @param proc Procedure in question.
+   * @param start Statement number of the first statement in the control flow path.
+   * @param end Statement numbers of the last statements in the control flow path.
+   */
+  void addProcStartEnd(const std::string& proc, const int start, const std::vector<int>& end);
+
+  // The methods below buffer the same facts as the Pkb methods of the same name, with
+  // entities other than statements given by their integer references, and expressions by
+  // their nodes (see addExprLeaf).
+  void addVar(const int varIntRef);
+  void addStmt(const int stmtNum);
+  void addProc(const int procIntRef);
+  void addConst(const int constIntRef);
+  void addIf(const int stmtNum);
+  void addWhile(const int stmtNum);
+  void addRead(const int stmtNum);
+  void addPrint(const int stmtNum);
+  void addAssign(const int stmtNum);
+  void addCall(const int stmtNum);
+  void addFollows(const int followed, const int follower);
+  void addFollowsT(const int followed, const int follower);
+  void addParent(const int parent, const int child);
+  void addParentT(const int parent, const int child);
+  void addUsesS(const int stmtNum, const int varIntRef);
+  void addUsesP(const int procIntRef, const int varIntRef);
+  void addModifiesS(const int stmtNum, const int varIntRef);
+  void addModifiesP(const int procIntRef, const int varIntRef);
+  void addCalls(const int callerIntRef, const int calledIntRef);
+  void addCallsT(const int callerIntRef, const int calledIntRef);
+  void addNext(const int prev, const int next);
+  void addNextT(const int prev, const int next);
+  void addAffects(const int affecter, const int affected);
+  void addAffectsT(const int affecter, const int affected);
+  void addNextBip(const int prev, const int next);
+  void addNextBipT(const int prev, const int next);
+  void addAffectsBip(const int affecter, const int affected);
+  void addAffectsBipT(const int affecter, const int affected);
+  void addCallProc(const int stmtNum, const int procIntRef);
+  void addReadVar(const int stmtNum, const int varIntRef);
+  void addPrintVar(const int stmtNum, const int varIntRef);
+  void addPatternAssign(const int stmtNum, const int lhsIntRef, const int rhsIntRef);
+  void addPatternIf(const int stmtNum, const int varIntRef);
+  void addPatternWhile(const int stmtNum, const int varIntRef);
+
+  /**
+   * Inserts the facts buffered since the last build into the Pkb, and empties the buffers.
+   * Each table is grown once, by its number of distinct new rows. New rows of the pattern
+   * tables are also indexed by variable, and those of patternAssignTable by subexpression.
+   */
+  void build();
+};
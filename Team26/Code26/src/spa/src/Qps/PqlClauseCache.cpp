@@ -0,0 +1,137 @@
+#include "PqlClauseCache.h"
+
+#include <assert.h>
+
+#include <algorithm>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "PqlQuery.h"
+#include "Table.h"
+
+namespace {
+  /**
+   * Estimates the bytes held by a table. Each row is a node of a hash set, holding a vector of
+   * its values, and has a bucket of the set.
+   *
+   * @param table Table of interest.
+   * @returns Estimated number of bytes.
+   */
+  size_t estimateNumBytes(const Table& table) {
+    const Header header = table.getHeader();
+    size_t numBytes = sizeof(Table);
+    for (const std::string& title : header) {
+      numBytes += sizeof(std::string) + title.size();
+    }
+    const size_t numBytesPerRow = 3 * sizeof(void*) + sizeof(size_t) + sizeof(Row) + header.size() * sizeof(int);
+    return numBytes + table.size() * numBytesPerRow;
+  }
+
+  /**
+   * Replaces the headers of a table that are synonyms.
+   *
+   * @param table Table of interest.
+   * @param from Synonyms to replace.
+   * @param to Synonyms to replace them with, in the same order.
+   */
+  void renameHeaders(Table& table, const std::vector<std::string>& from, const std::vector<std::string>& to) {
+    Header header = table.getHeader();
+    for (std::string& title : header) {
+      const std::vector<std::string>::const_iterator synonym = std::find(from.begin(), from.end(), title);
+      if (synonym != from.end()) {
+        title = to[synonym - from.begin()];
+      }
+    }
+    table.setHeader(header);
+  }
+
+  /**
+   * Returns the names the synonyms of canonical clauses are given.
+   *
+   * @param numSynonyms Number of synonyms.
+   * @returns The names, in canonical order.
+   */
+  std::vector<std::string> getCanonicalSynonyms(const size_t numSynonyms) {
+    std::vector<std::string> synonyms;
+    for (size_t i = 0; i < numSynonyms; i++) {
+      synonyms.push_back(std::to_string(i));
+    }
+    return synonyms;
+  }
+}
+
+namespace Pql {
+  ClauseCache::ClauseCache(const size_t byteBudget)
+    : byteBudget(byteBudget), numBytes(0) {
+  }
+
+  Clause ClauseCache::getCanonicalClause(const Clause& clause, std::vector<std::string>& synonyms) {
+    std::vector<Entity> params = clause.getParams();
+    for (Entity& param : params) {
+      if (!param.isSynonym()) {
+        continue;
+      }
+      const std::string synonym = param.getValue();
+      const size_t idx = std::find(synonyms.begin(), synonyms.end(), synonym) - synonyms.begin();
+      if (idx == synonyms.size()) {
+        synonyms.push_back(synonym);
+      }
+      param = Entity(param.getType(), std::to_string(idx), param.getAttributeRefType());
+    }
+    return Clause(clause.getType(), params);
+  }
+
+  void ClauseCache::evict(const size_t maxNumBytes) {
+    while (numBytes > maxNumBytes) {
+      assert(!entries.empty());
+      numBytes -= entries.back().numBytes;
+      clauseToEntry.erase(entries.back().clause);
+      entries.pop_back();
+    }
+  }
+
+  bool ClauseCache::find(const Clause& clause, Table& table) {
+    std::vector<std::string> synonyms;
+    const std::unordered_map<Clause, EntryList::iterator>::iterator it =
+      clauseToEntry.find(getCanonicalClause(clause, synonyms));
+    if (it == clauseToEntry.end()) {
+      return false;
+    }
+    entries.splice(entries.begin(), entries, it->second);
+
+    table = it->second->table;
+    renameHeaders(table, getCanonicalSynonyms(synonyms.size()), synonyms);
+    return true;
+  }
+
+  void ClauseCache::add(const Clause& clause, const Table& table) {
+    std::vector<std::string> synonyms;
+    const Clause canonicalClause = getCanonicalClause(clause, synonyms);
+    const size_t tableNumBytes = estimateNumBytes(table);
+    if (tableNumBytes > byteBudget || clauseToEntry.count(canonicalClause) == 1) {
+      return;
+    }
+    evict(byteBudget - tableNumBytes);
+
+    entries.push_front({ canonicalClause, table, tableNumBytes });
+    renameHeaders(entries.front().table, synonyms, getCanonicalSynonyms(synonyms.size()));
+    clauseToEntry.emplace(canonicalClause, entries.begin());
+    numBytes += tableNumBytes;
+  }
+
+  void ClauseCache::clear() {
+    entries.clear();
+    clauseToEntry.clear();
+    numBytes = 0;
+  }
+
+  size_t ClauseCache::size() const {
+    return entries.size();
+  }
+
+  size_t ClauseCache::getNumBytes() const {
+    return numBytes;
+  }
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "PqlQuery.h"
+#include "Table.h"
+
+namespace Pql {
+  /**
+   * Least recently used cache of the result tables of clauses, shared by the queries evaluated
+   * on the same source. Clauses are keyed by their canonical form, in which synonyms are named
+   * after the order they appear in, so that clauses differing only in the names of their
+   * synonyms share a table.
+   *
+   * The cache holds at most the given number of bytes of tables, as estimated from their sizes.
+   */
+  class ClauseCache {
+  private:
+    struct Entry {
+      Clause clause; // Canonical form of the clause
+      Table table; // Result table, with the synonyms of the canonical form as headers
+      size_t numBytes;
+    };
+
+    typedef std::list<Entry> EntryList;
+
+    size_t byteBudget;
+    size_t numBytes;
+
+    // Entries, most recently used first
+    EntryList entries;
+    std::unordered_map<Clause, EntryList::iterator> clauseToEntry;
+
+    /**
+     * Returns the canonical form of a clause, in which the i-th distinct synonym is named i.
+     *
+     * @param clause Clause of interest.
+     * @param synonyms Filled with the names of the synonyms of the clause, in canonical order.
+     * @returns Canonical form of the clause.
+     */
+    static Clause getCanonicalClause(const Clause& clause, std::vector<std::string>& synonyms);
+
+    /**
+     * Evicts the least recently used entries until the cache holds at most the given number
+     * of bytes.
+     *
+     * @param maxNumBytes Most bytes to hold.
+     */
+    void evict(size_t maxNumBytes);
+
+  public:
+    /**
+     * Constructs an empty cache.
+     *
+     * @param byteBudget Most bytes of tables kept, 0 to keep none.
+     */
+    ClauseCache(size_t byteBudget);
+
+    /**
+     * Finds the result table of a clause and marks it most recently used.
+     *
+     * @param clause Clause of interest.
+     * @param table Set to a copy of the result table, with the synonyms of the clause as
+     *    headers, if it is cached.
+     * @returns True if the result table is cached.
+     */
+    bool find(const Clause& clause, Table& table);
+
+    /**
+     * Adds the result table of a clause, evicting the least recently used tables until it
+     * fits. Tables larger than the whole budget are not cached.
+     *
+     * @param clause Clause of interest.
+     * @param table Result table of the clause, with the synonyms of the clause as headers.
+     */
+    void add(const Clause& clause, const Table& table);
+
+    /**
+     * Removes all result tables, such as when the source they were evaluated on changes.
+     */
+    void clear();
+
+    /**
+     * Returns the number of result tables cached.
+     *
+     * @returns Number of tables.
+     */
+    size_t size() const;
+
+    /**
+     * Returns the estimated number of bytes of the result tables cached.
+     *
+     * @returns Number of bytes.
+     */
+    size_t getNumBytes() const;
+  };
+}
@@ -89,6 +89,30 @@ namespace {
     }
   }
 
+  /**
+   * Gets the rows of a relation between stmts needed to evaluate a clause of it. The
+   * relation may be computed on demand, so when a stmt is fixed, only its rows are computed:
+   * searching forwards from a fixed first stmt, or backwards from a fixed second stmt.
+   *
+   * @param pkb PKB to read the relation from.
+   * @param clause Clause of the relation.
+   * @param getTable Getter of all rows of the relation.
+   * @param getTableFrom Getter of the rows with the given first stmt.
+   * @param getTableTo Getter of the rows with the given second stmt.
+   * @return Rows of the relation needed.
+   */
+  Table getStmtRelationTable(const Pkb& pkb, const Pql::Clause& clause, Table (Pkb::*getTable)() const,
+    Table (Pkb::*getTableFrom)(const int) const, Table (Pkb::*getTableTo)(const int) const) {
+    const std::vector<Pql::Entity>& params = clause.getParams();
+    if (params[0].isNumber()) {
+      return (pkb.*getTableFrom)(pkb.getIntRefFromEntity(params[0].getValue()));
+    }
+    if (params[1].isNumber()) {
+      return (pkb.*getTableTo)(pkb.getIntRefFromEntity(params[1].getValue()));
+    }
+    return (pkb.*getTable)();
+  }
+
   /**
    * Checks if a given entity requires an attribute reference mapping from stmt number
    * to the attribute reference. (True for call.procName, read.varName and print.varName)
@@ -182,8 +206,9 @@ namespace {
 
 namespace Pql {
   // Constructor
-  PqlEvaluator::PqlEvaluator(Pkb& pkb, Query& query, std::list<std::string>& results)
-    : clauses(query.getClauses()), targets(query.getTargets()), pkb(pkb), isQueryBoolean(query.isBoolean()), results(results) {
+  PqlEvaluator::PqlEvaluator(Pkb& pkb, Query& query, std::list<std::string>& results, ClauseCache* clauseCache)
+    : clauses(query.getClauses()), targets(query.getTargets()), pkb(pkb), isQueryBoolean(query.isBoolean()), results(results),
+    clauseCache(clauseCache) {
     for (const Entity& target : targets) {
       targetSynonymsSet.emplace(target.getValue());
     }
@@ -192,8 +217,10 @@ namespace Pql {
   // Executes query and extract results
   void PqlEvaluator::evaluateQuery() {
     PqlPreprocessor preprocessor(clauses, targets);
-    ClauseGroups clauseGroups = preprocessor.generateClauseGroups();
+    evaluateQuery(preprocessor.generateClauseGroups());
+  }
 
+  void PqlEvaluator::evaluateQuery(const ClauseGroups& clauseGroups) {
     if (!executeNoSynonymClauses(clauseGroups.withoutSynonyms)) {
       extractResults(Table()); // no results
       return;
@@ -346,6 +373,10 @@ namespace Pql {
   // Returns the clause result table
   Table PqlEvaluator::executeClause(const Clause& clause) const {
     Table clauseResultTable;
+    if (clauseCache != nullptr && clauseCache->find(clause, clauseResultTable)) {
+      return clauseResultTable;
+    }
+
     const ClauseType& clauseType = clause.getType();
     switch (clauseType) {
     case ClauseType::FOLLOWS:
@@ -393,11 +424,13 @@ namespace Pql {
       constructSuchThatTableFromClause(clauseResultTable, clause);
       break;
     case ClauseType::NEXT_T:
-      clauseResultTable = pkb.getNextTTable();
+      clauseResultTable = getStmtRelationTable(pkb, clause, &Pkb::getNextTTable, &Pkb::getNextTTableFrom,
+        &Pkb::getNextTTableTo);
       constructSuchThatTableFromClause(clauseResultTable, clause);
       break;
     case ClauseType::AFFECTS:
-      clauseResultTable = pkb.getAffectsTable();
+      clauseResultTable = getStmtRelationTable(pkb, clause, &Pkb::getAffectsTable, &Pkb::getAffectsTableFrom,
+        &Pkb::getAffectsTableTo);
       constructSuchThatTableFromClause(clauseResultTable, clause);
       break;
     case ClauseType::AFFECTS_T:
@@ -409,7 +442,8 @@ namespace Pql {
       constructSuchThatTableFromClause(clauseResultTable, clause);
       break;
     case ClauseType::NEXT_BIP_T:
-      clauseResultTable = pkb.getNextBipTTable();
+      clauseResultTable = getStmtRelationTable(pkb, clause, &Pkb::getNextBipTTable, &Pkb::getNextBipTTableFrom,
+        &Pkb::getNextBipTTableTo);
       constructSuchThatTableFromClause(clauseResultTable, clause);
       break;
     case ClauseType::AFFECTS_BIP:
@@ -421,15 +455,10 @@ namespace Pql {
       constructSuchThatTableFromClause(clauseResultTable, clause);
       break;
     case ClauseType::PATTERN_ASSIGN:
-      clauseResultTable = pkb.getPatternAssignTable();
       constructPatternAssignTableFromClause(clauseResultTable, clause);
       break;
     case ClauseType::PATTERN_IF:
-      clauseResultTable = pkb.getPatternIfTable();
-      constructPatternCondTableFromClause(clauseResultTable, clause);
-      break;
     case ClauseType::PATTERN_WHILE:
-      clauseResultTable = pkb.getPatternWhileTable();
       constructPatternCondTableFromClause(clauseResultTable, clause);
       break;
     case ClauseType::WITH:
@@ -440,6 +469,9 @@ namespace Pql {
       break;
     }
 
+    if (clauseCache != nullptr) {
+      clauseCache->add(clause, clauseResultTable);
+    }
     return clauseResultTable;
   }
 
@@ -509,27 +541,27 @@ namespace Pql {
 
     if (lhsEntity.isSynonym()) { // Guaranteed to be of type VARIABLE
       header2 = lhsEntity.getValue();
-      clauseResultTable.filterColumn(1, getValuesFromEntity(lhsEntity));
-    } else if (lhsEntity.isName()) {
-      clauseResultTable.filterColumn(1, { pkb.getIntRefFromEntity(lhsEntity.getValue()) });
     }
-    // else wildcard. do not join with any tables. 
 
-    std::string postfixExpr = rhsEntity.getValue();
-    if (rhsEntity.isExpression()) {
-      clauseResultTable.filterColumn(2, { pkb.getIntRefFromEntity(postfixExpr) });
-    } else if (rhsEntity.isSubExpression()) {
-      // Manual filtering for sub expressions
-      for (const Row& row : clauseResultTable.getData()) {
-        const bool doesNotMatch = pkb.getEntityFromIntRef(row[2]).find(postfixExpr) == std::string::npos;
-        if (doesNotMatch) {
-          clauseResultTable.deleteRow(row);
-        }
+    // Expressions are compared by their nodes in the expression DAG of the Pkb, and only the
+    // rows containing the expression are looked up in the subexpression index
+    if (rhsEntity.isExpression() || rhsEntity.isSubExpression()) {
+      const int expr = pkb.getExprFromPostfixExpr(rhsEntity.getValue());
+      clauseResultTable = pkb.getPatternAssignTableWithSubExpr(expr);
+      if (rhsEntity.isExpression()) {
+        clauseResultTable.filterColumn(2, { expr });
       }
+      if (!lhsEntity.isWildcard()) {
+        clauseResultTable.filterColumn(1, getVarsFromEntity(lhsEntity));
+      }
+      clauseResultTable.dropColumn(2); // drop third column
+    } else if (!lhsEntity.isWildcard()) { // rhs is a wildcard
+      clauseResultTable = pkb.getPatternAssignLhsTableWithVars(getVarsFromEntity(lhsEntity));
+    } else { // both are wildcards
+      clauseResultTable = pkb.getPatternAssignTable();
+      clauseResultTable.dropColumn(2); // drop third column
     }
-    // else wildcard. do not join with any tables. 
 
-    clauseResultTable.dropColumn(2); // drop third column
     clauseResultTable.setHeader({ header1, header2 });
   }
 
@@ -539,16 +571,22 @@ namespace Pql {
     const Entity& synonymEntity = params[0];
     const Entity& condEntity = params[1];
 
+    const bool isIf = clause.getType() == ClauseType::PATTERN_IF;
+
     const std::string header1 = synonymEntity.getValue();
     std::string header2 = ""; // only second header can have different possible values
 
     if (condEntity.isSynonym()) { // Guaranteed to be of type VARIABLE
       header2 = condEntity.getValue();
-      clauseResultTable.filterColumn(1, getValuesFromEntity(condEntity));
-    } else if (condEntity.isName()) {
-      clauseResultTable.filterColumn(1, { pkb.getIntRefFromEntity(condEntity.getValue()) });
     }
-    // else wildcard. do not join with any tables. 
+
+    // Rows of given variables are merged from the statements the Pkb indexes by each variable
+    if (!condEntity.isWildcard()) {
+      const std::unordered_set<int> varIntRefs = getVarsFromEntity(condEntity);
+      clauseResultTable = isIf ? pkb.getPatternIfTableWithVars(varIntRefs) : pkb.getPatternWhileTableWithVars(varIntRefs);
+    } else {
+      clauseResultTable = isIf ? pkb.getPatternIfTable() : pkb.getPatternWhileTable();
+    }
 
     clauseResultTable.setHeader({ header1, header2 });
   }
@@ -679,6 +717,14 @@ namespace Pql {
     }
   }
 
+  std::unordered_set<int> PqlEvaluator::getVarsFromEntity(const Entity& varEntity) const {
+    if (varEntity.isSynonym()) { // Guaranteed to be of type VARIABLE
+      return getValuesFromEntity(varEntity);
+    }
+    assert(varEntity.isName());
+    return { pkb.getIntRefFromEntity(varEntity.getValue()) };
+  }
+
   Table PqlEvaluator::getAttrRefMappingTableFromEntity(const Entity& entity) const {
     assert(needsAttrRefMapping(entity));
     switch (entity.getType()) {
@@ -5,6 +5,8 @@
 #include <unordered_set>
 #include <unordered_map>
 
+#include "PqlClauseCache.h"
+#include "PqlPreprocessor.h"
 #include "PqlQuery.h"
 #include "Pkb.h"
 #include "Table.h"
@@ -18,6 +20,7 @@ namespace Pql {
     bool isQueryBoolean;
     Pkb& pkb;
     std::list<std::string>& results;
+    ClauseCache* clauseCache;
 
     /**
      * Executes the all given clauses indexes without synonyms and returns 
@@ -48,7 +51,8 @@ namespace Pql {
     Table executeConnectedClauses(const std::vector< std::unordered_set<int>>& clauseGroupsIdxs, const std::unordered_set<Entity>& unusedTargets) const;
 
     /**
-     * Executes a given clause and returns the clause result table.
+     * Executes a given clause and returns the clause result table, reusing the table of the same clause from the
+     * clause cache if there is one.
      *
      * @param clause Clause to be executed.
      * @return Clause result table.
@@ -105,6 +109,14 @@ namespace Pql {
      */
     std::unordered_set<int> getValuesFromEntity(const Entity& synonymEntity) const;
 
+    /**
+     * Helper function to get the variables a variable synonym or variable name can be.
+     *
+     * @param varEntity Given variable synonym or name.
+     * @return Set of integer references of the variables.
+     */
+    std::unordered_set<int> getVarsFromEntity(const Entity& varEntity) const;
+
     /**
      * Helper function to get the corresponding attribute reference mapping Table from the PKB when given an entity.
      * E.g. Entity with EntityType of STMT will return the stmtTable from PKB.
@@ -128,12 +140,21 @@ namespace Pql {
      * @param pkb PKB.
      * @param query Query representation object.
      * @param results Result list to be filled.
+     * @param clauseCache Cache of clause result tables shared with other queries on the same PKB, or nullptr.
      */
-    PqlEvaluator(Pkb& pkb, Query& query, std::list<std::string>& results);
+    PqlEvaluator(Pkb& pkb, Query& query, std::list<std::string>& results, ClauseCache* clauseCache = nullptr);
 
     /**
      * @brief Evaluates the query using the given PKB and stores the result in the results list of the PqlEvaluator.
      */
     void evaluateQuery();
+
+    /**
+     * @brief Evaluates the query in the given groups of its clauses, such as those of a cached plan, and stores
+     * the result in the results list of the PqlEvaluator.
+     *
+     * @param clauseGroups Groups of the clauses of the query, as generated by the PqlPreprocessor.
+     */
+    void evaluateQuery(const ClauseGroups& clauseGroups);
   };
 }
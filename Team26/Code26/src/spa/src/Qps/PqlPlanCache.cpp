@@ -0,0 +1,131 @@
+#include "PqlPlanCache.h"
+
+#include <assert.h>
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "PqlParser.h"
+#include "Token.h"
+
+namespace {
+  // Separates the tokens of a key, and marks renamed synonyms. Neither can appear in a token.
+  const char TOKEN_SEPARATOR = '\x1f';
+  const char SYNONYM_MARKER = '\x1e';
+
+  /**
+   * Identifiers that can have a meaning other than a synonym in a query.
+   */
+  const std::unordered_set<Token> KEYWORDS({
+      Pql::SELECT, Pql::SUCH, Pql::THAT, Pql::PATTERN, Pql::WITH, Pql::AND, Pql::BOOLEAN,
+      Pql::STMT, Pql::READ, Pql::PRINT, Pql::CALL, Pql::WHILE, Pql::IF, Pql::ASSIGN,
+      Pql::VARIABLE, Pql::CONSTANT, Pql::PROG, Pql::LINE, Pql::PROCEDURE,
+      Pql::PROC_NAME, Pql::VAR_NAME, Pql::VALUE,
+      Pql::MODIFIES, Pql::USES, Pql::PARENT, Pql::FOLLOWS, Pql::CALLS, Pql::NEXT, Pql::AFFECTS,
+      Pql::NEXT_BIP, Pql::AFFECTS_BIP
+    });
+
+  /**
+   * Numbers the synonyms declared before "Select" in the order they are first declared. A
+   * declared synonym is an identifier followed by ',' or ';'.
+   *
+   * @param tokens Tokens of the query.
+   * @returns Numbers of the synonyms, or no synonyms if any is named after a keyword or
+   *    declared twice.
+   */
+  std::unordered_map<std::string, int> numberSynonyms(const std::list<Token>& tokens) {
+    std::unordered_map<std::string, int> synonymToNumber;
+    const Token* lastIdentifier = nullptr;
+    for (const Token& token : tokens) {
+      if (token == Pql::SELECT) {
+        break;
+      }
+      if (token.type == TokenType::WHITESPACE) {
+        continue;
+      }
+      if ((token == Pql::COMMA || token == Pql::SEMICOLON) && lastIdentifier != nullptr) {
+        if (KEYWORDS.count(*lastIdentifier) == 1 ||
+          !synonymToNumber.emplace(lastIdentifier->value, (int)synonymToNumber.size()).second) {
+          return {};
+        }
+      }
+      lastIdentifier = token.type == TokenType::IDENTIFIER ? &token : nullptr;
+    }
+    return synonymToNumber;
+  }
+}
+
+namespace Pql {
+  PlanCache::PlanCache(const size_t capacity)
+    : capacity(capacity) {
+  }
+
+  std::string PlanCache::getKey(const std::list<Token>& tokens) {
+    const std::unordered_map<std::string, int> synonymToNumber = numberSynonyms(tokens);
+
+    std::string key;
+    std::string whitespace;
+    const Token* lastToken = nullptr; // Last token other than whitespace
+    bool isInQuotes = false;
+    for (const Token& token : tokens) {
+      if (token.type == TokenType::WHITESPACE) {
+        whitespace += token.value;
+        continue;
+      }
+      if (!whitespace.empty()) {
+        // "such" and "that" must be separated by exactly one space
+        key += lastToken != nullptr && *lastToken == SUCH ? whitespace : " ";
+        key += TOKEN_SEPARATOR;
+        whitespace.clear();
+      }
+
+      const std::unordered_map<std::string, int>::const_iterator synonym = synonymToNumber.find(token.value);
+      const bool isAttributeName = lastToken != nullptr && *lastToken == DOT;
+      if (token.type == TokenType::IDENTIFIER && synonym != synonymToNumber.end() && !isInQuotes && !isAttributeName) {
+        key += SYNONYM_MARKER;
+        key += std::to_string(synonym->second);
+      } else {
+        key += token.value;
+      }
+      key += TOKEN_SEPARATOR;
+
+      if (token == QUOTE) {
+        isInQuotes = !isInQuotes;
+      }
+      lastToken = &token;
+    }
+    if (!whitespace.empty()) {
+      key += " ";
+      key += TOKEN_SEPARATOR;
+    }
+    return key;
+  }
+
+  QueryPlan* PlanCache::find(const std::string& key) {
+    const std::unordered_map<std::string, PlanList::iterator>::iterator it = keyToPlan.find(key);
+    if (it == keyToPlan.end()) {
+      return nullptr;
+    }
+    plans.splice(plans.begin(), plans, it->second);
+    return &it->second->second;
+  }
+
+  void PlanCache::add(const std::string& key, const QueryPlan& plan) {
+    assert(keyToPlan.count(key) == 0);
+    if (capacity == 0) {
+      return;
+    }
+    if (plans.size() == capacity) {
+      keyToPlan.erase(plans.back().first);
+      plans.pop_back();
+    }
+    plans.emplace_front(key, plan);
+    keyToPlan.emplace(key, plans.begin());
+  }
+
+  size_t PlanCache::size() const {
+    return plans.size();
+  }
+}
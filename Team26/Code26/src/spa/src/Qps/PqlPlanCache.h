@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include "PqlPreprocessor.h"
+#include "PqlQuery.h"
+#include "Token.h"
+
+namespace Pql {
+  /**
+   * Parsed query together with the groups its clauses are evaluated in, which depend on the
+   * query alone and so can be reused for every evaluation of it.
+   */
+  struct QueryPlan {
+    Query query;
+    ClauseGroups clauseGroups;
+  };
+
+  /**
+   * Least recently used cache of the plans of queries, keyed by their normalised text so that
+   * queries differing only in whitespace or in the names of their synonyms share a plan.
+   */
+  class PlanCache {
+  private:
+    typedef std::list<std::pair<std::string, QueryPlan>> PlanList;
+
+    size_t capacity;
+
+    // Plans with their keys, most recently used first
+    PlanList plans;
+    std::unordered_map<std::string, PlanList::iterator> keyToPlan;
+
+  public:
+    /**
+     * Constructs an empty cache.
+     *
+     * @param capacity Most plans kept, 0 to keep none.
+     */
+    PlanCache(size_t capacity);
+
+    /**
+     * Builds the key of a query from its tokens, including whitespace tokens.
+     *
+     * Each run of whitespace becomes a single space, except after "such" where the parser
+     * needs exactly one. Declared synonyms are renamed after the order of their declarations,
+     * except inside quotes and in attribute names, so that queries with the same key differ
+     * only in the names of their synonyms. Synonyms are not renamed if any of them is named
+     * after a keyword, as the renamed query could then be read differently.
+     *
+     * @param tokens Tokens of the query.
+     * @returns Key of the query.
+     */
+    static std::string getKey(const std::list<Token>& tokens);
+
+    /**
+     * Finds the plan of a query and marks it most recently used.
+     *
+     * @param key Key of the query.
+     * @returns The plan, valid until the next plan is added, or nullptr if it is not cached.
+     */
+    QueryPlan* find(const std::string& key);
+
+    /**
+     * Adds the plan of a query, evicting the least recently used plan if the cache is full.
+     *
+     * @param key Key of the query, which must not be cached yet.
+     * @param plan Plan of the query.
+     */
+    void add(const std::string& key, const QueryPlan& plan);
+
+    /**
+     * Returns the number of plans cached.
+     *
+     * @returns Number of plans.
+     */
+    size_t size() const;
+  };
+}
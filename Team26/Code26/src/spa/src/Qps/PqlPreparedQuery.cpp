@@ -0,0 +1,199 @@
+#include "PqlPreparedQuery.h"
+
+#include <algorithm>
+#include <cctype>
+#include <list>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "PqlParser.h"
+#include "PqlPreprocessor.h"
+#include "PqlQuery.h"
+#include "SpaException.h"
+#include "Token.h"
+#include "Tokeniser.h"
+
+namespace {
+  /**
+   * Finds the length of the longest run of digits in a text.
+   *
+   * @param text Text of interest.
+   * @returns Length of the longest run, 0 if the text has no digits.
+   */
+  size_t getLongestDigitRun(const std::string& text) {
+    size_t longestRun = 0;
+    size_t run = 0;
+    for (const char c : text) {
+      run = std::isdigit((unsigned char)c) ? run + 1 : 0;
+      longestRun = std::max(longestRun, run);
+    }
+    return longestRun;
+  }
+
+  /**
+   * Checks if the next character other than whitespace in a direction is a quote.
+   *
+   * @param text Text of interest.
+   * @param pos Position to start looking from, moving by step.
+   * @param step 1 to look forwards, -1 to look backwards.
+   * @returns True if the next character other than whitespace is a quote.
+   */
+  bool isNextNonWhitespaceQuote(const std::string& text, int pos, const int step) {
+    while (pos >= 0 && pos < (int)text.size() && std::isspace((unsigned char)text[pos])) {
+      pos += step;
+    }
+    return pos >= 0 && pos < (int)text.size() && text[pos] == '"';
+  }
+
+  /**
+   * Checks if a value can be bound to a placeholder.
+   *
+   * @param value Value of interest.
+   * @param isName True if the placeholder stands for a name, false if for an integer.
+   * @returns True if the value is a name or an integer, as the placeholder stands for.
+   */
+  bool isValidBinding(const std::string& value, const bool isName) {
+    if (value.empty()) {
+      return false;
+    }
+    if (isName) {
+      return std::isalpha((unsigned char)value[0]) &&
+        std::all_of(value.begin(), value.end(), [](char c) { return std::isalnum((unsigned char)c) != 0; });
+    }
+    return std::all_of(value.begin(), value.end(), [](char c) { return std::isdigit((unsigned char)c) != 0; });
+  }
+
+  /**
+   * Removes the leading zeros of an integer, as the PqlParser does.
+   *
+   * @param number Integer of interest.
+   * @returns The integer without leading zeros, "0" if it is zero.
+   */
+  std::string removeLeadingZeros(const std::string& number) {
+    const size_t firstNonZero = number.find_first_not_of('0');
+    return firstNonZero == std::string::npos ? "0" : number.substr(firstNonZero);
+  }
+}
+
+namespace Pql {
+  PreparedQuery::PreparedQuery(const std::string& queryTemplate) {
+    // Each placeholder is replaced by an integer or name with a longer run of digits than any in
+    // the template, so that it cannot be mistaken for anything else in the query
+    const std::string digits(getLongestDigitRun(queryTemplate) + 1, '0');
+    std::unordered_map<std::string, Placeholder> valueToPlaceholder;
+    std::unordered_map<std::string, std::string> nameToValue;
+    std::string queryString;
+    for (size_t i = 0; i < queryTemplate.size(); i++) {
+      if (queryTemplate[i] != '$' || i + 1 == queryTemplate.size() || !std::isalpha((unsigned char)queryTemplate[i + 1])) {
+        queryString.push_back(queryTemplate[i]);
+        continue;
+      }
+
+      size_t end = i + 1;
+      while (end < queryTemplate.size() && std::isalnum((unsigned char)queryTemplate[end])) {
+        end++;
+      }
+      const std::string name = queryTemplate.substr(i + 1, end - i - 1);
+      const bool isName = isNextNonWhitespaceQuote(queryTemplate, (int)i - 1, -1) &&
+        isNextNonWhitespaceQuote(queryTemplate, (int)end, 1);
+      const std::string value = (isName ? "P" : "1") + digits + std::to_string(nameToValue.size());
+      const std::string& boundValue = nameToValue.emplace(name, value).first->second;
+      if (valueToPlaceholder.emplace(boundValue, Placeholder{ name, -1, -1, isName }).first->second.isName != isName) {
+        throw SyntaxError(ErrorMessage::SYNTAX_ERROR_INVALID_PLACEHOLDER + ErrorMessage::APPEND_PLACEHOLDER + name);
+      }
+      queryString += boundValue;
+      i = end - 1;
+    }
+
+    std::stringstream ss(queryString);
+    std::list<Token> tokens = Tokeniser()
+      .allowingLeadingZeroes()
+      .notConsumingWhitespace()
+      .tokenise(ss);
+    plan.query = PqlParser(tokens).parseQuery();
+    if (plan.query.hasSemanticError()) {
+      throw SemanticError(plan.query.getSemanticErrorMessage());
+    }
+
+    // Placeholders can only stand for whole integer or name parameters
+    std::vector<Clause> clauses = plan.query.getClauses();
+    std::unordered_map<std::string, bool> isPlaceholderUsed;
+    for (int clauseIdx = 0; clauseIdx < (int)clauses.size(); clauseIdx++) {
+      const std::vector<Entity> params = clauses[clauseIdx].getParams();
+      for (int paramIdx = 0; paramIdx < (int)params.size(); paramIdx++) {
+        const std::unordered_map<std::string, Placeholder>::const_iterator placeholder =
+          valueToPlaceholder.find(params[paramIdx].getValue());
+        if (placeholder != valueToPlaceholder.end() && (params[paramIdx].isNumber() || params[paramIdx].isName())) {
+          placeholders.push_back({ placeholder->second.name, clauseIdx, paramIdx, placeholder->second.isName });
+          isPlaceholderUsed[placeholder->second.name] = true;
+        }
+      }
+    }
+    for (const std::pair<const std::string, std::string>& nameAndValue : nameToValue) {
+      if (isPlaceholderUsed.count(nameAndValue.first) == 0) {
+        throw SyntaxError(ErrorMessage::SYNTAX_ERROR_INVALID_PLACEHOLDER + ErrorMessage::APPEND_PLACEHOLDER +
+          nameAndValue.first);
+      }
+    }
+
+    std::vector<Entity> targets = plan.query.getTargets();
+    plan.clauseGroups = PqlPreprocessor(clauses, targets).generateClauseGroups();
+  }
+
+  Query PreparedQuery::bind(const std::unordered_map<std::string, std::string>& bindings) const {
+    for (const std::pair<const std::string, std::string>& binding : bindings) {
+      const bool isPlaceholder = std::any_of(placeholders.begin(), placeholders.end(),
+        [&binding](const Placeholder& placeholder) { return placeholder.name == binding.first; });
+      if (!isPlaceholder) {
+        throw SyntaxError(ErrorMessage::SYNTAX_ERROR_UNKNOWN_PLACEHOLDER + ErrorMessage::APPEND_PLACEHOLDER +
+          binding.first);
+      }
+    }
+
+    std::vector<Clause> clauses = plan.query.getClauses();
+    for (const Placeholder& placeholder : placeholders) {
+      const std::unordered_map<std::string, std::string>::const_iterator binding = bindings.find(placeholder.name);
+      if (binding == bindings.end()) {
+        throw SyntaxError(ErrorMessage::SYNTAX_ERROR_UNBOUND_PLACEHOLDER + ErrorMessage::APPEND_PLACEHOLDER +
+          placeholder.name);
+      }
+      if (!isValidBinding(binding->second, placeholder.isName)) {
+        throw SyntaxError(ErrorMessage::SYNTAX_ERROR_INVALID_BINDING + ErrorMessage::APPEND_PLACEHOLDER +
+          placeholder.name);
+      }
+
+      Clause& clause = clauses[placeholder.clauseIdx];
+      std::vector<Entity> params = clause.getParams();
+      if (placeholder.isName) {
+        params[placeholder.paramIdx] = Entity(EntityType::NAME, binding->second);
+      } else {
+        const std::string number = removeLeadingZeros(binding->second);
+        // Integers outside with clauses are statement numbers
+        if (number == "0" && clause.getType() != ClauseType::WITH) {
+          throw SemanticError(ErrorMessage::SEMANTIC_ERROR_ZERO_STMT_NUMBER);
+        }
+        params[placeholder.paramIdx] = Entity(EntityType::NUMBER, number);
+      }
+      clause = Clause(clause.getType(), params);
+    }
+
+    Query query;
+    for (const Entity& target : plan.query.getTargets()) {
+      query.addTarget(target);
+    }
+    for (const Clause& clause : clauses) {
+      query.addClause(clause);
+    }
+    return query;
+  }
+
+  const ClauseGroups& PreparedQuery::getClauseGroups() const {
+    return plan.clauseGroups;
+  }
+
+  bool PreparedQuery::isBoolean() const {
+    return plan.query.isBoolean();
+  }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "PqlPlanCache.h"
+#include "PqlPreprocessor.h"
+#include "PqlQuery.h"
+
+namespace Pql {
+  /**
+   * Query parsed and planned once from a template with placeholders, to be evaluated many times
+   * with different values bound to them.
+   *
+   * A placeholder is written as $ followed by a name, such as $n, and stands for a statement
+   * number or an integer in a with clause, or for a name when written in quotes, such as "$v".
+   * Placeholders cannot appear in pattern expressions.
+   */
+  class PreparedQuery {
+  private:
+    struct Placeholder {
+      std::string name; // Name of the placeholder, without the $
+      int clauseIdx; // Clause containing the placeholder
+      int paramIdx; // Parameter of the clause the placeholder stands for
+      bool isName; // True if it stands for a name, false if for an integer
+    };
+
+    QueryPlan plan;
+    std::vector<Placeholder> placeholders;
+
+  public:
+    /**
+     * Parses and plans a query template.
+     *
+     * @param queryTemplate Query with placeholders.
+     * @throws TokeniserException, SyntaxError or SemanticError if the template is not a valid query,
+     *    or has a placeholder where it cannot be.
+     */
+    PreparedQuery(const std::string& queryTemplate);
+
+    /**
+     * Builds the query with the given values in place of the placeholders.
+     *
+     * @param bindings Value of each placeholder, by the name of the placeholder.
+     * @returns The query.
+     * @throws SyntaxError if a placeholder has no value, a value is not of the type of its placeholder,
+     *    or a value is given for a placeholder not in the template.
+     * @throws SemanticError if a statement number is bound to 0.
+     */
+    Query bind(const std::unordered_map<std::string, std::string>& bindings) const;
+
+    /**
+     * Returns the groups the clauses of the query are evaluated in, whatever the values bound.
+     *
+     * @returns Groups of the clauses.
+     */
+    const ClauseGroups& getClauseGroups() const;
+
+    /**
+     * Checks if the query is a BOOLEAN query.
+     *
+     * @returns True if the query is a BOOLEAN query.
+     */
+    bool isBoolean() const;
+  };
+}
@@ -6,8 +6,6 @@
 #include <string>
 #include <stack>
 
-#include "AdjList.h"
-
 namespace Pql {
   PqlPreprocessor::PqlPreprocessor(std::vector<Clause>& clauses, std::vector<Entity>& targets)
     : clauses(clauses), targets(targets) {
@@ -2,29 +2,37 @@
 
 #include <assert.h>
 
+#include <algorithm>
 #include <memory>
-#include <stack>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
-#include "AdjList.h"
+#include "AffectsBipAnalysis.h"
+#include "BitVector.h"
 #include "Cfg.h"
+#include "CondensedGraph.h"
+#include "Dataflow.h"
+#include "Graph.h"
+#include "MaterialisationPolicy.h"
 #include "Pkb.h"
+#include "PkbBuilder.h"
+#include "Profiler.h"
 #include "SpaException.h"
 #include "Table.h"
 
 namespace {
   /**
-   * Initialises the CFGBip, by adding dummy nodes to the CFG and using the graph explosion method to generate the sequence
-   * of CFGBip traversal for each procedure.
+   * Initialises the CFGBip, by adding dummy nodes to the CFG and generating the graph of each procedure.
    *
    * @param pkb The PKB to refer to.
    */
   void initialiseCfgBip(Pkb& pkb, std::list<std::string>& topoProc) {
     const std::unordered_set<int>& procIntRefs = pkb.getProcIntRefs();
+    PkbBuilder builder(pkb);
 
     // Create dummy nodes and adding edge from end statements of each proc to their respective dummy nodes
     for (const int procIntRef : procIntRefs) {
@@ -32,287 +40,357 @@ namespace {
       const int dummyNode = -1 * pkb.getStartStmtFromProc(proc);
 
       for (const int end : pkb.getEndStmtsFromProc(proc)) {
-        pkb.addCfgEdge(end, dummyNode);
+        builder.addCfgEdge(end, dummyNode);
       }
     }
 
+    builder.build();
     pkb.initialiseCfgBip(topoProc);
   }
 
   /**
-    * Fills the NextBip and NextBipT relations.
-    *
-    * @param pkb The PKB to refer to.
-    */
-  void fillNextBipTable(Pkb& pkb) {
-    // Get starting node for each proc
-    for (const std::shared_ptr<Cfg::BipNode>& startPtr : pkb.getStartBipNodes()) {
-      std::unordered_set<std::shared_ptr<Cfg::BipNode>> outerVisited;
-      std::stack<std::shared_ptr<Cfg::BipNode>> outerDfsStack;
-      outerDfsStack.push(startPtr); // push startNode to stack
-      outerVisited.emplace(startPtr); // mark startNode as visited
-
-      // Do DFS from each node
-      while (!outerDfsStack.empty()) {
-        const std::shared_ptr<Cfg::BipNode>& currPtr = outerDfsStack.top();
-        const int currStmt = currPtr->node;
-        outerDfsStack.pop();
-
-        // Only proceed with inner dfs for non dummy nodes
-        if (currStmt > 0) {
-          std::unordered_set<std::shared_ptr<Cfg::BipNode>> innerVisited;
-          std::stack<std::shared_ptr<Cfg::BipNode>> innerDfsStack;
-          for (std::shared_ptr<Cfg::BipNode>& nextPtr : currPtr->nexts) {
-            // Iterate through to find the first non-dummy node
-            while (nextPtr->node < 0) {
-              assert(nextPtr->nexts.size() <= 1);
-              if (nextPtr->nexts.empty()) {
-                break;
-              }
-              nextPtr = nextPtr->nexts[0];
-            }
-
-            // Add to nextBip relation if non-dummy node
-            if (nextPtr->node > 0) {
-              pkb.addNextBip(currStmt, nextPtr->node);
-            }
-
-            innerDfsStack.push(nextPtr); // push nextNodes to stack
-            innerVisited.emplace(nextPtr); // mark nextNodes as visited
-          }
-
-          // Do DFS
-          while (!innerDfsStack.empty()) {
-            const std::shared_ptr<Cfg::BipNode>& targetPtr = innerDfsStack.top();
-            const int targetStmt = targetPtr->node;
-            innerDfsStack.pop();
+   * Fills the NextBip and NextBipT relations from the graph of each procedure in the CFGBip.
+   *
+   * NextBip*(s, _) is computed from a summary of each procedure over the condensation of its
+   * graph (see Cfg::BipReachability), either for all statements at once or, in on-demand
+   * mode, only for the statements queried.
+   *
+   * Pre-conditions:
+   *   1) Requires that the CFGBip is initialised.
+   *
+   * @param pkb The PKB to refer to.
+   * @param isNextBipTOnDemand Whether to compute NextBip* only when queried.
+   */
+  void fillNextBipTable(Pkb& pkb, const bool isNextBipTOnDemand) {
+    const Cfg::CfgBip& cfgBip = pkb.getCfgBip();
+    const std::vector<Cfg::ProcedureBip>& procs = cfgBip.getProcedureBips();
+    const size_t numProcs = procs.size();
+    PkbBuilder builder(pkb);
+
+    // Return sites of each procedure over all of its call sites, callers first.
+    // A call that ends its procedure returns wherever that procedure returns.
+    std::vector<std::vector<int>> returnSites(numProcs);
+    for (size_t p = 0; p < numProcs; p++) {
+      for (const Cfg::BipIndex caller : procs[p].callers) {
+        const Cfg::BipNode& returnSite = cfgBip.getNode(cfgBip.getNexts(caller)[0]);
+        if (returnSite.node > 0) {
+          returnSites[p].push_back(returnSite.node);
+        } else {
+          const std::vector<int>& callerReturnSites = returnSites[returnSite.proc];
+          returnSites[p].insert(returnSites[p].end(), callerReturnSites.begin(), callerReturnSites.end());
+        }
+      }
+    }
 
-            if (targetStmt > 0) {
-              pkb.addNextBipT(currStmt, targetStmt);
-            }
+    for (size_t p = 0; p < numProcs; p++) {
+      for (Cfg::BipIndex index = procs[p].firstNode; index < procs[p].firstNode + procs[p].numNodes; index++) {
+        const Cfg::BipNode& node = cfgBip.getNode(index);
+        if (node.node < 0) {
+          continue;
+        }
 
-            // Add nextNodes to the stack under certain conditions
-            for (const std::shared_ptr<Cfg::BipNode>& nextPtr : targetPtr->nexts) {
-              // Add nextNode to stack only if not visited
-              if (innerVisited.count(nextPtr) == 0) {
-                innerDfsStack.push(nextPtr);
-                innerVisited.emplace(nextPtr); // mark nextNode as visited
-              }
-            }
-          }
+        if (node.calledProc != -1) {
+          builder.addNextBip(node.node, cfgBip.getNode(procs[node.calledProc].start).node);
+          continue;
         }
 
-        // Add nextNodes to the stack under certain conditions
-        for (const std::shared_ptr<Cfg::BipNode>& nextPtr : currPtr->nexts) {
-          // Add nextNode to stack only if not visited
-          if (outerVisited.count(nextPtr) == 0) {
-            outerDfsStack.push(nextPtr);
-            outerVisited.emplace(nextPtr); // mark nextNode as visited
+        for (const Cfg::BipIndex next : cfgBip.getNexts(index)) {
+          const int nextStmt = cfgBip.getNode(next).node;
+          if (nextStmt > 0) {
+            builder.addNextBip(node.node, nextStmt);
+          } else {
+            for (const int returnSite : returnSites[p]) {
+              builder.addNextBip(node.node, returnSite);
+            }
           }
         }
       }
     }
+
+    pkb.initialiseNextBipReachability(isNextBipTOnDemand);
+    if (!isNextBipTOnDemand) {
+      pkb.getNextBipReachability().forEachReachable([&builder](int prev, int next) {
+        builder.addNextBipT(prev, next);
+      });
+    }
+    builder.build();
   }
 
   /**
-  * Fills the AffectsBip and AffectsBipT relations.
-  *
-  * @param pkb The PKB to refer to.
-  */
-  void fillAffectsBipTable(Pkb& pkb) {
-    std::unordered_set<std::shared_ptr<Cfg::BipNode>> affectsBipPtrs;
-    std::unordered_set<std::string> visitedProcs;
-    const Table& assignTable = pkb.getAssignTable();
-    const Table& callTable = pkb.getCallTable();
-    const Table& readTable = pkb.getReadTable();
-
-    // Generate AffectsBip graph and create edges for AffectsBipT
-    for (const std::shared_ptr<Cfg::BipNode>& startPtr : pkb.getStartBipNodes()) {
-
-      std::unordered_set<std::shared_ptr<Cfg::BipNode>> outerVisited;
-      std::stack<std::shared_ptr<Cfg::BipNode>> outerDfsStack;
-      outerDfsStack.push(startPtr); // push startNode to stack
-      outerVisited.emplace(startPtr); // mark startNode as visited
-
-      // Do DFS from each node
-      while (!outerDfsStack.empty()) {
-        const std::shared_ptr<Cfg::BipNode>& currPtr = outerDfsStack.top();
-        const int currStmt = currPtr->node;
-        outerDfsStack.pop();
-
-        // Only proceed with inner dfs for assign statements
-        if (assignTable.contains({ pkb.getIntRefFromStmtNum(currStmt) })) {
-          std::unordered_set<std::shared_ptr<Cfg::BipNode>> innerVisited;
-          std::stack<std::shared_ptr<Cfg::BipNode>> innerDfsStack;
-
-          // Extract the varModifed by currTargetAssign
-          std::string varModified;
-          for (const std::string& variable : pkb.getModifiedBy(currStmt)) {
-            varModified = variable;
-          }
+   * Computes the AffectsBip or AffectsBipT relation over the CFGBip (see Cfg::AffectsBipAnalysis).
+   *
+   * Pre-conditions:
+   *   1) Requires that all Modifies relations are filled in.
+   *   2) Requires that all Uses relations are filled in.
+   *   3) Requires that the CFGBip is initialised.
+   *
+   * @param pkb The PKB to refer to.
+   * @param isTransitive Whether to compute AffectsBipT instead of AffectsBip.
+   * @returns The pairs of statement numbers satisfying the relation.
+   */
+  std::vector<std::pair<int, int>> computeAffectsBip(const Pkb& pkb, const bool isTransitive) {
+    // Variables modified by assign and read stmts, and used by assign stmts
+    const std::unordered_set<int>& assignIntRefs = pkb.getAssignIntRefs();
+    const std::unordered_set<int>& readIntRefs = pkb.getReadIntRefs();
+    std::unordered_map<int, int> assignToVarModified;
+    std::unordered_map<int, int> readToVarModified;
+    for (const Row& row : pkb.getModifiesSTable().getData()) {
+      if (assignIntRefs.count(row[0]) == 1) {
+        assignToVarModified.emplace(pkb.getStmtNumFromIntRef(row[0]), row[1]);
+      } else if (readIntRefs.count(row[0]) == 1) {
+        readToVarModified.emplace(pkb.getStmtNumFromIntRef(row[0]), row[1]);
+      }
+    }
+    std::unordered_map<int, std::vector<int>> assignToVarsUsed;
+    for (const Row& row : pkb.getUsesSTable().getData()) {
+      if (assignIntRefs.count(row[0]) == 1) {
+        assignToVarsUsed[pkb.getStmtNumFromIntRef(row[0])].push_back(row[1]);
+      }
+    }
 
-          // Extract the assign statements that uses varModified
-          const std::unordered_set<int>& potentiallyAffectedAssigns = pkb.getAssignUses(varModified);
-          if (potentiallyAffectedAssigns.empty()) {
-            for (const std::shared_ptr<Cfg::BipNode>& nextPtr : currPtr->nexts) {
-              // Add nextNode to stack only if not visited
-              if (outerVisited.count(nextPtr) == 0) {
-                outerDfsStack.push(nextPtr);
-                outerVisited.emplace(nextPtr); // mark nextNode as visited
-              }
-            }
-            continue;  // shortcircuit if no assign uses the varModified
-          }
+    return Cfg::AffectsBipAnalysis(pkb.getCfg(), assignToVarModified, readToVarModified, assignToVarsUsed,
+      isTransitive).getRelation();
+  }
 
-          for (std::shared_ptr<Cfg::BipNode>& nextPtr : currPtr->nexts) {
-            // Iterate through to find the first non-dummy node
-            innerDfsStack.push(nextPtr); // push nextNodes to stack
-            innerVisited.emplace(nextPtr); // mark nextNodes as visited
-          }
-          assert(currPtr->nexts.size() <= 1);
-
-          // Do DFS
-          while (!innerDfsStack.empty()) {
-            const std::shared_ptr<Cfg::BipNode>& targetPtr = innerDfsStack.top();
-            const int targetStmt = targetPtr->node;
-            innerDfsStack.pop();
-
-            // Check if currentStmt satisfy the AffectsBip(currStmt, targetStmt) relation
-            if (potentiallyAffectedAssigns.count(targetStmt) == 1) {
-              pkb.addAffectsBip(currStmt, targetStmt);
-              currPtr->affectsNexts.push_back(targetPtr);
-              affectsBipPtrs.emplace(currPtr);
-            }
+  /**
+   * Fills the AffectsBip relation.
+   *
+   * @param pkb The PKB to refer to.
+   */
+  void fillAffectsBipTable(Pkb& pkb) {
+    PkbBuilder builder(pkb);
+    for (const std::pair<int, int>& affects : computeAffectsBip(pkb, false)) {
+      builder.addAffectsBip(affects.first, affects.second);
+    }
+    builder.build();
+  }
 
-            // Check if targetStmt modifies the varModified
-            const bool isModified = pkb.getModifiedBy(targetStmt).count(varModified) == 1;
-            const int ref = pkb.getIntRefFromStmtNum(targetStmt);
-            const bool isReadOrAssignStmt = readTable.contains({ ref }) || assignTable.contains({ ref });
-            // Stop searching this path if the targetStmt is an assign stmt or read stmt
-            if (isModified && isReadOrAssignStmt) {
-              continue;
-            }
+  /**
+   * Fills the AffectsBipT relation.
+   *
+   * @param pkb The PKB to refer to.
+   */
+  void fillAffectsBipTTable(Pkb& pkb) {
+    PkbBuilder builder(pkb);
+    for (const std::pair<int, int>& affects : computeAffectsBip(pkb, true)) {
+      builder.addAffectsBipT(affects.first, affects.second);
+    }
+    builder.build();
+  }
 
-            // Add nextNodes to the stack under certain conditions
-            for (const std::shared_ptr<Cfg::BipNode>& nextPtr : targetPtr->nexts) {
-              // Add nextNode to stack only if not visited
-              if (innerVisited.count(nextPtr) == 0) {
-                innerDfsStack.push(nextPtr);
-                innerVisited.emplace(nextPtr); // mark nextNode as visited
-              }
-            }
-          }
-        }
+  /**
+   * Gathers the size statistics of the parsed program used to decide which derived
+   * relations to materialise.
+   *
+   * @param pkb The PKB to refer to.
+   * @returns The size statistics of the program.
+   */
+  SourceProcessor::ProgramStats computeProgramStats(const Pkb& pkb) {
+    const std::unordered_set<int>& stmtIntRefs = pkb.getStmtIntRefs();
+    const std::unordered_set<int>& assignIntRefs = pkb.getAssignIntRefs();
 
-        // Add nextNodes to the stack under certain conditions
-        for (const std::shared_ptr<Cfg::BipNode>& nextPtr : currPtr->nexts) {
-          // Add nextNode to stack only if not visited
-          if (outerVisited.count(nextPtr) == 0) {
-            outerDfsStack.push(nextPtr);
-            outerVisited.emplace(nextPtr); // mark nextNode as visited
-          }
-        }
+    std::unordered_map<std::string, size_t> procToNumStmts;
+    std::unordered_map<std::string, size_t> procToNumAssigns;
+    for (const int stmtIntRef : stmtIntRefs) {
+      const std::string& proc = pkb.getProcFromStmt(pkb.getStmtNumFromIntRef(stmtIntRef));
+      procToNumStmts[proc]++;
+      if (assignIntRefs.count(stmtIntRef) == 1) {
+        procToNumAssigns[proc]++;
       }
     }
 
-    // Adding of AffectsBipT relations
-    for (const std::shared_ptr<Cfg::BipNode>& affectsBipPtr : affectsBipPtrs) {
-      const int currAssign = affectsBipPtr->node;
-      std::stack<std::shared_ptr<Cfg::BipNode>> dfsStack;
-      std::unordered_set<std::shared_ptr<Cfg::BipNode>> visited;
-      for (std::shared_ptr<Cfg::BipNode>& nextAssignPtr : affectsBipPtr->affectsNexts) {
-        dfsStack.push(nextAssignPtr);
-        visited.emplace(nextAssignPtr);
-      }
-
-      while (!dfsStack.empty()) {
-        const std::shared_ptr<Cfg::BipNode>& assignPtr = dfsStack.top();
-        dfsStack.pop();
+    SourceProcessor::ProgramStats stats{ stmtIntRefs.size(), assignIntRefs.size(), 0, 0 };
+    for (const std::pair<const std::string, size_t>& procAndNumStmts : procToNumStmts) {
+      stats.sumSquaredProcStmts += procAndNumStmts.second * procAndNumStmts.second;
+    }
+    for (const std::pair<const std::string, size_t>& procAndNumAssigns : procToNumAssigns) {
+      stats.sumSquaredProcAssigns += procAndNumAssigns.second * procAndNumAssigns.second;
+    }
+    return stats;
+  }
 
-        pkb.addAffectsBipT(currAssign, assignPtr->node);
+  /**
+   * Groups the basic blocks of the CFG by the connected components of the block graph.
+   * CFG edges never cross procedure boundaries, so each component holds the
+   * blocks of a single procedure.
+   *
+   * Pre-conditions:
+   *   1) Requires that the CFG is frozen.
+   *
+   * @param cfg The CFG to refer to.
+   * @returns The blocks of each component, in ascending order.
+   */
+  std::vector<std::vector<int>> getCfgComponents(const Cfg::Cfg& cfg) {
+    std::vector<std::pair<int, int>> blockEdges;
+    for (size_t block = 0; block < cfg.getNumBlocks(); block++) {
+      for (const int nextBlock : cfg.getBlockNexts(block)) {
+        blockEdges.emplace_back(block, nextBlock);
+      }
+    }
 
-        for (std::shared_ptr<Cfg::BipNode>& nextAssignPtr : assignPtr->affectsNexts) {
-          if (visited.count(nextAssignPtr) == 0) {
-            dfsStack.push(nextAssignPtr);
-            visited.emplace(nextAssignPtr);
-          }
-        }
+    // Components are numbered in order of their smallest block
+    const std::vector<int>& blockToComponent = Graph(cfg.getNumBlocks(), blockEdges).getConnectedComponents();
+    std::vector<std::vector<int>> components;
+    for (size_t block = 0; block < blockToComponent.size(); block++) {
+      if ((size_t)blockToComponent[block] == components.size()) {
+        components.emplace_back();
       }
+      components[blockToComponent[block]].push_back(block);
     }
+    return components;
   }
 
   /**
    * Fills in the Affects relation based on the CFG.
    *
+   * Affects(a1, a2) holds exactly when the definition made by a1 reaches a2 and a2
+   * uses the variable it defines. The definitions reaching every basic block are
+   * computed with one reaching definitions dataflow pass per procedure, where
+   *
+   *   GEN(s)  = { s } if s is an assign stmt
+   *   KILL(s) = all assign stmts of the procedure defining a variable modified by s,
+   *             if s is not a container stmt
+   *
+   * and the GEN and KILL sets of a block compose those of its statements in order. The
+   * definitions reaching each statement are then found by walking its block.
+   *
    * Pre-conditions:
    *   1) Requires that all Modifies relations are filled in.
    *   2) Requires that all Uses relations are filled in.
    *   3) Requires that all assign stmts are filled in.
-   *   4) Requires that the CFG is built.
+   *   4) Requires that the CFG is frozen.
    *
    * @param pkb The PKB to refer to.
    */
   void fillAffectsTable(Pkb& pkb) {
+    const Cfg::Cfg& cfg = pkb.getCfg();
     const std::unordered_set<int>& assignIntRefs = pkb.getAssignIntRefs();
     const std::unordered_set<int>& ifIntRefs = pkb.getIfIntRefs();
     const std::unordered_set<int>& whileIntRefs = pkb.getWhileIntRefs();
+    PkbBuilder builder(pkb);
 
-    // Fill up the affects table for each assign statement
-    for (const int assignIntRef : assignIntRefs) {
-      const int affecterAssignStmt = pkb.getStmtNumFromIntRef(assignIntRef);
+    // Index the variables modified and used by each stmt once, instead of
+    // filtering the tables for every stmt visited
+    std::unordered_map<int, std::vector<int>> stmtToVarsModified;
+    for (const Row& row : pkb.getModifiesSTable().getData()) {
+      stmtToVarsModified[row[0]].push_back(row[1]);
+    }
+    std::unordered_map<int, std::vector<int>> stmtToVarsUsed;
+    for (const Row& row : pkb.getUsesSTable().getData()) {
+      stmtToVarsUsed[row[0]].push_back(row[1]);
+    }
 
-      // Extract the varModifed by affecterAssignStmt
-      std::string varModified;
-      for (const std::string& variable : pkb.getModifiedBy(affecterAssignStmt)) {
-        varModified = variable;
+    // Statement numbers in the CFG that are not statements of the program map to -1
+    const size_t numBlocks = cfg.getNumBlocks();
+    const int maxStmt = numBlocks == 0 ? 0 : cfg.getBlockLastStmt(numBlocks - 1);
+    std::vector<int> stmtToIntRef(maxStmt + 1, -1);
+    for (const int stmtIntRef : pkb.getStmtIntRefs()) {
+      const int stmt = pkb.getStmtNumFromIntRef(stmtIntRef);
+      if (stmt <= maxStmt) {
+        stmtToIntRef[stmt] = stmtIntRef;
       }
+    }
 
-      const std::unordered_set<int>& potentiallyAffectedAssigns = pkb.getAssignUses(varModified);
-      if (potentiallyAffectedAssigns.empty()) {
-        continue;  // shortcircuit if no assign uses the varModified
+    std::vector<int> blockToNode(numBlocks);
+    for (const std::vector<int>& component : getCfgComponents(cfg)) {
+      // Number the blocks and the definitions (assign stmts) of the procedure densely
+      std::vector<int> defToStmt;
+      std::unordered_map<int, int> stmtToDef;
+      for (size_t node = 0; node < component.size(); node++) {
+        blockToNode[component[node]] = node;
+        for (int stmt = cfg.getBlockFirstStmt(component[node]); stmt <= cfg.getBlockLastStmt(component[node]); stmt++) {
+          if (stmtToIntRef[stmt] != -1 && assignIntRefs.count(stmtToIntRef[stmt]) == 1) {
+            stmtToDef.emplace(stmt, defToStmt.size());
+            defToStmt.push_back(stmt);
+          }
+        }
       }
 
-      // =============== //
-      //  DFS algorithm  //
-      // =============== //
-      std::unordered_set<int> visited; // keep track of visited nodes
-      std::stack<int> stack; // stack for dfs
+      if (defToStmt.empty()) {
+        continue;  // shortcircuit if the procedure has no assign stmts
+      }
 
-      // Get the next stmts in the CFG from the starting affecterAssignStmt stmt and push to the stack
-      for (const int nextStmt : pkb.getNextStmtsFromCfg(affecterAssignStmt)) {
-        stack.push(nextStmt);
-        visited.emplace(nextStmt);
+      // Group the definitions by the variable they define
+      std::unordered_map<int, BitVector> varToDefs;
+      for (const std::pair<const int, int>& stmtAndDef : stmtToDef) {
+        for (const int var : stmtToVarsModified[stmtToIntRef[stmtAndDef.first]]) {
+          if (varToDefs.count(var) == 0) {
+            varToDefs.emplace(var, BitVector(defToStmt.size()));
+          }
+          varToDefs.at(var).set(stmtAndDef.second);
+        }
       }
 
-      while (!stack.empty()) {
-        int currentStmt = stack.top();
-        stack.pop();
+      // Only non-container stmts that modify a variable end the definitions of it
+      std::unordered_map<int, BitVector> stmtToKill;
+      for (const int block : component) {
+        for (int stmt = cfg.getBlockFirstStmt(block); stmt <= cfg.getBlockLastStmt(block); stmt++) {
+          const int intRef = stmtToIntRef[stmt];
+          if (intRef == -1 || ifIntRefs.count(intRef) == 1 || whileIntRefs.count(intRef) == 1) {
+            continue;
+          }
+          for (const int var : stmtToVarsModified[intRef]) {
+            if (varToDefs.count(var) == 1) {
+              stmtToKill.emplace(stmt, BitVector(defToStmt.size()));
+              stmtToKill.at(stmt).unionWith(varToDefs.at(var));
+            }
+          }
+        }
+      }
 
-        // Check if currentStmt satisfy the Affects(affecterAssignStmt, currentStmt) relation
-        if (potentiallyAffectedAssigns.count(currentStmt) == 1) {
-          pkb.addAffects(affecterAssignStmt, currentStmt); // add Affects relation to pkb
+      // Applies the GEN and KILL sets of a stmt to the definitions reaching it
+      auto transfer = [&stmtToDef, &stmtToKill](int stmt, BitVector& reaching) {
+        if (stmtToKill.count(stmt) == 1) {
+          reaching.subtract(stmtToKill.at(stmt));
         }
+        if (stmtToDef.count(stmt) == 1) {
+          reaching.set(stmtToDef.at(stmt));
+        }
+      };
 
-        // Check if currentStmt modifies the varModified
-        // Stop searching this path if the currentStmt is not a container stmt and it modifies the varModified
-        const bool isModified = pkb.getModifiedBy(currentStmt).count(varModified) == 1;
-        const bool isContainerStmt =
-          ifIntRefs.count(pkb.getIntRefFromStmtNum(currentStmt)) == 1 ||
-          whileIntRefs.count(pkb.getIntRefFromStmtNum(currentStmt)) == 1;
-        if (isModified && !isContainerStmt) {
-          continue;
+      Dataflow::BitVectorProblem reachingDefs(component.size(), defToStmt.size());
+      for (size_t node = 0; node < component.size(); node++) {
+        for (const int nextBlock : cfg.getBlockNexts(component[node])) {
+          reachingDefs.addEdge(node, blockToNode[nextBlock]);
         }
 
-        // Push all next stmts into the stack
-        for (const int nextStmt : pkb.getNextStmtsFromCfg(currentStmt)) {
-          // Add non-visited nextStmt to stack and mark as visited
-          if (visited.count(nextStmt) == 0) {
-            stack.push(nextStmt);
-            visited.emplace(nextStmt);
+        BitVector gen(defToStmt.size());
+        BitVector kill(defToStmt.size());
+        for (int stmt = cfg.getBlockFirstStmt(component[node]); stmt <= cfg.getBlockLastStmt(component[node]); stmt++) {
+          transfer(stmt, gen);
+          if (stmtToKill.count(stmt) == 1) {
+            kill.unionWith(stmtToKill.at(stmt));
+          }
+        }
+        gen.forEachSetBit([&reachingDefs, node](size_t def) {
+          reachingDefs.addGen(node, def);
+        });
+        reachingDefs.addKill(node, kill);
+      }
+
+      const Dataflow::Solution& solution = reachingDefs.solve();
+
+      // Affects(d, a) for every definition d reaching assign stmt a of a variable used by a
+      for (size_t node = 0; node < component.size(); node++) {
+        BitVector reaching = solution.in[node];
+        for (int stmt = cfg.getBlockFirstStmt(component[node]); stmt <= cfg.getBlockLastStmt(component[node]); stmt++) {
+          if (stmtToDef.count(stmt) == 1) {
+            for (const int var : stmtToVarsUsed[stmtToIntRef[stmt]]) {
+              if (varToDefs.count(var) == 0) {
+                continue;
+              }
+              BitVector affecters = reaching;
+              affecters.intersectWith(varToDefs.at(var));
+              affecters.forEachSetBit([&builder, &defToStmt, stmt](size_t def) {
+                builder.addAffects(defToStmt[def], stmt); // add Affects relation to pkb
+              });
+            }
           }
+          transfer(stmt, reaching);
         }
       }
     }
+    builder.build();
   }
 
   /**
@@ -335,119 +413,28 @@ namespace {
   void generateTransitiveClosure(Table& table, const std::list<int>& listOfEntities) {
     assert(table.getHeader().size() == 2); // Guaranteed to receive a table with 2 columns
 
-    int numEntities = listOfEntities.size();
-
     // Tables may sometimes have non-consecutive entries.
     // We use this to perform conversion to and from.
     std::unordered_map<int, int> nameToNum;
-    std::unordered_map<int, int> numToName;
-    int counter = 1;
+    std::vector<int> numToName;
     for (const int name : listOfEntities) {
-      nameToNum.emplace(name, counter);
-      numToName.emplace(counter, name);
-      counter++;
+      nameToNum.emplace(name, numToName.size());
+      numToName.push_back(name);
     }
 
-    // We insert the initial relations into the adjacency list
-    // for use in the Warshall algorithm later.
-    AdjList adjList(numEntities);
+    std::vector<std::pair<int, int>> edges;
     for (const Row& row : table.getData()) {
-      adjList.insert(nameToNum.at(row[0]), nameToNum.at(row[1]));
-    }
-
-    adjList.applyWarshallAlgorithm();
-
-    // For each true entry in the transitive
-    // closure matrix, add a new row to the 
-    // table to return.
-    for (int i = 1; i <= numEntities; i++) {
-      for (int j = 1; j <= numEntities; j++) {
-        if (adjList.get(i, j)) {
-          table.insertRow({ numToName.at(i), numToName.at(j) });
-        }
-      }
-    }
-  }
-
-  /**
-   * Populates a given table with indirect relations.
-   * We have a table with a number of direct relations.
-   * We wish to implement a new indirect relation, defined so: where
-   *
-   *   R(x, y) indicates an existing relation in the first table,
-   *   P(x, y) indicates an existing relation in the second table,
-   *
-   * If it is the case that
-   *
-   *   1) P(x, y)
-   *   2) R(y, z)
-   *
-   * Then we have a new indirect relation to be put in the
-   * first table, R(x, z).
-   *
-   * @param table Copy of the table to use/modify.
-   * @param parentTTable Copy of the parentT table to refer to.
-   * @returns The table with new indirect relation entries.
-   */
-  Table fillIndirectRelation(Table& table, Table& parentTTable) {
-    const bool areTableColumnCountTwo = (table.getHeader().size() == 2) &&
-      (parentTTable.getHeader().size() == 2);
-    assert(areTableColumnCountTwo); // Guaranteed to receive tables with 2 columns
-
-    parentTTable.innerJoin(table, 1, 0);
-    parentTTable.dropColumn(1);
-    table.concatenate(parentTTable);
-
-    return table;
-  }
-
-  /**
-   * Given the Parent() relations between statements, writes in all the
-   * transitive Parent*() relations.
-   *
-   * Pre-conditions:
-   *   1) Requires that all the Parent() relations be populated
-   *      in the PKB first.
-   *   2) Requires that pkb.getStmtTable().size() returns the total
-   *      number of statements in the PKB.
-   *
-   * @param pkb The PKB to refer to.
-   */
-  void fillParentTTable(Pkb& pkb) {
-    std::list<int> stmtList;
-    for (const Row& row : pkb.getStmtTable().getData()) {
-      stmtList.push_back(row[0]);
+      edges.emplace_back(nameToNum.at(row[0]), nameToNum.at(row[1]));
     }
 
-    Table& parentTTable = pkb.getParentTable();
-    generateTransitiveClosure(parentTTable, stmtList);
-    for (const Row& row : parentTTable.getData()) {
-      pkb.addParentT(pkb.getStmtNumFromIntRef(row[0]), pkb.getStmtNumFromIntRef(row[1]));
-    }
-  }
-
-  /**
-   * Given the Follows() relations between statements, writes in all the
-   * transitive Follows*() relations.
-   *
-   * Pre-conditions:
-   *   1) Requires that all the Follows() relations be populated
-   *      in the PKB first.
-   *   2) Requires that pkb.getStmtTable().size() returns the total
-   *      number of statements in the PKB.
-   *
-   * @param pkb The PKB to refer to.
-   */
-  void fillFollowsTTable(Pkb& pkb) {
-    std::list<int> stmtList;
-    for (const Row& row : pkb.getStmtTable().getData()) {
-      stmtList.push_back(row[0]);
-    }
-
-    Table& followsTTable = pkb.getFollowsTable();
-    generateTransitiveClosure(followsTTable, stmtList);
-    for (const Row& row : followsTTable.getData()) {
-      pkb.addFollowsT(pkb.getStmtNumFromIntRef(row[0]), pkb.getStmtNumFromIntRef(row[1]));
+    // Every entity in a component reaches the same entities, computed once per component
+    // over the condensed DAG.
+    const CondensedGraph graph(Graph(numToName.size(), edges));
+    const std::vector<BitVector>& reachable = graph.getReachableNodes();
+    for (size_t num = 0; num < numToName.size(); num++) {
+      reachable[graph.getComponent(num)].forEachSetBit([&](size_t reachedNum) {
+        table.insertRow({ numToName[num], numToName[reachedNum] });
+      });
     }
   }
 
@@ -472,34 +459,32 @@ namespace {
 
     Table& callsTTable = pkb.getCallsTable();
     generateTransitiveClosure(callsTTable, procList);
+    PkbBuilder builder(pkb);
     for (const Row& row : callsTTable.getData()) {
-      pkb.addCallsT(pkb.getEntityFromIntRef(row[0]), pkb.getEntityFromIntRef(row[1]));
+      builder.addCallsT(row[0], row[1]);
     }
+    builder.build();
   }
 
   /**
-   * Given the Next() relations between statements, writes in all the
-   * transitive Next*() relations.
+   * Fills the NextT relation from the loop nesting forest of the program, either for all
+   * statements at once or, in on-demand mode, only for the statements queried.
    *
    * Pre-conditions:
-   *   1) Requires that all the Next() relations be populated
-   *      in the PKB first.
-   *   2) Requires that pkb.getStmtTable() returns a table
-   *      containing all the statements in the program.
+   *   1) Requires that all Parent relations are filled in.
+   *   2) Requires that the CFG is frozen.
    *
    * @param pkb The PKB to refer to.
-   * @returns
+   * @param isNextTOnDemand Whether to compute Next* only when queried.
    */
-  void fillNextTTable(Pkb& pkb) {
-    std::list<int> stmtList;
-    for (const Row& row : pkb.getStmtTable().getData()) {
-      stmtList.push_back(row[0]);
-    }
-
-    Table& nextTTable = pkb.getNextTable();
-    generateTransitiveClosure(nextTTable, stmtList);
-    for (const Row& row : nextTTable.getData()) {
-      pkb.addNextT(pkb.getStmtNumFromIntRef(row[0]), pkb.getStmtNumFromIntRef(row[1]));
+  void fillNextTTable(Pkb& pkb, const bool isNextTOnDemand) {
+    pkb.initialiseLoopNestingForest(isNextTOnDemand);
+    if (!isNextTOnDemand) {
+      PkbBuilder builder(pkb);
+      pkb.getLoopNestingForest().forEachNextT([&builder](int prev, int next) {
+        builder.addNextT(prev, next);
+      });
+      builder.build();
     }
   }
 
@@ -523,197 +508,142 @@ namespace {
 
     Table& affectsTTable = pkb.getAffectsTable();
     generateTransitiveClosure(affectsTTable, assignStmtList);
+    PkbBuilder builder(pkb);
     for (const Row& row : affectsTTable.getData()) {
-      pkb.addAffectsT(pkb.getStmtNumFromIntRef(row[0]), pkb.getStmtNumFromIntRef(row[1]));
+      builder.addAffectsT(pkb.getStmtNumFromIntRef(row[0]), pkb.getStmtNumFromIntRef(row[1]));
     }
+    builder.build();
   }
 
   /**
-   * Populates the given PKB's UsesS table with all Uses(ifs/w, v) relations where
-   * the relation holds due to some Uses(s, v) for some s in the container, if the
-   * Uses(s, v) relation is recorded in the UsesS table.
+   * Propagates a relation between statements/procedures and variables (Uses or Modifies)
+   * along the call graph and the statement tree, with one bitset of variables per
+   * statement and procedure:
    *
-   * Requires that the following be populated first:
-   * 1) ParentTTable
+   *   1) R(p, v) due to Calls(p, p') && R(p', v), in reverse topological call order.
+   *   2) R(c, v) due to call stmt c calling p && R(p, v).
+   *   3) R(ifs/w, v) due to R(c, v) for some call stmt c nested in the container.
    *
-   * @param pkb The PKB to use/modify.
-   */
-  void fillUsesSTableNonCallStmts(Pkb& pkb) {
-    const Table& newUsesSTable = fillIndirectRelation(pkb.getUsesSTable(), pkb.getParentTTable());
-    for (const Row& row : newUsesSTable.getData()) {
-      pkb.addUsesS(pkb.getStmtNumFromIntRef(row[0]), pkb.getEntityFromIntRef(row[1]));
-    }
-  }
-
-  /**
-   * Populates the given PKB's UsesS table with all Uses(c, v) relations,
-   * where c is a call stmt that calls a procedure such that Uses(p, v) holds.
+   * We assume that other (sub-)components (Parser, etc.) have already extracted
+   * R(s, v) and R(p, v) for all non-call stmts s and the procedures p containing them,
+   * including R(ifs/w, v) due to non-call stmts nested in containers. Only the relations
+   * due to calls are left to the design extractor, as a callee may be defined after its
+   * caller in the source.
    *
-   * Requires that the following be populated first:
-   * 1) callProcTable in PKB
-   * 2) usesPTable in PKB
+   * Pre-conditions:
+   *   1) Requires that the Parent, Calls and callProc relations be populated.
+   *   2) Requires that the procedures be topologically sorted.
    *
    * @param pkb The PKB to use/modify.
+   * @param stmtTable Table of the relation between stmts and variables.
+   * @param procTable Table of the relation between procedures and variables.
+   * @param reverseTopoSortedProcs The list of topologically sorted procedures in reverse order.
+   * @param addStmtRelation The PkbBuilder method adding the relation between a stmt and a variable.
+   * @param addProcRelation The PkbBuilder method adding the relation between a procedure and a variable.
    */
-  void fillUsesSTableCallStmts(Pkb& pkb) {
-    Table callProcTable = pkb.getCallProcTable();
-    const Table& usesPTable = pkb.getUsesPTable();
-
-    // Inner join the callProcTable{"stmtNum","procName"}
-    // and usesPTable{"proc","var"}, so we only retain the 
-    // rows where call statements are made to procedures
-    // that have some Uses(p, v) relation in the table.
-    // We then drop the middle column to obtain a table of 
-    // {"stmtNum", "var"} of Uses(c, v) relations.
-    callProcTable.innerJoin(usesPTable, 1, 0);
-    callProcTable.dropColumn(1);
-
-    for (const Row& row : callProcTable.getData()) {
-      pkb.addUsesS(pkb.getStmtNumFromIntRef(row[0]), pkb.getEntityFromIntRef(row[1]));
+  void propagateVarRelation(Pkb& pkb,
+    const Table& stmtTable,
+    const Table& procTable,
+    const std::list<std::string>& reverseTopoSortedProcs,
+    void (PkbBuilder::*addStmtRelation)(const int, const int),
+    void (PkbBuilder::*addProcRelation)(const int, const int)) {
+    // Number the variables densely
+    std::unordered_map<int, int> varIntRefToIndex;
+    std::vector<int> indexToVarIntRef;
+    for (const Table* table : { &stmtTable, &procTable }) {
+      for (const Row& row : table->getData()) {
+        if (varIntRefToIndex.count(row[1]) == 0) {
+          varIntRefToIndex.emplace(row[1], indexToVarIntRef.size());
+          indexToVarIntRef.push_back(row[1]);
+        }
+      }
     }
-  }
+    const size_t numVars = indexToVarIntRef.size();
 
-  /**
-   * Populates the given PKB's ModifiesS table with all Modifies(c, v) relations,
-   * where c is a call stmt that calls a procedure such that Modifies(p, v) holds.
-   *
-   * Requires that the following be populated first:
-   * 1) callProcTable in PKB
-   * 2) modifiesPTable in PKB
-   *
-   * @param pkb The PKB to use/modify.
-   */
-  void fillModifiesSTableCallStmts(Pkb& pkb) {
-    Table callProcTable = pkb.getCallProcTable();
-    Table modifiesPTable = pkb.getModifiesPTable();
-
-    // Inner join the callProcTable{"stmtNum","procName"}
-    // and usesPTable{"proc","var"}, so we only retain the 
-    // rows where call statements are made to procedures
-    // that have some Uses(p, v) relation in the table.
-    // We then drop the middle column to obtain a table of 
-    // {"stmtNum", "var"} of Uses(c, v) relations.
-    callProcTable.innerJoin(modifiesPTable, 1, 0);
-    callProcTable.dropColumn(1);
-
-    for (const Row& row : callProcTable.getData()) {
-      pkb.addModifiesS(pkb.getStmtNumFromIntRef(row[0]), pkb.getEntityFromIntRef(row[1]));
+    std::unordered_map<int, BitVector> stmtToVars;
+    for (const Row& row : stmtTable.getData()) {
+      stmtToVars.emplace(row[0], BitVector(numVars)).first->second.set(varIntRefToIndex.at(row[1]));
+    }
+    std::unordered_map<int, BitVector> procToVars;
+    for (const Row& row : procTable.getData()) {
+      procToVars.emplace(row[0], BitVector(numVars)).first->second.set(varIntRefToIndex.at(row[1]));
     }
-  }
 
-  /**
-   * Populates the given PKB's ModifiesS table with all Modifies(ifs/w, v) relations where
-   * the relation holds due to some Modifies(s, v) for some s in the container, if the
-   * Modifies(s, v) relation is recorded in the ModifiesS table.
-   *
-   * Requires that the following be populated first:
-   * 1) ParentTTable
-   *
-   * @param pkb The PKB to use/modify.
-   */
-  void fillModifiesSTableNonCallStmts(Pkb& pkb) {
-    const Table& newModifiesSTable = fillIndirectRelation(pkb.getModifiesSTable(), pkb.getParentTTable());
-    for (const Row& row : newModifiesSTable.getData()) {
-      pkb.addModifiesS(pkb.getStmtNumFromIntRef(row[0]), pkb.getEntityFromIntRef(row[1]));
+    // 1) Procedures, callees first
+    std::unordered_map<int, std::vector<int>> procToCalledProcs;
+    for (const Row& row : pkb.getCallsTable().getData()) {
+      procToCalledProcs[row[0]].push_back(row[1]);
+    }
+    for (const std::string& proc : reverseTopoSortedProcs) {
+      const int procIntRef = pkb.getIntRefFromEntity(proc);
+      BitVector& vars = procToVars.emplace(procIntRef, BitVector(numVars)).first->second;
+      for (const int calledProcIntRef : procToCalledProcs[procIntRef]) {
+        if (procToVars.count(calledProcIntRef) == 1) {
+          vars.unionWith(procToVars.at(calledProcIntRef));
+        }
+      }
     }
-  }
 
-  /**
-   * Helper method to get all the procedures directly called by procName.
-   * Requires that the callsTable be populated.
-   *
-   * @param pkb The PKB to refer to.
-   * @param procName The procedure to check against.
-   */
-  std::unordered_set<std::string> getProceduresCalledBy(const Pkb& pkb, std::string procName) {
-    Table callsTable = pkb.getCallsTable();
-    std::unordered_set<std::string> toReturn;
-    toReturn.reserve(callsTable.size());
-
-    for (const Row row : callsTable.getData()) {
-      bool isProcNameCaller = (pkb.getEntityFromIntRef(row[0]) == procName);
-      if (isProcNameCaller) {
-        toReturn.insert(pkb.getEntityFromIntRef(row[1]));
+    // 2) Call stmts
+    for (const Row& row : pkb.getCallProcTable().getData()) {
+      if (procToVars.count(row[1]) == 1) {
+        stmtToVars.emplace(row[0], BitVector(numVars)).first->second.unionWith(procToVars.at(row[1]));
       }
     }
 
-    return toReturn;
+    // 3) Containers enclosing call stmts
+    std::unordered_map<int, int> childToParent;
+    for (const Row& row : pkb.getParentTable().getData()) {
+      childToParent.emplace(row[1], row[0]);
+    }
+    for (const Row& row : pkb.getCallProcTable().getData()) {
+      if (stmtToVars.count(row[0]) == 0) {
+        continue;
+      }
+      const BitVector calledVars = stmtToVars.at(row[0]);
+      for (std::unordered_map<int, int>::const_iterator parent = childToParent.find(row[0]);
+        parent != childToParent.end(); parent = childToParent.find(parent->second)) {
+        stmtToVars.emplace(parent->second, BitVector(numVars)).first->second.unionWith(calledVars);
+      }
+    }
+
+    PkbBuilder builder(pkb);
+    for (const std::pair<const int, BitVector>& stmtAndVars : stmtToVars) {
+      const int stmtNum = pkb.getStmtNumFromIntRef(stmtAndVars.first);
+      stmtAndVars.second.forEachSetBit([&](size_t var) {
+        (builder.*addStmtRelation)(stmtNum, indexToVarIntRef[var]);
+      });
+    }
+    for (const std::pair<const int, BitVector>& procAndVars : procToVars) {
+      procAndVars.second.forEachSetBit([&](size_t var) {
+        (builder.*addProcRelation)(procAndVars.first, indexToVarIntRef[var]);
+      });
+    }
+    builder.build();
   }
 
   /**
-   * Populates the UsesP table with all indirect Uses(p, v) relations between
-   * procedures p and variables v. Direct relations are when Uses(p, v) holds because
-   * there exists some statement s in p such that Uses(s, v) holds.
-   *
-   * Requires that the following be computed first:
-   * 1) All other types of Uses() relations
-   * 2) callsTable
+   * Populates the UsesS and UsesP tables with all indirect Uses relations, i.e. those due
+   * to calls and to statements nested in containers.
    *
    * @param pkb The PKB to use/modify.
-   * @param topoProc The list of topologically sorted procedures in reverse order.
+   * @param reverseTopoSortedProcs The list of topologically sorted procedures in reverse order.
    */
-  void fillUsesPTable(Pkb& pkb,
-    std::list<std::string>& reverseTopoSortedProcs) {
-    // Key idea:
-    // 1) Construct a graph where an E(p1, p2) holds if p2 calls p1
-    //    i.e. an inversion of the usual procedure call graph.
-    // 2) Get a topological ordering of this graph.
-    // 3) Compute the Uses(p, v) relations in this order.
-    //    The idea is that if p2 calls p1, then p2 depends
-    //    on p1 (we need to compute the Uses(p, v) for p1
-    //    before we compute Uses(p, v) for p2). Since we inverted
-    //    the edge directions, the topological order guarantees that
-    //    E(p1, p2) => p1 comes before p2 in the topological ordering.
-    // Same logic should work for ModifiesP as well.
-
-    // We compute the Uses(p, v) relations in topological order.
-    for (const std::string& procName : reverseTopoSortedProcs) {
-
-      // No need to compute "direct" Uses(p, v) 
-      // i.e. relations where some stmt s in p satisfies Uses(s, v)
-      // since that is done by the parser. We just add the relations from
-      // procedures that are called by our current procedure.
-
-      const std::unordered_set<std::string>& proceduresCalledByProcName = getProceduresCalledBy(pkb, procName);
-      for (const Row row : pkb.getUsesPTable().getData()) {
-        bool isFirstArgCalledByProcName = (proceduresCalledByProcName.count(pkb.getEntityFromIntRef(row[0])) > 0);
-        std::string var = pkb.getEntityFromIntRef(row[1]);
-        if (isFirstArgCalledByProcName) {
-          pkb.addUsesP(procName, var);
-        }
-      }
-    }
+  void fillUsesTables(Pkb& pkb, const std::list<std::string>& reverseTopoSortedProcs) {
+    propagateVarRelation(pkb, pkb.getUsesSTable(), pkb.getUsesPTable(), reverseTopoSortedProcs,
+      &PkbBuilder::addUsesS, &PkbBuilder::addUsesP);
   }
 
   /**
-   * Populates the ModifiesP table with all indirect Modifies(p, v) relations between
-   * procedures p and variables v. Direct relations are when Modifies(p, v) holds because
-   * there exists some statement s in p such that Modifies(s, v) holds.
-   *
-   * Requires that all other types of Modifies() relations, as well as
-   * the ParentTTable be populated first.
+   * Populates the ModifiesS and ModifiesP tables with all indirect Modifies relations, i.e.
+   * those due to calls and to statements nested in containers.
    *
    * @param pkb The PKB to use/modify.
-   * @param topoProc The list of topologically sorted procedures in reverse order.
+   * @param reverseTopoSortedProcs The list of topologically sorted procedures in reverse order.
    */
-  void fillModifiesPTable(Pkb& pkb,
-    std::list<std::string>& reverseTopoSortedProcs) {
-    // We compute the Uses(p, v) relations in reverse topological order.
-    for (const std::string& procName : reverseTopoSortedProcs) {
-      // No need to compute "direct" Uses(p, v) 
-      // i.e. relations where some stmt s in p satisfies Uses(s, v)
-      // since that is done by the parser. We just add the relations from
-      // procedures that are called by our current procedure.
-
-      std::unordered_set<std::string> proceduresCalledByProcName = getProceduresCalledBy(pkb, procName);
-      for (const Row row : pkb.getModifiesPTable().getData()) {
-        bool isFirstArgCalledByProcName = (proceduresCalledByProcName.count(pkb.getEntityFromIntRef(row[0])) > 0);
-        std::string var = pkb.getEntityFromIntRef(row[1]);
-        if (isFirstArgCalledByProcName) {
-          pkb.addModifiesP(procName, var);
-        }
-      }
-    }
+  void fillModifiesTables(Pkb& pkb, const std::list<std::string>& reverseTopoSortedProcs) {
+    propagateVarRelation(pkb, pkb.getModifiesSTable(), pkb.getModifiesPTable(), reverseTopoSortedProcs,
+      &PkbBuilder::addModifiesS, &PkbBuilder::addModifiesP);
   }
 
   /**
@@ -761,7 +691,7 @@ namespace {
     std::unordered_map<int, std::string> numToProcName;
     numToProcName.reserve(numProcs);
 
-    int counter = 1;
+    int counter = 0;
     for (const int intRef : procIntRefs) {
       std::string procName = pkb.getEntityFromIntRef(intRef);
       procNameToNum.emplace(procName, counter);
@@ -769,19 +699,20 @@ namespace {
       counter++;
     }
 
-    // Construct graphs
-    AdjList procGraph(numProcs);
-    AdjList reverseProcGraph(numProcs);
-
+    // Construct graphs, with the callees of each procedure in ascending order
+    std::vector<std::pair<int, int>> calls;
+    std::vector<std::pair<int, int>> reverseCalls;
     for (const Row row : pkb.getCallsTable().getData()) {
       std::string caller = pkb.getEntityFromIntRef(row[0]);
       std::string callee = pkb.getEntityFromIntRef(row[1]);
-      procGraph.insert(procNameToNum.at(caller), procNameToNum.at(callee));
-      reverseProcGraph.insert(procNameToNum.at(callee), procNameToNum.at(caller));
+      calls.emplace_back(procNameToNum.at(caller), procNameToNum.at(callee));
+      reverseCalls.emplace_back(procNameToNum.at(callee), procNameToNum.at(caller));
     }
+    std::sort(calls.begin(), calls.end());
+    std::sort(reverseCalls.begin(), reverseCalls.end());
 
-    const std::list<int>& topoOrder = procGraph.topologicalOrder();
-    const std::list<int>& reverseTopoOrder = reverseProcGraph.topologicalOrder();
+    const std::vector<int>& topoOrder = Graph(numProcs, calls).getTopologicalOrder();
+    const std::vector<int>& reverseTopoOrder = Graph(numProcs, reverseCalls).getTopologicalOrder();
     for (const int num : topoOrder) {
       std::string proc = numToProcName.at(num);
       topoSortedProcs.push_back(proc);
@@ -819,65 +750,97 @@ namespace {
 }
 
 namespace SourceProcessor {
-  DesignExtractor::DesignExtractor(Pkb& pkb) : pkb(pkb) {
+  DesignExtractor::DesignExtractor(Pkb& pkb, const MaterialisationPolicy& policy, Profiler* profiler)
+    : pkb(pkb), policy(policy), profiler(profiler), stats() {
+  }
+
+  template <typename Function>
+  void DesignExtractor::runStep(const std::string& name, Function step) {
+    if (profiler == nullptr) {
+      step();
+      return;
+    }
+    profiler->measure(name, pkb, step);
+  }
+
+  bool DesignExtractor::deferIfLazy(const DerivedRelation relation) {
+    if (!policy.isLazy(relation, stats)) {
+      return false;
+    }
+    deferredRelations.push_back(relation);
+    return true;
   }
 
   void DesignExtractor::extractDesignAbstractions() {
     // Verification
-    verifyNoCallsToNonExistentProcedures(pkb);
-    initialiseTopoSortedProcs(pkb, topoSortedProcs, reverseTopoSortedProcs);
-    verifyNoCyclicCalls(pkb, topoSortedProcs);
+    runStep("verifyNoCallsToNonExistentProcedures", [this]() { verifyNoCallsToNonExistentProcedures(pkb); });
+    runStep("initialiseTopoSortedProcs", [this]() {
+      initialiseTopoSortedProcs(pkb, topoSortedProcs, reverseTopoSortedProcs);
+    });
+    runStep("verifyNoCyclicCalls", [this]() { verifyNoCyclicCalls(pkb, topoSortedProcs); });
+    runStep("computeProgramStats", [this]() { stats = computeProgramStats(pkb); });
+    pkb.freezeCfg(); // Already frozen if the PKB was filled by the parser
 
     // Transitive relations
-    fillParentTTable(pkb);
-    fillFollowsTTable(pkb);
-    fillCallsTTable(pkb);
-    fillNextTTable(pkb);
-
-    // Note the specific order of method calls here;
-    // We require that `fillUsesSTableNonCallStmts` be called
-    // again at the end to extract Uses(ifs/w, v) relations due to
-    // call statements inside the container.
-    // The order of UsesS/P design abstraction extraction by DE is as follows:
-    // 
-    // 1) All Uses(ifs/w, v) due to Uses(s != c, v)
-    // 2) All Uses(p, v) due to Calls(p, p') && Uses(p', v)
-    // 3) All Uses(c, v) due to call stmt c calling p && Uses(p, v)
-    // 4) All Uses(ifs/w, v) due to Uses(c, v)
-    // 
-    // We assume that other (sub-)components (Parser, etc.) have already
-    // extracted the following:
-    // 1) All Uses(ifs/w, v) due to conditional using v
-    // 2) All Uses(p, v) due to some s != c in p satisfying Uses(s, v)
-    // 3) All Uses(a, v), Uses(pn, v)
-    fillUsesSTableNonCallStmts(pkb);
-    fillUsesPTable(pkb, reverseTopoSortedProcs);
-    fillUsesSTableCallStmts(pkb);
-    fillUsesSTableNonCallStmts(pkb);
-
-    // Same strategy as for UsesS/P.
-    // We assume that other (sub-)components (Parser, etc.) have already
-    // extracted the following:
-    // 1) All Modifies(p, v) due to some s != c in p satisfying Uses(s, v)
-    // 2) All Modifies(a, v), Modifies(r, v)
-    fillModifiesSTableNonCallStmts(pkb);
-    fillModifiesPTable(pkb, reverseTopoSortedProcs);
-    fillModifiesSTableCallStmts(pkb);
-    fillModifiesSTableNonCallStmts(pkb);
-
-    fillAffectsTable(pkb);
-    fillAffectsTTable(pkb);
+    runStep("fillCallsTTable", [this]() { fillCallsTTable(pkb); });
+    const bool isNextTOnDemand = policy.isLazy(DerivedRelation::NEXT_T, stats);
+    runStep("fillNextTTable", [this, isNextTOnDemand]() { fillNextTTable(pkb, isNextTOnDemand); });
+
+    // Uses and Modifies due to calls and containers
+    runStep("fillUsesTables", [this]() { fillUsesTables(pkb, reverseTopoSortedProcs); });
+    runStep("fillModifiesTables", [this]() { fillModifiesTables(pkb, reverseTopoSortedProcs); });
+
+    // AffectsT is derived from Affects, so Affects is only deferred along with it. Until it
+    // is extracted, Affects from or to a single stmt is searched for instead.
+    const bool isAffectsTDeferred = deferIfLazy(DerivedRelation::AFFECTS_T);
+    const bool isAffectsDeferred = isAffectsTDeferred && deferIfLazy(DerivedRelation::AFFECTS);
+    runStep("initialiseAffectsSearch", [this, isAffectsDeferred]() { pkb.initialiseAffectsSearch(isAffectsDeferred); });
+    if (!isAffectsDeferred) {
+      runStep("fillAffectsTable", [this]() { fillAffectsTable(pkb); });
+    }
+    if (!isAffectsTDeferred) {
+      runStep("fillAffectsTTable", [this]() { fillAffectsTTable(pkb); });
+    }
   }
 
   void DesignExtractor::extractIter3DesignAbstractions() {
     // Iteration 3 extensions
-    initialiseCfgBip(pkb, topoSortedProcs);
-    fillNextBipTable(pkb);
-    fillAffectsBipTable(pkb);
+    runStep("initialiseCfgBip", [this]() { initialiseCfgBip(pkb, topoSortedProcs); });
+
+    // A lazy NextBip* is answered from the summary of the CFGBip, so it is never deferred
+    const bool isNextBipTOnDemand = policy.isLazy(DerivedRelation::NEXT_BIP_T, stats);
+    runStep("fillNextBipTable", [this, isNextBipTOnDemand]() { fillNextBipTable(pkb, isNextBipTOnDemand); });
+
+    runStep("fillAffectsBipTable", [this]() { fillAffectsBipTable(pkb); });
+    if (!deferIfLazy(DerivedRelation::AFFECTS_BIP_T)) {
+      runStep("fillAffectsBipTTable", [this]() { fillAffectsBipTTable(pkb); });
+    }
   }
 
   void DesignExtractor::extractAllDesignAbstractions() {
     extractDesignAbstractions();
     extractIter3DesignAbstractions();
   }
+
+  const std::vector<DerivedRelation>& DesignExtractor::getDeferredRelations() const {
+    return deferredRelations;
+  }
+
+  void DesignExtractor::extractDeferredRelation(const DerivedRelation relation) {
+    switch (relation) {
+    case DerivedRelation::AFFECTS:
+      runStep("fillAffectsTable", [this]() { fillAffectsTable(pkb); });
+      pkb.initialiseAffectsSearch(false);
+      break;
+    case DerivedRelation::AFFECTS_T:
+      runStep("fillAffectsTTable", [this]() { fillAffectsTTable(pkb); });
+      break;
+    case DerivedRelation::AFFECTS_BIP_T:
+      runStep("fillAffectsBipTTable", [this]() { fillAffectsBipTTable(pkb); });
+      break;
+    default:
+      assert(false); // Next* and NextBip* are never deferred
+      break;
+    }
+  }
 }
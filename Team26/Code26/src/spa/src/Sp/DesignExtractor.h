@@ -2,21 +2,66 @@
 
 #include <list>
 #include <string>
+#include <vector>
 
+#include "MaterialisationPolicy.h"
 #include "Pkb.h"
+#include "Profiler.h"
 
 namespace SourceProcessor {
   class DesignExtractor {
   private:
     Pkb& pkb;
+    MaterialisationPolicy policy;
+    Profiler* profiler;
+    ProgramStats stats;
     std::list<std::string> topoSortedProcs;
     std::list<std::string> reverseTopoSortedProcs;
+    std::vector<DerivedRelation> deferredRelations;
+
+    /**
+     * Runs a step of the extraction, measuring it if a profiler is given.
+     *
+     * @param name Name of the step.
+     * @param step Function running the step.
+     */
+    template <typename Function>
+    void runStep(const std::string& name, Function step);
+
+    /**
+     * Defers the extraction of the given relation if the policy makes it lazy for this program.
+     *
+     * @param relation Relation of interest.
+     * @return True if the relation is deferred. Otherwise, false.
+     */
+    bool deferIfLazy(const DerivedRelation relation);
 
   public:
-    DesignExtractor(Pkb& pkb);
+    /**
+     * @param pkb The PKB to extract design abstractions into.
+     * @param policy Policy choosing which derived relations are extracted eagerly.
+     * @param profiler Profiler measuring each step of the extraction, or nullptr.
+     */
+    DesignExtractor(Pkb& pkb, const MaterialisationPolicy& policy = MaterialisationPolicy(),
+      Profiler* profiler = nullptr);
 
     void extractDesignAbstractions();
     void extractIter3DesignAbstractions();
     void extractAllDesignAbstractions();
+
+    /**
+     * Gets the relations left out of the extraction because the policy made them lazy.
+     *
+     * @return The deferred relations.
+     */
+    const std::vector<DerivedRelation>& getDeferredRelations() const;
+
+    /**
+     * Extracts a relation deferred by an earlier extraction into the same PKB.
+     * AffectsT requires that Affects be extracted first.
+     *
+     * @param relation The deferred relation.
+     */
+    void extractDeferredRelation(const DerivedRelation relation);
   };
-}
\ No newline at end of file
+}
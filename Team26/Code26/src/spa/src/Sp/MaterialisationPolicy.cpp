@@ -0,0 +1,54 @@
+#include "MaterialisationPolicy.h"
+
+#include <assert.h>
+
+#include <map>
+
+namespace SourceProcessor {
+  const size_t MaterialisationPolicy::DEFAULT_AUTO_ROW_LIMIT;
+
+  MaterialisationPolicy::MaterialisationPolicy(Materialisation defaultMode, size_t autoRowLimit)
+    : defaultMode(defaultMode), autoRowLimit(autoRowLimit) {
+  }
+
+  MaterialisationPolicy MaterialisationPolicy::withMode(DerivedRelation relation, Materialisation mode) const {
+    MaterialisationPolicy policy = *this;
+    policy.modes[relation] = mode;
+    return policy;
+  }
+
+  Materialisation MaterialisationPolicy::getMode(DerivedRelation relation) const {
+    return modes.count(relation) == 1 ? modes.at(relation) : defaultMode;
+  }
+
+  size_t MaterialisationPolicy::estimateRows(DerivedRelation relation, const ProgramStats& stats) {
+    switch (relation) {
+    case DerivedRelation::NEXT_T:
+      return stats.sumSquaredProcStmts;
+    case DerivedRelation::AFFECTS:
+    case DerivedRelation::AFFECTS_T:
+      return stats.sumSquaredProcAssigns;
+    case DerivedRelation::NEXT_BIP_T:
+      return stats.numStmts * stats.numStmts;
+    case DerivedRelation::AFFECTS_BIP_T:
+      return stats.numAssigns * stats.numAssigns;
+    default:
+      assert(false);
+      return 0;
+    }
+  }
+
+  bool MaterialisationPolicy::isLazy(DerivedRelation relation, const ProgramStats& stats) const {
+    switch (getMode(relation)) {
+    case Materialisation::EAGER:
+      return false;
+    case Materialisation::LAZY:
+      return true;
+    case Materialisation::AUTO:
+      return estimateRows(relation, stats) > autoRowLimit;
+    default:
+      assert(false);
+      return false;
+    }
+  }
+}
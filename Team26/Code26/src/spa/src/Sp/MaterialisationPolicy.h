@@ -0,0 +1,98 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <map>
+
+namespace SourceProcessor {
+  enum class Materialisation {
+    EAGER, // Stored in the PKB during design extraction
+    LAZY, // Computed only once a query needs it
+    AUTO // Eager or lazy, depending on the size of the program
+  };
+
+  // Relations that are expensive to derive, and so can be materialised lazily.
+  enum class DerivedRelation {
+    NEXT_T,
+    AFFECTS,
+    AFFECTS_T,
+    NEXT_BIP_T,
+    AFFECTS_BIP_T
+  };
+
+  // Size statistics of a parsed program, from which the size of derived relations is estimated.
+  struct ProgramStats {
+    size_t numStmts;
+    size_t numAssigns;
+
+    // Sums over all procedures of the square of the number of statements/assign statements
+    // in the procedure, bounding intraprocedural relations between them.
+    size_t sumSquaredProcStmts;
+    size_t sumSquaredProcAssigns;
+  };
+
+  /**
+   * Chooses, per derived relation, whether design extraction stores it in the PKB (eager) or
+   * leaves it to be computed when a query first needs it (lazy). Eager relations cost load
+   * time; lazy relations cost the latency of the first query using them.
+   *
+   * Next* and NextBip* are never stored when lazy. They are answered from the loop nesting
+   * forest and a summary of the CFGBip respectively, only for the statements queried.
+   */
+  class MaterialisationPolicy {
+  private:
+    Materialisation defaultMode;
+    std::map<DerivedRelation, Materialisation> modes;
+
+    // In automatic mode, a relation is lazy when its estimated number of rows exceeds this.
+    size_t autoRowLimit;
+
+  public:
+    static const size_t DEFAULT_AUTO_ROW_LIMIT = 1000000;
+
+    /**
+     * Constructs a policy applying the same mode to every relation.
+     *
+     * @param defaultMode Mode of every relation not given its own mode.
+     * @param autoRowLimit Estimated number of rows above which an automatic relation is lazy.
+     */
+    MaterialisationPolicy(Materialisation defaultMode = Materialisation::EAGER,
+      size_t autoRowLimit = DEFAULT_AUTO_ROW_LIMIT);
+
+    /**
+     * Returns a copy of this policy with the given mode for the given relation.
+     *
+     * @param relation Relation of interest.
+     * @param mode Mode of the relation.
+     * @returns The new policy.
+     */
+    MaterialisationPolicy withMode(DerivedRelation relation, Materialisation mode) const;
+
+    /**
+     * Returns the mode of the given relation.
+     *
+     * @param relation Relation of interest.
+     * @returns The mode of the relation.
+     */
+    Materialisation getMode(DerivedRelation relation) const;
+
+    /**
+     * Estimates an upper bound on the number of rows of the given relation.
+     *
+     * @param relation Relation of interest.
+     * @param stats Size statistics of the program.
+     * @returns The estimated number of rows.
+     */
+    static size_t estimateRows(DerivedRelation relation, const ProgramStats& stats);
+
+    /**
+     * Decides if the given relation is lazy for a program, resolving the automatic mode
+     * from the size statistics of the program.
+     *
+     * @param relation Relation of interest.
+     * @param stats Size statistics of the program.
+     * @returns `true` if the relation is lazy, `false` if it is eager.
+     */
+    bool isLazy(DerivedRelation relation, const ProgramStats& stats) const;
+  };
+}
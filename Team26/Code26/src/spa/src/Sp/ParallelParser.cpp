@@ -0,0 +1,116 @@
+#include "ParallelParser.h"
+
+#include <assert.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "Pkb.h"
+#include "PkbBuilder.h"
+#include "PkbFragment.h"
+#include "SimpleParser.h"
+#include "Span.h"
+#include "TokenCursor.h"
+#include "Tokeniser.h"
+
+namespace {
+  // Chunks aimed for per thread, so that the work stays balanced when procedures differ in size
+  const size_t CHUNKS_PER_THREAD = 4;
+}
+
+namespace SourceProcessor {
+  ParallelParser::ParallelParser(Pkb& pkb, const Span<char>& text, const Tokeniser& tokeniser,
+    size_t numThreads, size_t minChunkSize)
+    : pkb(pkb), text(text), tokeniser(tokeniser), numThreads(numThreads),
+    minChunkSize(minChunkSize) {
+    if (this->numThreads == 0) {
+      this->numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+  }
+
+  std::vector<Span<char>> ParallelParser::splitIntoChunks() const {
+    const size_t chunkSize = std::max(minChunkSize, text.size() / (numThreads * CHUNKS_PER_THREAD));
+    std::vector<Span<char>> chunks;
+    const char* chunkStart = text.begin();
+    int depth = 0;
+
+    for (const char* c = text.begin(); c != text.end(); c++) {
+      if (*c == '{') {
+        depth++;
+      } else if (*c == '}') {
+        depth--;
+        if (depth < 0) {
+          return { text };
+        }
+        if (depth == 0 && (size_t)(c + 1 - chunkStart) >= chunkSize) {
+          chunks.emplace_back(chunkStart, c + 1);
+          chunkStart = c + 1;
+        }
+      }
+    }
+    chunks.emplace_back(chunkStart, text.end());
+    return chunks;
+  }
+
+  void ParallelParser::parseSequentially() {
+    SimpleParser(pkb, TokenCursor(text, tokeniser)).parse();
+  }
+
+  void ParallelParser::parse() {
+    const std::vector<Span<char>> chunks = splitIntoChunks();
+    if (chunks.size() == 1 || numThreads == 1) {
+      parseSequentially();
+      return;
+    }
+
+    std::vector<PkbFragment> fragments(chunks.size());
+    std::vector<char> isParsed(chunks.size(), false); // not vector<bool>, written concurrently
+    std::atomic<size_t> nextChunk(0);
+    const auto parseChunks = [&]() {
+      for (size_t chunk = nextChunk++; chunk < chunks.size(); chunk = nextChunk++) {
+        try {
+          fragments[chunk] = SimpleParser(TokenCursor(chunks[chunk], tokeniser)).parseFragment();
+          isParsed[chunk] = true;
+        } catch (...) {
+          // The program is parsed again to report its first error
+        }
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < std::min(numThreads, chunks.size()); i++) {
+      threads.emplace_back(parseChunks);
+    }
+    parseChunks();
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+
+    std::unordered_set<std::string> procs;
+    for (size_t chunk = 0; chunk < chunks.size(); chunk++) {
+      if (!isParsed[chunk]) {
+        parseSequentially();
+        return;
+      }
+      for (const std::string& proc : fragments[chunk].getProcs()) {
+        if (!procs.insert(proc).second) {
+          parseSequentially();
+          return;
+        }
+      }
+    }
+
+    PkbBuilder builder(pkb);
+    int stmtOffset = 0;
+    for (const PkbFragment& fragment : fragments) {
+      fragment.mergeInto(builder, stmtOffset);
+      stmtOffset += fragment.getNumStmts();
+    }
+    builder.build();
+    pkb.freezeCfg();
+  }
+}
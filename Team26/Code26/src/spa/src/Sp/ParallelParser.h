@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "Pkb.h"
+#include "Span.h"
+#include "Tokeniser.h"
+
+namespace SourceProcessor {
+  /**
+   * Parses a SIMPLE program on several threads. The source text is split between procedures
+   * into chunks of about the same size, which are parsed into PkbFragments concurrently and
+   * then merged into the Pkb in program order. The Pkb is the same as if a single
+   * SimpleParser had parsed the program.
+   *
+   * A program with an error is parsed again by a single SimpleParser, so that the error
+   * reported is the first one in the program.
+   */
+  class ParallelParser {
+  private:
+    Pkb& pkb;
+    Span<char> text;
+    Tokeniser tokeniser;
+    size_t numThreads;
+    size_t minChunkSize;
+
+    /**
+     * Splits the text after procedures into chunks of at least minChunkSize characters,
+     * aiming for a few chunks per thread so that threads finishing early can take more.
+     * Procedures are found by counting braces, which SIMPLE only has as delimiters.
+     *
+     * @returns Chunks covering the whole text, in order. A single chunk if the braces are
+     *     unbalanced.
+     */
+    std::vector<Span<char>> splitIntoChunks() const;
+
+    /**
+     * Parses the whole text with a single SimpleParser.
+     */
+    void parseSequentially();
+
+  public:
+    // Programs shorter than this are parsed on a single thread
+    static const size_t DEFAULT_MIN_CHUNK_SIZE = 64 * 1024;
+
+    /**
+     * Constructs a parser for a source text.
+     *
+     * @param pkb The Pkb to fill in.
+     * @param text The text of the program, which must outlive the parser.
+     * @param tokeniser The tokeniser to tokenise the text with.
+     * @param numThreads Number of threads to parse on, 0 for one per hardware thread.
+     * @param minChunkSize Smallest number of characters worth parsing on a thread of its own.
+     */
+    ParallelParser(Pkb& pkb, const Span<char>& text, const Tokeniser& tokeniser,
+      size_t numThreads = 0, size_t minChunkSize = DEFAULT_MIN_CHUNK_SIZE);
+
+    /**
+     * Parses the program into the Pkb and freezes its CFG. Throws the first error in the
+     * program, like SimpleParser::parse().
+     */
+    void parse();
+  };
+}
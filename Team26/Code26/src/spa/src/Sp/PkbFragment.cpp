@@ -0,0 +1,276 @@
+#include "PkbFragment.h"
+
+#include <assert.h>
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ExprDag.h"
+#include "PkbBuilder.h"
+
+namespace SourceProcessor {
+  int PkbFragment::intern(const std::string& name) {
+    const auto inserted = nameToId.emplace(name, (int)names.size());
+    if (inserted.second) {
+      names.push_back(name);
+    }
+    return inserted.first->second;
+  }
+
+  void PkbFragment::addStmtFact(FactType type, const int stmtNum) {
+    facts.push_back({ type, stmtNum, 0, 0 });
+    numStmts = std::max(numStmts, stmtNum);
+  }
+
+  void PkbFragment::addCfgEdge(const int from, const int to) {
+    assert(from > 0 && to > 0);
+    facts.push_back({ FactType::CFG_EDGE, from, to, 0 });
+  }
+
+  void PkbFragment::addVar(const std::string& var) {
+    facts.push_back({ FactType::VAR, intern(var), 0, 0 });
+  }
+
+  void PkbFragment::addConst(const std::string& constant) {
+    facts.push_back({ FactType::CONST, intern(constant), 0, 0 });
+  }
+
+  void PkbFragment::addIf(const int stmtNum) {
+    addStmtFact(FactType::IF, stmtNum);
+  }
+
+  void PkbFragment::addWhile(const int stmtNum) {
+    addStmtFact(FactType::WHILE, stmtNum);
+  }
+
+  void PkbFragment::addRead(const int stmtNum) {
+    addStmtFact(FactType::READ, stmtNum);
+  }
+
+  void PkbFragment::addPrint(const int stmtNum) {
+    addStmtFact(FactType::PRINT, stmtNum);
+  }
+
+  void PkbFragment::addAssign(const int stmtNum) {
+    addStmtFact(FactType::ASSIGN, stmtNum);
+  }
+
+  void PkbFragment::addCall(const int stmtNum) {
+    addStmtFact(FactType::CALL, stmtNum);
+  }
+
+  void PkbFragment::addFollows(const int followed, const int follower) {
+    facts.push_back({ FactType::FOLLOWS, followed, follower, 0 });
+  }
+
+  void PkbFragment::addFollowsT(const int followed, const int follower) {
+    facts.push_back({ FactType::FOLLOWS_T, followed, follower, 0 });
+  }
+
+  void PkbFragment::addParent(const int parent, const int child) {
+    facts.push_back({ FactType::PARENT, parent, child, 0 });
+  }
+
+  void PkbFragment::addUsesS(const int stmtNum, const std::string& var) {
+    facts.push_back({ FactType::USES_S, stmtNum, intern(var), 0 });
+  }
+
+  void PkbFragment::addUsesP(const std::string& proc, const std::string& var) {
+    facts.push_back({ FactType::USES_P, intern(proc), intern(var), 0 });
+  }
+
+  void PkbFragment::addModifiesS(const int stmtNum, const std::string& var) {
+    facts.push_back({ FactType::MODIFIES_S, stmtNum, intern(var), 0 });
+  }
+
+  void PkbFragment::addModifiesP(const std::string& proc, const std::string& var) {
+    facts.push_back({ FactType::MODIFIES_P, intern(proc), intern(var), 0 });
+  }
+
+  void PkbFragment::addCalls(const std::string& caller, const std::string& called) {
+    facts.push_back({ FactType::CALLS, intern(caller), intern(called), 0 });
+  }
+
+  void PkbFragment::addPatternAssign(const int stmtNum, const std::string& lhs,
+    const std::string& rhs) {
+    const int lhsId = intern(lhs);
+    const int rhsExpr = exprs.addPostfixExpr(rhs, [this](const std::string& name) { return intern(name); });
+    facts.push_back({ FactType::PATTERN_ASSIGN, stmtNum, lhsId, rhsExpr });
+  }
+
+  void PkbFragment::addPatternIf(const int stmtNum, const std::string& var) {
+    facts.push_back({ FactType::PATTERN_IF, stmtNum, intern(var), 0 });
+  }
+
+  void PkbFragment::addPatternWhile(const int stmtNum, const std::string& var) {
+    facts.push_back({ FactType::PATTERN_WHILE, stmtNum, intern(var), 0 });
+  }
+
+  void PkbFragment::addCallProc(const int stmtNum, const std::string& proc) {
+    facts.push_back({ FactType::CALL_PROC, stmtNum, intern(proc), 0 });
+  }
+
+  void PkbFragment::addReadVar(const int stmtNum, const std::string& var) {
+    facts.push_back({ FactType::READ_VAR, stmtNum, intern(var), 0 });
+  }
+
+  void PkbFragment::addPrintVar(const int stmtNum, const std::string& var) {
+    facts.push_back({ FactType::PRINT_VAR, stmtNum, intern(var), 0 });
+  }
+
+  void PkbFragment::addProc(const std::string& proc) {
+    facts.push_back({ FactType::PROC, intern(proc), 0, 0 });
+  }
+
+  void PkbFragment::addProcStartEnd(const std::string& proc, const int start,
+    const std::vector<int>& end) {
+    facts.push_back({ FactType::PROC_START_END, intern(proc), start, (int)procEnds.size() });
+    procEnds.push_back(end);
+  }
+
+  void PkbFragment::addProcRange(const std::string& proc, const int first, const int last) {
+    facts.push_back({ FactType::PROC_RANGE, intern(proc), first, last });
+  }
+
+  int PkbFragment::getNumStmts() const {
+    return numStmts;
+  }
+
+  std::vector<std::string> PkbFragment::getProcs() const {
+    std::vector<std::string> procs;
+    for (const Fact& fact : facts) {
+      if (fact.type == FactType::PROC) {
+        procs.push_back(names[fact.first]);
+      }
+    }
+    return procs;
+  }
+
+  void PkbFragment::mergeInto(PkbBuilder& builder, const int stmtOffset) const {
+    // Names are resolved when first used, so that entities are numbered in the order the
+    // facts were recorded however the program was split into fragments
+    std::vector<int> nameToIntRef(names.size(), -1);
+    auto resolve = [this, &builder, &nameToIntRef](int id) {
+      if (nameToIntRef[id] == -1) {
+        nameToIntRef[id] = builder.addEntity(names[id]);
+      }
+      return nameToIntRef[id];
+    };
+
+    // Likewise for expressions. Operands are numbered before the nodes using them, so adding
+    // the nodes in order up to an expression adds all of its subexpressions first.
+    std::vector<int> exprToNode(exprs.getNumNodes(), -1);
+    int numExprsAdded = 0;
+    auto addExpr = [this, &builder, &resolve, &exprToNode, &numExprsAdded](int expr) {
+      for (; numExprsAdded <= expr; numExprsAdded++) {
+        const ExprDag::Node& node = exprs.getNode(numExprsAdded);
+        exprToNode[numExprsAdded] = node.op == ExprDag::LEAF
+          ? builder.addExprLeaf(resolve(node.left))
+          : builder.addExprOperator(node.op, exprToNode[node.left], exprToNode[node.right]);
+      }
+      return exprToNode[expr];
+    };
+
+    std::vector<int> stmtToParent(numStmts + 1, 0);
+    for (const Fact& fact : facts) {
+      if (fact.type == FactType::PARENT) {
+        stmtToParent[fact.second] = fact.first;
+      }
+    }
+
+    for (const Fact& fact : facts) {
+      switch (fact.type) {
+      case FactType::CFG_EDGE:
+        builder.addCfgEdge(fact.first + stmtOffset, fact.second + stmtOffset);
+        break;
+      case FactType::VAR:
+        builder.addVar(resolve(fact.first));
+        break;
+      case FactType::CONST:
+        builder.addConst(resolve(fact.first));
+        break;
+      case FactType::IF:
+        builder.addIf(fact.first + stmtOffset);
+        break;
+      case FactType::WHILE:
+        builder.addWhile(fact.first + stmtOffset);
+        break;
+      case FactType::READ:
+        builder.addRead(fact.first + stmtOffset);
+        break;
+      case FactType::PRINT:
+        builder.addPrint(fact.first + stmtOffset);
+        break;
+      case FactType::ASSIGN:
+        builder.addAssign(fact.first + stmtOffset);
+        break;
+      case FactType::CALL:
+        builder.addCall(fact.first + stmtOffset);
+        break;
+      case FactType::FOLLOWS:
+        builder.addFollows(fact.first + stmtOffset, fact.second + stmtOffset);
+        break;
+      case FactType::FOLLOWS_T:
+        builder.addFollowsT(fact.first + stmtOffset, fact.second + stmtOffset);
+        break;
+      case FactType::PARENT:
+        builder.addParent(fact.first + stmtOffset, fact.second + stmtOffset);
+        for (int parent = fact.first; parent != 0; parent = stmtToParent[parent]) {
+          builder.addParentT(parent + stmtOffset, fact.second + stmtOffset);
+        }
+        break;
+      case FactType::USES_S:
+        builder.addUsesS(fact.first + stmtOffset, resolve(fact.second));
+        break;
+      case FactType::USES_P:
+        builder.addUsesP(resolve(fact.first), resolve(fact.second));
+        break;
+      case FactType::MODIFIES_S:
+        builder.addModifiesS(fact.first + stmtOffset, resolve(fact.second));
+        break;
+      case FactType::MODIFIES_P:
+        builder.addModifiesP(resolve(fact.first), resolve(fact.second));
+        break;
+      case FactType::CALLS:
+        builder.addCalls(resolve(fact.first), resolve(fact.second));
+        break;
+      case FactType::PATTERN_ASSIGN:
+        builder.addPatternAssign(fact.first + stmtOffset, resolve(fact.second), addExpr(fact.third));
+        break;
+      case FactType::PATTERN_IF:
+        builder.addPatternIf(fact.first + stmtOffset, resolve(fact.second));
+        break;
+      case FactType::PATTERN_WHILE:
+        builder.addPatternWhile(fact.first + stmtOffset, resolve(fact.second));
+        break;
+      case FactType::CALL_PROC:
+        builder.addCallProc(fact.first + stmtOffset, resolve(fact.second));
+        break;
+      case FactType::READ_VAR:
+        builder.addReadVar(fact.first + stmtOffset, resolve(fact.second));
+        break;
+      case FactType::PRINT_VAR:
+        builder.addPrintVar(fact.first + stmtOffset, resolve(fact.second));
+        break;
+      case FactType::PROC:
+        builder.addProc(resolve(fact.first));
+        break;
+      case FactType::PROC_START_END: {
+        std::vector<int> end = procEnds[fact.third];
+        for (int& stmt : end) {
+          stmt += stmtOffset;
+        }
+        builder.addProcStartEnd(names[fact.first], fact.second + stmtOffset, end);
+        break;
+      }
+      case FactType::PROC_RANGE:
+        builder.addProcRange(names[fact.first], fact.second + stmtOffset, fact.third + stmtOffset);
+        break;
+      default:
+        assert(false);
+      }
+    }
+  }
+}
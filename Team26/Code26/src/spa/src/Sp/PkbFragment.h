@@ -0,0 +1,114 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ExprDag.h"
+#include "PkbBuilder.h"
+
+namespace SourceProcessor {
+  /**
+   * Facts about a run of consecutive procedures, recorded by the SimpleParser and loaded into a
+   * Pkb later through a PkbBuilder, so that procedures can be parsed independently of each other.
+   *
+   * Statement numbers are local to the fragment, counting from 1 at its first statement, and
+   * are offset by the number of statements before the fragment when it is merged. Names are
+   * interned into ids local to the fragment, and resolved to entities of the Pkb when it is
+   * merged, and so are expressions, into nodes of an expression DAG local to the fragment.
+   * The methods mirror the Pkb methods of the same name.
+   *
+   * Parent* is not recorded but derived from Parent when the fragment is merged, so that a
+   * statement costs a single fact however deeply it is nested.
+   */
+  class PkbFragment {
+  private:
+    enum class FactType {
+      CFG_EDGE, VAR, CONST, IF, WHILE, READ, PRINT, ASSIGN, CALL, FOLLOWS, FOLLOWS_T, PARENT,
+      USES_S, USES_P, MODIFIES_S, MODIFIES_P, CALLS, PATTERN_ASSIGN, PATTERN_IF, PATTERN_WHILE,
+      CALL_PROC, READ_VAR, PRINT_VAR, PROC, PROC_START_END, PROC_RANGE
+    };
+
+    // A fact and its arguments, each a local statement number, the id of a name, a node of
+    // exprs or an index into procEnds, depending on the type
+    struct Fact {
+      FactType type;
+      int first;
+      int second;
+      int third;
+    };
+
+    std::vector<Fact> facts;
+    std::vector<std::string> names;
+    std::unordered_map<std::string, int> nameToId;
+    ExprDag exprs; // Leaves are ids of names
+    std::vector<std::vector<int>> procEnds;
+    int numStmts = 0;
+
+    /**
+     * Returns the id of a name, interning it if it is new.
+     *
+     * @param name Name of interest.
+     * @returns Id of the name within the fragment.
+     */
+    int intern(const std::string& name);
+
+    /**
+     * Records a fact about a statement and counts the statement.
+     *
+     * @param type Type of the fact.
+     * @param stmtNum Local statement number of the statement.
+     */
+    void addStmtFact(FactType type, const int stmtNum);
+
+  public:
+    void addCfgEdge(const int from, const int to);
+    void addVar(const std::string& var);
+    void addConst(const std::string& constant);
+    void addIf(const int stmtNum);
+    void addWhile(const int stmtNum);
+    void addRead(const int stmtNum);
+    void addPrint(const int stmtNum);
+    void addAssign(const int stmtNum);
+    void addCall(const int stmtNum);
+    void addFollows(const int followed, const int follower);
+    void addFollowsT(const int followed, const int follower);
+    void addParent(const int parent, const int child);
+    void addUsesS(const int stmtNum, const std::string& var);
+    void addUsesP(const std::string& proc, const std::string& var);
+    void addModifiesS(const int stmtNum, const std::string& var);
+    void addModifiesP(const std::string& proc, const std::string& var);
+    void addCalls(const std::string& caller, const std::string& called);
+    void addPatternAssign(const int stmtNum, const std::string& lhs, const std::string& rhs);
+    void addPatternIf(const int stmtNum, const std::string& var);
+    void addPatternWhile(const int stmtNum, const std::string& var);
+    void addCallProc(const int stmtNum, const std::string& proc);
+    void addReadVar(const int stmtNum, const std::string& var);
+    void addPrintVar(const int stmtNum, const std::string& var);
+    void addProc(const std::string& proc);
+    void addProcStartEnd(const std::string& proc, const int start, const std::vector<int>& end);
+    void addProcRange(const std::string& proc, const int first, const int last);
+
+    /**
+     * Returns the number of statements in the fragment.
+     *
+     * @returns Number of statements.
+     */
+    int getNumStmts() const;
+
+    /**
+     * Returns the names of the procedures in the fragment.
+     *
+     * @returns Names of the procedures, in order.
+     */
+    std::vector<std::string> getProcs() const;
+
+    /**
+     * Adds all facts of the fragment to a PkbBuilder, resolving each name to an entity once.
+     *
+     * @param builder The builder to add to.
+     * @param stmtOffset Number of statements before the fragment in the program.
+     */
+    void mergeInto(PkbBuilder& builder, const int stmtOffset) const;
+  };
+}
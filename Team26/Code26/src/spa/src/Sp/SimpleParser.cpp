@@ -4,12 +4,16 @@
 
 #include <list>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "ExprParser.h"
 #include "Pkb.h"
+#include "PkbBuilder.h"
+#include "PkbFragment.h"
 #include "SpaException.h"
 #include "Token.h"
+#include "TokenCursor.h"
 
 namespace SourceProcessor {
   // Delimiters
@@ -48,21 +52,21 @@ namespace SourceProcessor {
   // Should only be called after getFrontToken()
   // Pre-condition: tokens will never be empty
   void SimpleParser::removeFrontToken() {
-    if (tokens.empty()) {
+    if (!tokens.hasToken()) {
       assert(false);
     }
-    tokens.pop_front();
+    tokens.advance();
   }
 
   Token SimpleParser::getFrontToken() {
-    if (tokens.empty()) {
+    if (!tokens.hasToken()) {
       throw SyntaxError(
         ErrorMessage::SYNTAX_ERROR_NOT_ENOUGH_TOKENS +
         ErrorMessage::APPEND_STMT_NUMBER +
         std::to_string(getStmtNum())
       );
     }
-    return tokens.front();
+    return tokens.peek();
   }
 
   void SimpleParser::setCurrentProc(std::string procName) {
@@ -73,6 +77,34 @@ namespace SourceProcessor {
     return currentProc;
   }
 
+  void SimpleParser::addUses(int stmtNum, const std::string& var) {
+    fragment.addUsesS(stmtNum, var); // add Uses relation for stmt-var
+    for (std::vector<StmtLst>::reverse_iterator lst = stmtLsts.rbegin(); lst != stmtLsts.rend(); ++lst) {
+      if (!lst->usedVars.insert(var).second) {
+        break;
+      }
+      if (lst->parent == 0) {
+        fragment.addUsesP(getCurrentProc(), var); // add Uses relation for proc-var
+      } else {
+        fragment.addUsesS(lst->parent, var); // add Uses relation for container-var
+      }
+    }
+  }
+
+  void SimpleParser::addModifies(int stmtNum, const std::string& var) {
+    fragment.addModifiesS(stmtNum, var); // add Modifies relation for stmt-var
+    for (std::vector<StmtLst>::reverse_iterator lst = stmtLsts.rbegin(); lst != stmtLsts.rend(); ++lst) {
+      if (!lst->modifiedVars.insert(var).second) {
+        break;
+      }
+      if (lst->parent == 0) {
+        fragment.addModifiesP(getCurrentProc(), var); // add Modifies relation for proc-var
+      } else {
+        fragment.addModifiesS(lst->parent, var); // add Modifies relation for container-var
+      }
+    }
+  }
+
   std::string SimpleParser::validate(const Token& validationToken) {
     Token front = getFrontToken();
     removeFrontToken();
@@ -116,7 +148,7 @@ namespace SourceProcessor {
 
   std::string SimpleParser::parseAssignExpr() {
     std::list<Token> infixExprTokens;
-    while (!tokens.empty()) {
+    while (tokens.hasToken()) {
       Token next = getFrontToken();
       if (next == SEMICOLON) { // check for end of assign stmt
         break;
@@ -143,12 +175,11 @@ namespace SourceProcessor {
 
     // adding information to pkb
     for (const std::string& variable : variablesUsed) {
-      pkb.addUsesS(getStmtNum(), variable); // add Uses relation for stmt-var
-      pkb.addUsesP(getCurrentProc(), variable); // add Uses relation for proc-var
-      pkb.addVar(variable); // add vars
+      addUses(getStmtNum(), variable); // add Uses relation for stmt-var and proc-var
+      fragment.addVar(variable); // add vars
     }
     for (const std::string& constants : constantsUsed) {
-      pkb.addConst(constants); // add consts
+      fragment.addConst(constants); // add consts
     }
 
     return exprParser.getPostfixExprString();
@@ -156,10 +187,9 @@ namespace SourceProcessor {
 
   std::unordered_set<std::string> SimpleParser::parseCondExpr() {
     std::list<Token> infixExprTokens;
-    auto it = tokens.begin();
-    while (it != tokens.end() && std::next(it) != tokens.end()) {
+    while (tokens.hasToken(1)) {
       Token current = getFrontToken();
-      Token next = *std::next(it);
+      const Token& next = tokens.peek(1);
 
       bool isEndOfCondExpr = current == RIGHT_PARENTHESIS && (next == THEN || next == LEFT_BRACE);
       if (isEndOfCondExpr) {
@@ -168,7 +198,6 @@ namespace SourceProcessor {
         validateNumToken();
       }
       infixExprTokens.emplace_back(current);
-      it++;
       removeFrontToken();
     }
 
@@ -187,18 +216,17 @@ namespace SourceProcessor {
 
     // adding information to pkb
     for (const std::string& variable : variablesUsed) {
-      pkb.addUsesS(getStmtNum(), variable); // add Uses relation for stmt-var
-      pkb.addUsesP(getCurrentProc(), variable); // add Uses relation for proc-var
-      pkb.addVar(variable); // add vars
+      addUses(getStmtNum(), variable); // add Uses relation for stmt-var and proc-var
+      fragment.addVar(variable); // add vars
     }
     for (const std::string& constants : constantsUsed) {
-      pkb.addConst(constants); // add consts
+      fragment.addConst(constants); // add consts
     }
 
     return variablesUsed;
   }
 
-  int SimpleParser::parseIf() {
+  void SimpleParser::parseIf() {
     // grammar: 'if' '(' cond_expr ')'
     validate(IF);
     validate(LEFT_PARENTHESIS);
@@ -210,47 +238,24 @@ namespace SourceProcessor {
 
     // adding information to pkb
     for (int i : prevStmts) {
-      pkb.addCfgEdge(i, stmtNum); // adding Next relation for stmt-stmt and Cfg nodes
+      fragment.addCfgEdge(i, stmtNum); // adding Next relation for stmt-stmt and Cfg nodes
     }
-    pkb.addIf(stmtNum); // add if stmts
+    fragment.addIf(stmtNum); // add if stmts
     for (const std::string& variable : variablesUsed) {
-      pkb.addPatternIf(stmtNum, variable); // add if stmt control variable
+      fragment.addPatternIf(stmtNum, variable); // add if stmt control variable
     }
 
     // update prevStmts
     prevStmts.clear();
     prevStmts.emplace_back(stmtNum);
 
-    // grammar: 'then' '{' stmtLst '}'
+    // grammar: 'then' '{' stmtLst '}', continued by closeStmtLst()
     validate(THEN);
     validate(LEFT_BRACE);
-    parseStmtLst(stmtNum, getStmtNum());
-    validate(RIGHT_BRACE);
-
-    std::vector<int> lastStmtsIfBranch;
-    for (int i : prevStmts) {
-      lastStmtsIfBranch.emplace_back(i);
-    }
-
-    // update prevStmts
-    prevStmts.clear();
-    prevStmts.emplace_back(stmtNum);
-
-    // grammar: 'else' '{' stmtLst '}'
-    validate(ELSE);
-    validate(LEFT_BRACE);
-    parseStmtLst(stmtNum, getStmtNum());
-    validate(RIGHT_BRACE);
-
-    // update prevStmts
-    for (int i : lastStmtsIfBranch) {
-      prevStmts.emplace_back(i);
-    }
-
-    return stmtNum;
+    openStmtLst(StmtLstType::THEN, stmtNum);
   }
 
-  int SimpleParser::parseWhile() {
+  void SimpleParser::parseWhile() {
     // grammar: 'while' '(' cond_expr ')'
     validate(WHILE);
     validate(LEFT_PARENTHESIS);
@@ -262,32 +267,20 @@ namespace SourceProcessor {
 
     // adding information to pkb
     for (int i : prevStmts) {
-      pkb.addCfgEdge(i, stmtNum); // adding Next relation for stmt-stmt and Cfg nodes
+      fragment.addCfgEdge(i, stmtNum); // adding Next relation for stmt-stmt and Cfg nodes
     }
-    pkb.addWhile(stmtNum); // add while stmts
+    fragment.addWhile(stmtNum); // add while stmts
     for (const std::string& variable : variablesUsed) {
-      pkb.addPatternWhile(stmtNum, variable); // add while stmt control variable
+      fragment.addPatternWhile(stmtNum, variable); // add while stmt control variable
     }
 
     // update prevStmts
     prevStmts.clear();
     prevStmts.emplace_back(stmtNum);
 
-    // grammar: '{' stmtLst '}'
+    // grammar: '{' stmtLst '}', continued by closeStmtLst()
     validate(LEFT_BRACE);
-    parseStmtLst(stmtNum, getStmtNum());
-    validate(RIGHT_BRACE);
-
-    // adding information to pkb
-    for (int i : prevStmts) {
-      pkb.addCfgEdge(i, stmtNum); // adding Next relation for stmt-stmt and Cfg nodes
-    }
-
-    // update prevStmts
-    prevStmts.clear();
-    prevStmts.emplace_back(stmtNum);
-
-    return stmtNum;
+    openStmtLst(StmtLstType::WHILE, stmtNum);
   }
 
   int SimpleParser::parseCall() {
@@ -300,11 +293,11 @@ namespace SourceProcessor {
 
     // adding information to pkb
     for (int i : prevStmts) {
-      pkb.addCfgEdge(i, stmtNum); // adding Next relation for stmt-stmt and Cfg nodes
+      fragment.addCfgEdge(i, stmtNum); // adding Next relation for stmt-stmt and Cfg nodes
     }
-    pkb.addCall(stmtNum); // add call stmts
-    pkb.addCalls(getCurrentProc(), procName); // add proc-proc calls relation
-    pkb.addCallProc(stmtNum, procName); // add stmt-proc
+    fragment.addCall(stmtNum); // add call stmts
+    fragment.addCalls(getCurrentProc(), procName); // add proc-proc calls relation
+    fragment.addCallProc(stmtNum, procName); // add stmt-proc
 
     // update prevStmts
     prevStmts.clear();
@@ -324,13 +317,12 @@ namespace SourceProcessor {
 
     // adding information to pkb
     for (int i : prevStmts) {
-      pkb.addCfgEdge(i, stmtNum); // adding Next relation for stmt-stmt and Cfg nodes
+      fragment.addCfgEdge(i, stmtNum); // adding Next relation for stmt-stmt and Cfg nodes
     }
-    pkb.addVar(varName); // add variable
-    pkb.addRead(stmtNum); // add read stmts
-    pkb.addReadVar(stmtNum, varName); // add stmt-var
-    pkb.addModifiesS(stmtNum, varName); // add Modifies relation for stmt-var
-    pkb.addModifiesP(getCurrentProc(), varName); // add Modifies relation for proc-var
+    fragment.addVar(varName); // add variable
+    fragment.addRead(stmtNum); // add read stmts
+    fragment.addReadVar(stmtNum, varName); // add stmt-var
+    addModifies(stmtNum, varName); // add Modifies relation for stmt-var and proc-var
 
     // update prevStmts
     prevStmts.clear();
@@ -350,13 +342,12 @@ namespace SourceProcessor {
 
     // adding information to pkb
     for (int i : prevStmts) {
-      pkb.addCfgEdge(i, stmtNum); // adding Next relation for stmt-stmt and Cfg nodes
+      fragment.addCfgEdge(i, stmtNum); // adding Next relation for stmt-stmt and Cfg nodes
     }
-    pkb.addVar(varName); // add variable
-    pkb.addPrint(stmtNum); // add print stmts
-    pkb.addPrintVar(stmtNum, varName); // add stmt-var
-    pkb.addUsesS(stmtNum, varName); // add Uses relation for stmt-var
-    pkb.addUsesP(getCurrentProc(), varName); // add Uses relation for proc-var
+    fragment.addVar(varName); // add variable
+    fragment.addPrint(stmtNum); // add print stmts
+    fragment.addPrintVar(stmtNum, varName); // add stmt-var
+    addUses(stmtNum, varName); // add Uses relation for stmt-var and proc-var
 
     // update prevStmts
     prevStmts.clear();
@@ -378,13 +369,12 @@ namespace SourceProcessor {
 
     // adding information to pkb
     for (int i : prevStmts) {
-      pkb.addCfgEdge(i, stmtNum); // adding Next relation for stmt-stmt and Cfg nodes
+      fragment.addCfgEdge(i, stmtNum); // adding Next relation for stmt-stmt and Cfg nodes
     }
-    pkb.addVar(varName); // add variable
-    pkb.addAssign(stmtNum); /// add assign stmts
-    pkb.addModifiesS(stmtNum, varName); // add Modifies relation for stmt-var
-    pkb.addModifiesP(getCurrentProc(), varName); // add Modifies relation for proc-var
-    pkb.addPatternAssign(stmtNum, varName, exprString); // add assign expr pattern
+    fragment.addVar(varName); // add variable
+    fragment.addAssign(stmtNum); /// add assign stmts
+    addModifies(stmtNum, varName); // add Modifies relation for stmt-var and proc-var
+    fragment.addPatternAssign(stmtNum, varName, exprString); // add assign expr pattern
 
     // update prevStmts
     prevStmts.clear();
@@ -393,9 +383,9 @@ namespace SourceProcessor {
     return stmtNum;
   }
 
-  int SimpleParser::parseStmt(int first) {
+  int SimpleParser::parseStmt() {
     Token keyword = getFrontToken();
-    int stmt;
+    int stmt = 0;
 
     if (keyword.type != NAME.type) {
       throw SyntaxError(
@@ -404,9 +394,7 @@ namespace SourceProcessor {
         std::to_string(getStmtNum())
       );
     } else {
-      auto it = std::next(tokens.begin());
-
-      if (it == tokens.end()) {
+      if (!tokens.hasToken(1)) {
         throw SyntaxError(
           ErrorMessage::SYNTAX_ERROR_NOT_ENOUGH_TOKENS +
           ErrorMessage::APPEND_STMT_NUMBER +
@@ -414,12 +402,12 @@ namespace SourceProcessor {
         );
       }
 
-      if (*it == ASSIGN_OP) {
+      if (tokens.peek(1) == ASSIGN_OP) {
         stmt = parseAssign();
       } else if (keyword == IF) {
-        stmt = parseIf();
+        parseIf();
       } else if (keyword == WHILE) {
-        stmt = parseWhile();
+        parseWhile();
       } else if (keyword == READ) {
         stmt = parseRead();
       } else if (keyword == PRINT) {
@@ -435,35 +423,103 @@ namespace SourceProcessor {
       }
     }
 
-    // Check if statement is itself
-    if (first != stmt) {
-      pkb.addFollows(first, stmt); // add Follows relation for stmt-stmt
-    }
-
     return stmt;
   }
 
-  void SimpleParser::parseStmtLst(int parent, int first) {
-    bool isStmtLstEmpty = true;
-    int stmt = first;
-    while (!tokens.empty() && tokens.front() != RIGHT_BRACE) {
-      stmt = parseStmt(stmt);
+  void SimpleParser::openStmtLst(StmtLstType type, int parent) {
+    StmtLst lst;
+    lst.type = type;
+    lst.parent = parent;
+    lst.first = getStmtNum();
+    lst.prevStmt = lst.first;
+    stmtLsts.push_back(std::move(lst));
+  }
 
-      bool isAtTopLevel = parent == 0;
-      if (!isAtTopLevel) {
-        pkb.addParent(parent, stmt); // add Parents relation for stmt-stmt
-      }
+  void SimpleParser::closeStmtLst() {
+    StmtLst lst = std::move(stmtLsts.back());
+    stmtLsts.pop_back();
 
-      isStmtLstEmpty = false;
-    }
+    bool isStmtLstEmpty = lst.stmts.empty();
 
     if (isStmtLstEmpty) {
       throw SyntaxError(
         ErrorMessage::SYNTAX_ERROR_EMPTY_STMT_LIST +
         ErrorMessage::APPEND_STMT_NUMBER +
-        std::to_string(first)
+        std::to_string(lst.first)
       );
     }
+
+    if (lst.type == StmtLstType::PROCEDURE) {
+      return;
+    }
+    validate(RIGHT_BRACE);
+
+    if (lst.type == StmtLstType::THEN) {
+      // grammar: 'else' '{' stmtLst '}'
+      validate(ELSE);
+      validate(LEFT_BRACE);
+      openStmtLst(StmtLstType::ELSE, lst.parent);
+      StmtLst& elseLst = stmtLsts.back();
+      elseLst.lastStmtsOfThen.swap(prevStmts);
+      elseLst.usedVars.swap(lst.usedVars);
+      elseLst.modifiedVars.swap(lst.modifiedVars);
+
+      // update prevStmts
+      prevStmts.clear();
+      prevStmts.emplace_back(lst.parent);
+      return;
+    }
+
+    if (lst.type == StmtLstType::ELSE) {
+      // update prevStmts
+      for (int i : lst.lastStmtsOfThen) {
+        prevStmts.emplace_back(i);
+      }
+    } else {
+      // adding information to pkb
+      for (int i : prevStmts) {
+        fragment.addCfgEdge(i, lst.parent); // adding Next relation for stmt-stmt and Cfg nodes
+      }
+
+      // update prevStmts
+      prevStmts.clear();
+      prevStmts.emplace_back(lst.parent);
+    }
+
+    addStmtToLst(lst.parent);
+  }
+
+  void SimpleParser::addStmtToLst(int stmt) {
+    StmtLst& lst = stmtLsts.back();
+
+    // Check if statement is itself
+    if (lst.prevStmt != stmt) {
+      fragment.addFollows(lst.prevStmt, stmt); // add Follows relation for stmt-stmt
+    }
+    lst.prevStmt = stmt;
+
+    for (const int prevStmt : lst.stmts) {
+      fragment.addFollowsT(prevStmt, stmt); // add FollowsT relation for stmt-stmt
+    }
+    lst.stmts.emplace_back(stmt);
+
+    if (lst.parent != 0) {
+      fragment.addParent(lst.parent, stmt); // add Parents relation for stmt-stmt
+    }
+  }
+
+  void SimpleParser::parseStmtLst() {
+    openStmtLst(StmtLstType::PROCEDURE, 0);
+    while (!stmtLsts.empty()) {
+      if (tokens.hasToken() && tokens.peek() != RIGHT_BRACE) {
+        const int stmt = parseStmt();
+        if (stmt != 0) {
+          addStmtToLst(stmt);
+        }
+      } else {
+        closeStmtLst();
+      }
+    }
   }
 
   void SimpleParser::parseProcedure() {
@@ -484,7 +540,7 @@ namespace SourceProcessor {
     }
     parsedProcs.insert(procName);
     validate(LEFT_BRACE);
-    parseStmtLst(0, getStmtNum());
+    parseStmtLst();
     validate(RIGHT_BRACE);
 
     std::vector<int> end;
@@ -493,23 +549,41 @@ namespace SourceProcessor {
     }
 
     // adding to pkb
-    pkb.addProc(procName); // add procedures
-    pkb.addProcStartEnd(procName, start, end);
-    pkb.addProcRange(procName, start, getStmtNum() - 1);
+    fragment.addProc(procName); // add procedures
+    fragment.addProcStartEnd(procName, start, end);
+    fragment.addProcRange(procName, start, getStmtNum() - 1);
   }
 
   void SimpleParser::parseProgram() {
     // Multiple procedure allowed for iteration 2 onwards
-    while (!tokens.empty()) {
+    while (tokens.hasToken()) {
       parseProcedure();
     }
   }
 
   SimpleParser::SimpleParser(Pkb& pkb, std::list<Token> tokens)
-    : pkb(pkb), tokens(tokens) {
+    : tokens(std::move(tokens)), pkb(&pkb) {
+  };
+
+  SimpleParser::SimpleParser(Pkb& pkb, const TokenCursor& tokens)
+    : tokens(tokens), pkb(&pkb) {
+  };
+
+  SimpleParser::SimpleParser(const TokenCursor& tokens)
+    : tokens(tokens), pkb(nullptr) {
   };
 
   void SimpleParser::parse() {
+    assert(pkb != nullptr);
+    parseProgram();
+    PkbBuilder builder(*pkb);
+    fragment.mergeInto(builder, 0);
+    builder.build();
+    pkb->freezeCfg();
+  }
+
+  PkbFragment SimpleParser::parseFragment() {
     parseProgram();
+    return std::move(fragment);
   }
 }
\ No newline at end of file
@@ -7,18 +7,39 @@
 
 #include "ExprParser.h"
 #include "Pkb.h"
+#include "PkbFragment.h"
 #include "Token.h"
+#include "TokenCursor.h"
 
 namespace SourceProcessor {
   class SimpleParser {
   private:
+    // What a statement list belongs to
+    enum class StmtLstType { PROCEDURE, THEN, ELSE, WHILE };
+
+    // A statement list being parsed. Lists are kept on an explicit stack instead of the call
+    // stack, so that nesting is only limited by memory.
+    struct StmtLst {
+      StmtLstType type;
+      int parent; // Container stmt of the list, 0 for the list of a procedure
+      int first; // Statement number of the first stmt in the list
+      int prevStmt; // Last stmt parsed in the list, first if none yet
+      std::vector<int> stmts; // Stmts parsed so far in the list
+      std::vector<int> lastStmtsOfThen; // Last stmts in the CFG of the then branch, for an else list
+      // Variables whose Uses/Modifies have been added for the parent (the procedure if none)
+      std::unordered_set<std::string> usedVars;
+      std::unordered_set<std::string> modifiedVars;
+    };
+
     // Class variables
     std::unordered_set<std::string> parsedProcs;
     std::string currentProc;
-    std::list<Token> tokens;
+    TokenCursor tokens;
     int stmtNum = 1;
-    Pkb& pkb;
+    Pkb* pkb; // Null if only a fragment is parsed
+    PkbFragment fragment;
     std::vector<int> prevStmts;
+    std::vector<StmtLst> stmtLsts; // Statement lists enclosing the current stmt, innermost last
 
     // Functions
 
@@ -36,14 +57,14 @@ namespace SourceProcessor {
     int getStmtNum();
 
     /**
-     * Removes the first token in std::list<Token> token list.
+     * Consumes the next token.
      */
     void removeFrontToken();
 
     /**
-     * Gets the first token in std::list<Token> token list WITHOUT removing it.
+     * Gets the next token WITHOUT consuming it.
      *
-     * @returns Token The first token in the list of tokens.
+     * @returns Token The next token.
      */
     Token getFrontToken();
 
@@ -62,17 +83,36 @@ namespace SourceProcessor {
     std::string getCurrentProc();
 
     /**
-     * Checks if the first token in std::list<Token> token list matches the input token and returns its string representation if they match.
+     * Adds the Uses relation for the given statement, every container statement enclosing it
+     * and the current procedure. Enclosing containers are visited innermost first, and only
+     * until one already uses the variable, as all containers enclosing that one do too.
+     *
+     * @param stmtNum Statement number of the statement using the variable.
+     * @param var Name of the variable used.
+     */
+    void addUses(int stmtNum, const std::string& var);
+
+    /**
+     * Adds the Modifies relation for the given statement, every container statement enclosing it
+     * and the current procedure, visiting enclosing containers as addUses() does.
+     *
+     * @param stmtNum Statement number of the statement modifying the variable.
+     * @param var Name of the variable modified.
+     */
+    void addModifies(int stmtNum, const std::string& var);
+
+    /**
+     * Consumes the next token, checking if it matches the input token and returns its string representation if they match.
      * This check validates token type for procedure/variable names, both token type and token values otherwise.
      *
      * @param validationToken Reference of the input token used for validation.
-     * @returns std::string The string representation of the first token in the list of tokens.
+     * @returns std::string The string representation of the consumed token.
      */
     std::string validate(const Token& validationToken);
 
     /**
      * Checks if the token is a valid constant not starting with '0',
-     * if the first token in std::list<Token> token list is of TokenType::NUMBER.
+     * if the next token is of TokenType::NUMBER.
      * Example: '0' and '42' are valid tokens, while '042' is not.
      *
      */
@@ -101,22 +141,19 @@ namespace SourceProcessor {
     std::unordered_set<std::string> parseCondExpr();
 
     /**
-     * Parses tokens into an IF statement and returns its statement number.
-     * Calls parseCondExpr() to parse its conditional expression,
-     * then parseStmtLst() TWICE to parse the statements in its TWO statement lists.
+     * Parses tokens up to the start of the then branch of an IF statement and opens the
+     * statement list of the branch. The else branch is opened when the then branch is closed.
+     * Calls parseCondExpr() to parse its conditional expression.
      * Adds the if statement into the pkb.
-     *
-     * @returns int Statement number of the IF statement.
      */
-    int parseIf();
+    void parseIf();
 
     /**
-     * Parses tokens into a WHILE statement and returns its statement number.
+     * Parses tokens up to the start of the body of a WHILE statement and opens the statement
+     * list of the body.
      * Adds the while statement into the pkb.
-     *
-     * @returns int Statement number of the WHILE statement.
      */
-    int parseWhile();
+    void parseWhile();
 
     /**
      * Parses tokens into a CALL statement and returns its statement number.
@@ -152,26 +189,44 @@ namespace SourceProcessor {
     int parseAssign();
 
     /**
-     * Parses tokens into a statement if valid and returns its statement number.
+     * Parses tokens into a statement if valid.
      * Statements are as follow - if/ while/ read/ print/ call/ assign.
      * Calls the corresponding parseIf(), parseWhile(), parseRead(), parsePrint(), parseCall() and parseAssign() functions.
-     * Adds the Follows relation for the earlier statement and the current statement in the same statement list and
-     * the current statement into the Pkb.
      *
-     * @param first Statement number of the first statement in the current statement list. Used to set FollowsT() relation.
-     * @returns int Statement number of the parsed statement.
+     * @returns int Statement number of the parsed statement, or 0 for a container statement,
+     *     which is only parsed once its statement lists are closed.
      */
-    int parseStmt(int first);
+    int parseStmt();
 
     /**
-     * Parses tokens into a statement list and checks if the parsed statement list is empty.
-     * Calls parseStmt() to parse statements in the statement list.
-     * Sets the Parent relation if the parent statement exists.
+     * Opens a statement list, which then encloses the statements parsed until it is closed.
      *
+     * @param type What the statement list belongs to.
      * @param parent Statement number of the parent statement. 0 for no parent statement.
-     * @param first Statement number of the first statement in the statement list.
      */
-    void parseStmtLst(int parent, int first);
+    void openStmtLst(StmtLstType type, int parent);
+
+    /**
+     * Closes the innermost statement list, checking that it is not empty. Closing the then
+     * branch of an if statement opens its else branch, and closing the last list of a
+     * container statement adds the container to the list enclosing it.
+     */
+    void closeStmtLst();
+
+    /**
+     * Adds a parsed statement to the innermost statement list.
+     * Sets the Follows and Follows* relations with the earlier statements in the list, and the
+     * Parent relation if the parent statement exists.
+     *
+     * @param stmt Statement number of the statement.
+     */
+    void addStmtToLst(int stmt);
+
+    /**
+     * Parses tokens into the statement list of a procedure, with all statement lists nested in
+     * it, without recursing.
+     */
+    void parseStmtLst();
 
     /**
      * Parses tokens into a procedure if valid.
@@ -191,6 +246,34 @@ namespace SourceProcessor {
   public:
     SimpleParser(Pkb& pkb, std::list<Token> tokens);
 
+    /**
+     * Constructs a parser that pulls its tokens from a cursor as it parses, so that a cursor
+     * over a source text never has the whole text tokenised in memory.
+     *
+     * @param pkb The Pkb to fill in.
+     * @param tokens The cursor to pull tokens from.
+     */
+    SimpleParser(Pkb& pkb, const TokenCursor& tokens);
+
+    /**
+     * Constructs a parser for a run of whole procedures that are parsed into a PkbFragment
+     * with parseFragment(), independently of the rest of the program.
+     *
+     * @param tokens The cursor to pull tokens from.
+     */
+    SimpleParser(const TokenCursor& tokens);
+
+    /**
+     * Parses the program into the Pkb and freezes its CFG.
+     */
     void parse();
+
+    /**
+     * Parses the procedures, numbering their statements from 1, into a fragment to be merged
+     * into a Pkb later. Duplicated procedure names are only detected within the fragment.
+     *
+     * @returns The facts parsed.
+     */
+    PkbFragment parseFragment();
   };
 }
\ No newline at end of file
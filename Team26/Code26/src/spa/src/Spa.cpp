@@ -1,42 +1,116 @@
 #include "Spa.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <exception>
 #include <iostream>
 #include <fstream>
 #include <list>
 #include <sstream>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "DesignExtractor.h"
+#include "MappedFile.h"
+#include "MaterialisationPolicy.h"
+#include "ParallelParser.h"
+#include "PqlClauseCache.h"
 #include "PqlEvaluator.h"
 #include "PqlParser.h"
+#include "PqlPlanCache.h"
+#include "PqlPreparedQuery.h"
+#include "PqlPreprocessor.h"
 #include "PqlQuery.h"
-#include "SimpleParser.h"
+#include "Profiler.h"
 #include "SpaException.h"
 #include "Token.h"
 #include "Tokeniser.h"
 
-Spa::Spa()
-  : pkb(Pkb()) {
+namespace {
+  /**
+   * Finds where the profile report should be written.
+   *
+   * @param options Options of the SPA.
+   * @return Path of the report, "-" for stderr, or empty if no report is wanted.
+   */
+  std::string getProfileReportPath(const SpaOptions& options) {
+    if (!options.profileReportPath.empty()) {
+      return options.profileReportPath;
+    }
+    const char* path = std::getenv("SPA_PROFILE");
+    return path == nullptr ? "" : path;
+  }
+
+  /**
+   * Writes the profile report of the given profiler.
+   *
+   * @param profiler Profiler whose phases are reported.
+   * @param path Path of the report, or "-" for stderr.
+   */
+  void writeProfileReport(const Profiler& profiler, const std::string& path) {
+    if (path == "-") {
+      std::cerr << profiler.toJson();
+      return;
+    }
+    std::ofstream reportFile(path);
+    if (!reportFile.is_open()) {
+      std::cerr << "Unable to open profile report file " << path << std::endl;
+      return;
+    }
+    reportFile << profiler.toJson();
+  }
+
+  /**
+   * Finds the derived relations needed to evaluate the given clause, in the order they must
+   * be extracted.
+   *
+   * @param clause Clause of interest.
+   * @return The derived relations needed.
+   */
+  std::vector<SourceProcessor::DerivedRelation> getDerivedRelations(const Pql::Clause& clause) {
+    switch (clause.getType()) {
+    case Pql::ClauseType::AFFECTS:
+      // Affects from or to a fixed stmt is searched for instead
+      if (clause.getParams()[0].isNumber() || clause.getParams()[1].isNumber()) {
+        return {};
+      }
+      return { SourceProcessor::DerivedRelation::AFFECTS };
+    case Pql::ClauseType::AFFECTS_T:
+      return { SourceProcessor::DerivedRelation::AFFECTS, SourceProcessor::DerivedRelation::AFFECTS_T };
+    case Pql::ClauseType::AFFECTS_BIP_T:
+      return { SourceProcessor::DerivedRelation::AFFECTS_BIP_T };
+    default:
+      return {};
+    }
+  }
+}
+
+Spa::Spa(const SpaOptions& options)
+  : pkb(Pkb()), options(options), planCache(options.queryPlanCacheCapacity),
+  clauseCache(options.clauseCacheByteBudget) {
 }
 
 void Spa::parseSourceFile(const std::string& filename) {
-  std::ifstream sourceFile(filename);
-  if (!sourceFile.is_open()) {
+  const MappedFile sourceFile(filename);
+  if (!sourceFile.isOpen()) {
     std::cout << "Unable to open source file" << std::endl;
     exit(EXIT_FAILURE);
   }
 
+  const std::string profileReportPath = getProfileReportPath(options);
+  Profiler profiler(!profileReportPath.empty());
+  deferredRelations.clear();
+  clauseCache.clear();
+
   try {
-    std::list<Token> tokens = Tokeniser()
+    SourceProcessor::ParallelParser parser(pkb, sourceFile.getText(), Tokeniser()
       .notAllowingLeadingZeroes()
-      .consumingWhitespace()
-      .tokenise(sourceFile);
-    sourceFile.close();
-
-    SourceProcessor::SimpleParser parser(pkb, tokens);
-    parser.parse();
-    SourceProcessor::DesignExtractor(pkb).extractAllDesignAbstractions();
+      .consumingWhitespace());
+    profiler.measure("parse", pkb, [&parser]() { parser.parse(); });
+    SourceProcessor::DesignExtractor designExtractor(pkb, options.materialisationPolicy, &profiler);
+    designExtractor.extractAllDesignAbstractions();
+    deferredRelations = designExtractor.getDeferredRelations();
 
   } catch (const std::exception& e) {
     pkb = Pkb();
@@ -47,6 +121,10 @@ void Spa::parseSourceFile(const std::string& filename) {
     std::cout << "OOPS! An unexpected error occured!";
     exit(EXIT_FAILURE);
   }
+
+  if (profiler.isEnabled()) {
+    writeProfileReport(profiler, profileReportPath);
+  }
 }
 
 void Spa::evaluateQuery(const std::string& queryString, std::list<std::string>& results) {
@@ -56,19 +134,72 @@ void Spa::evaluateQuery(const std::string& queryString, std::list<std::string>&
       .allowingLeadingZeroes()
       .notConsumingWhitespace()
       .tokenise(ss);
-    Pql::PqlParser parser(tokens);
-    Pql::Query queryObject = parser.parseQuery();
-    if (queryObject.hasSemanticError()) {
-      if (queryObject.isBoolean()) {
-        results.push_back("FALSE");
+    const std::string key = Pql::PlanCache::getKey(tokens);
+    Pql::QueryPlan* plan = planCache.find(key);
+    Pql::QueryPlan newPlan;
+    if (plan == nullptr) {
+      // Queries with errors are not cached, as their messages name their synonyms
+      Pql::PqlParser parser(tokens);
+      newPlan.query = parser.parseQuery();
+      if (newPlan.query.hasSemanticError()) {
+        if (newPlan.query.isBoolean()) {
+          results.push_back("FALSE");
+        }
+        throw Pql::SemanticError(newPlan.query.getSemanticErrorMessage());
       }
-      throw Pql::SemanticError(queryObject.getSemanticErrorMessage());
+      std::vector<Pql::Clause> clauses = newPlan.query.getClauses();
+      std::vector<Pql::Entity> targets = newPlan.query.getTargets();
+      newPlan.clauseGroups = Pql::PqlPreprocessor(clauses, targets).generateClauseGroups();
+      planCache.add(key, newPlan);
+      plan = &newPlan;
+    }
+    extractDeferredRelations(plan->query);
+    Pql::PqlEvaluator evaluator(pkb, plan->query, results, &clauseCache);
+    evaluator.evaluateQuery(plan->clauseGroups);
+  } catch (const std::exception& e) {
+    std::cout << e.what() << std::endl;
+  } catch (...) {
+    std::cout << "OOPS! An unexpected error occured!";
+  }
+}
+
+Pql::PreparedQuery Spa::prepare(const std::string& queryTemplate) const {
+  return Pql::PreparedQuery(queryTemplate);
+}
+
+void Spa::execute(const Pql::PreparedQuery& preparedQuery, const std::unordered_map<std::string, std::string>& bindings,
+  std::list<std::string>& results) {
+  try {
+    Pql::Query queryObject = preparedQuery.bind(bindings);
+    extractDeferredRelations(queryObject);
+    Pql::PqlEvaluator evaluator(pkb, queryObject, results, &clauseCache);
+    evaluator.evaluateQuery(preparedQuery.getClauseGroups());
+  } catch (const Pql::SemanticError& e) {
+    if (preparedQuery.isBoolean()) {
+      results.push_back("FALSE");
     }
-    Pql::PqlEvaluator evaluator(pkb, queryObject, results);
-    evaluator.evaluateQuery();
+    std::cout << e.what() << std::endl;
   } catch (const std::exception& e) {
     std::cout << e.what() << std::endl;
   } catch (...) {
     std::cout << "OOPS! An unexpected error occured!";
   }
 }
+
+void Spa::extractDeferredRelations(const Pql::Query& query) {
+  if (deferredRelations.empty()) {
+    return;
+  }
+
+  SourceProcessor::DesignExtractor designExtractor(pkb, options.materialisationPolicy);
+  for (const Pql::Clause& clause : query.getClauses()) {
+    for (const SourceProcessor::DerivedRelation relation : getDerivedRelations(clause)) {
+      const std::vector<SourceProcessor::DerivedRelation>::iterator deferred =
+        std::find(deferredRelations.begin(), deferredRelations.end(), relation);
+      if (deferred != deferredRelations.end()) {
+        deferredRelations.erase(deferred);
+        designExtractor.extractDeferredRelation(relation);
+      }
+    }
+  }
+}
@@ -1,9 +1,36 @@
 #pragma once
 
+#include <stddef.h>
+
 #include <list>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
+#include "MaterialisationPolicy.h"
 #include "Pkb.h"
+#include "PqlClauseCache.h"
+#include "PqlPlanCache.h"
+#include "PqlPreparedQuery.h"
+#include "PqlQuery.h"
+
+struct SpaOptions {
+  // File to write a JSON report of the time and memory spent in each phase of
+  // parseSourceFile to, or "-" for stderr. If empty, the SPA_PROFILE environment
+  // variable is used instead, and no report is written if that is unset too.
+  std::string profileReportPath;
+
+  // Chooses which derived relations are computed while parsing the source file, and which
+  // are computed when a query first needs them. All are computed while parsing by default.
+  SourceProcessor::MaterialisationPolicy materialisationPolicy;
+
+  // Most query plans kept between calls of evaluateQuery, 0 to parse and plan every query anew.
+  size_t queryPlanCacheCapacity = 1024;
+
+  // Most bytes of clause result tables kept between calls of evaluateQuery on the same source,
+  // 0 to evaluate every clause anew.
+  size_t clauseCacheByteBudget = 256 << 20;
+};
 
 class Spa {
   /**
@@ -11,8 +38,46 @@ class Spa {
    */
 private:
   Pkb pkb;
+  SpaOptions options;
+
+  // Relations deferred by the design extractor and not yet needed by any query.
+  std::vector<SourceProcessor::DerivedRelation> deferredRelations;
+
+  // Plans of the queries evaluated so far, which do not depend on the source.
+  Pql::PlanCache planCache;
+
+  // Result tables of the clauses evaluated on the current source.
+  Pql::ClauseCache clauseCache;
+
+  /**
+   * Extracts the deferred relations needed to evaluate the given query.
+   *
+   * @param query The query to be evaluated.
+   */
+  void extractDeferredRelations(const Pql::Query& query);
 public:
-  Spa();
+  Spa(const SpaOptions& options = SpaOptions());
   void parseSourceFile(const std::string& filename);
   void evaluateQuery(const std::string& queryString, std::list<std::string>& results);
+
+  /**
+   * Parses and plans a query with placeholders, such as "stmt s; Select s such that Affects($n, s)",
+   * to be evaluated with execute.
+   *
+   * @param queryTemplate Query with placeholders.
+   * @returns Handle of the query.
+   * @throws TokeniserException, Pql::SyntaxError or Pql::SemanticError if the template is not a valid query.
+   */
+  Pql::PreparedQuery prepare(const std::string& queryTemplate) const;
+
+  /**
+   * Evaluates a prepared query with the given values bound to its placeholders, reporting errors as
+   * evaluateQuery does.
+   *
+   * @param preparedQuery Handle of the query.
+   * @param bindings Value of each placeholder, by the name of the placeholder without the $.
+   * @param results Result list to be filled.
+   */
+  void execute(const Pql::PreparedQuery& preparedQuery, const std::unordered_map<std::string, std::string>& bindings,
+    std::list<std::string>& results);
 };
\ No newline at end of file
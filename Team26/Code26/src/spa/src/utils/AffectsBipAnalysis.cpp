@@ -0,0 +1,262 @@
+#include "AffectsBipAnalysis.h"
+
+#include <assert.h>
+
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Cfg.h"
+#include "Dataflow.h"
+
+namespace {
+  // Facts of a variable in ascending order: the token of variable v is -v - 1, and any
+  // other fact is the statement number of an assign statement.
+  typedef std::vector<int> Facts;
+
+  /**
+   * Returns the token fact of a variable.
+   *
+   * @param var Variable of interest.
+   * @returns The token.
+   */
+  int getToken(const int var) {
+    assert(var >= 0);
+    return -var - 1;
+  }
+
+  /**
+   * Returns the variable of a token fact.
+   *
+   * @param token Token of interest.
+   * @returns The variable.
+   */
+  int getTokenVar(const int token) {
+    assert(token < 0);
+    return -token - 1;
+  }
+
+  /**
+   * Returns the union of two sets of facts.
+   *
+   * @param first Facts in ascending order.
+   * @param second Facts in ascending order.
+   * @returns The facts in either, in ascending order.
+   */
+  Facts unite(const Facts& first, const Facts& second) {
+    Facts facts;
+    facts.reserve(first.size() + second.size());
+    std::set_union(first.begin(), first.end(), second.begin(), second.end(), std::back_inserter(facts));
+    return facts;
+  }
+
+  /**
+   * Facts on entry to or exit from a node, holding only the variables whose facts differ
+   * from the default. A variable killed by a read statement is held with no facts.
+   */
+  struct VarFacts {
+    // False until facts flow into the node, as no facts at all differs from the tokens
+    // every variable holds by default when summarising.
+    bool isReached;
+
+    // Whether variables default to their own token rather than to no facts.
+    bool hasTokens;
+
+    std::unordered_map<int, Facts> varToFacts;
+
+    VarFacts(const bool isReached, const bool hasTokens)
+      : isReached(isReached), hasTokens(hasTokens) {
+    }
+
+    Facts getDefault(const int var) const {
+      return isReached && hasTokens ? Facts{ getToken(var) } : Facts();
+    }
+
+    Facts get(const int var) const {
+      const std::unordered_map<int, Facts>::const_iterator it = varToFacts.find(var);
+      return it == varToFacts.end() ? getDefault(var) : it->second;
+    }
+
+    bool unionWith(const VarFacts& other) {
+      assert(hasTokens == other.hasTokens);
+      if (!other.isReached) {
+        return false;
+      }
+      if (!isReached) {
+        isReached = true;
+        varToFacts = other.varToFacts;
+        return true;
+      }
+
+      bool isChanged = false;
+      if (hasTokens) {
+        for (std::pair<const int, Facts>& varAndFacts : varToFacts) {
+          if (other.varToFacts.count(varAndFacts.first) == 0) {
+            const size_t numFacts = varAndFacts.second.size();
+            varAndFacts.second = unite(varAndFacts.second, other.getDefault(varAndFacts.first));
+            isChanged = varAndFacts.second.size() != numFacts || isChanged;
+          }
+        }
+      }
+      for (const std::pair<const int, Facts>& varAndFacts : other.varToFacts) {
+        const std::unordered_map<int, Facts>::iterator it = varToFacts.find(varAndFacts.first);
+        if (it == varToFacts.end()) {
+          const Facts defaultFacts = getDefault(varAndFacts.first);
+          Facts facts = unite(defaultFacts, varAndFacts.second);
+          if (facts.size() != defaultFacts.size()) {
+            varToFacts.emplace(varAndFacts.first, std::move(facts));
+            isChanged = true;
+          }
+        } else {
+          const size_t numFacts = it->second.size();
+          it->second = unite(it->second, varAndFacts.second);
+          isChanged = it->second.size() != numFacts || isChanged;
+        }
+      }
+      return isChanged;
+    }
+
+    size_t getNumFacts() const {
+      size_t numFacts = 0;
+      for (const std::pair<const int, Facts>& varAndFacts : varToFacts) {
+        numFacts += 1 + varAndFacts.second.size();
+      }
+      return numFacts;
+    }
+  };
+
+  /**
+   * Returns the facts on exit from a call, given the facts on entry to it and the summary of
+   * the called procedure. Only the variables the summary holds change.
+   *
+   * @param summary Facts on exit from the called procedure, starting from the tokens.
+   * @param in Facts on entry to the call.
+   * @returns Facts on exit from the call.
+   */
+  VarFacts applySummary(const VarFacts& summary, const VarFacts& in) {
+    if (!summary.isReached) {
+      return VarFacts(false, in.hasTokens);
+    }
+
+    VarFacts out = in;
+    for (const std::pair<const int, Facts>& varAndFacts : summary.varToFacts) {
+      const Facts::const_iterator firstDef =
+        std::upper_bound(varAndFacts.second.begin(), varAndFacts.second.end(), -1);
+      Facts facts(firstDef, varAndFacts.second.end());
+      for (Facts::const_iterator token = varAndFacts.second.begin(); token != firstDef; token++) {
+        facts = unite(facts, in.get(getTokenVar(*token)));
+      }
+      out.varToFacts[varAndFacts.first] = std::move(facts);
+    }
+    return out;
+  }
+}
+
+namespace Cfg {
+  AffectsBipAnalysis::AffectsBipAnalysis(const Cfg& cfg, const std::unordered_map<int, int>& assignToVarModified,
+    const std::unordered_map<int, int>& readToVarModified,
+    const std::unordered_map<int, std::vector<int>>& assignToVarsUsed, const bool isTransitive)
+    : numFacts(0) {
+    const CfgBip& cfgBip = cfg.getCfgBip();
+    const std::vector<ProcedureBip>& procs = cfgBip.getProcedureBips();
+    const size_t numProcs = procs.size();
+    const std::vector<int> noVarsUsed;
+
+    std::vector<VarFacts> summaries(numProcs, VarFacts(false, true));
+
+    auto getVarsUsed = [&](const int stmt) -> const std::vector<int>& {
+      const std::unordered_map<int, std::vector<int>>::const_iterator it = assignToVarsUsed.find(stmt);
+      return it == assignToVarsUsed.end() ? noVarsUsed : it->second;
+    };
+
+    auto transfer = [&](const BipNode& node, const VarFacts& in) -> VarFacts {
+      if (!in.isReached) {
+        return in;
+      }
+      if (node.calledProc != -1) {
+        return applySummary(summaries[node.calledProc], in);
+      }
+
+      const std::unordered_map<int, int>::const_iterator read = readToVarModified.find(node.node);
+      if (read != readToVarModified.end()) {
+        VarFacts out = in;
+        out.varToFacts[read->second] = Facts();
+        return out;
+      }
+      const std::unordered_map<int, int>::const_iterator assign = assignToVarModified.find(node.node);
+      if (assign == assignToVarModified.end()) {
+        return in;
+      }
+
+      Facts carried;
+      if (isTransitive) {
+        for (const int var : getVarsUsed(node.node)) {
+          carried = unite(carried, in.get(var));
+        }
+      }
+      carried = unite(carried, Facts{ node.node });
+      VarFacts out = in;
+      out.varToFacts[assign->second] = std::move(carried);
+      return out;
+    };
+
+    // Solves a procedure given the facts on entry to it
+    auto solveProcedure = [&](const ProcedureBip& proc, const VarFacts& entry) -> std::vector<VarFacts> {
+      std::vector<std::vector<int>> successors(proc.numNodes);
+      for (BipIndex local = 0; local < proc.numNodes; local++) {
+        for (const BipIndex next : cfgBip.getNexts(proc.firstNode + local)) {
+          successors[local].push_back(next - proc.firstNode);
+        }
+      }
+
+      std::vector<VarFacts> in(proc.numNodes, VarFacts(false, entry.hasTokens));
+      in[proc.start - proc.firstNode] = entry;
+      Dataflow::solveForward(successors, in, [&](int local, const VarFacts& nodeIn) {
+        return transfer(cfgBip.getNode(proc.firstNode + local), nodeIn);
+      });
+      for (const VarFacts& nodeIn : in) {
+        numFacts += nodeIn.getNumFacts();
+      }
+      return in;
+    };
+
+    // 1) Summaries, callees first
+    for (size_t p = numProcs; p-- > 0;) {
+      const std::vector<VarFacts>& in = solveProcedure(procs[p], VarFacts(true, true));
+      summaries[p] = in.back(); // dummy end node is the last node
+    }
+
+    // 2) Actual facts, callers first
+    std::vector<VarFacts> entries(numProcs, VarFacts(true, false));
+    for (size_t p = 0; p < numProcs; p++) {
+      const std::vector<VarFacts>& in = solveProcedure(procs[p], entries[p]);
+      for (BipIndex local = 0; local < procs[p].numNodes; local++) {
+        const BipNode& node = cfgBip.getNode(procs[p].firstNode + local);
+        if (node.calledProc != -1) {
+          entries[node.calledProc].unionWith(in[local]);
+        }
+        if (assignToVarModified.count(node.node) == 0) {
+          continue;
+        }
+
+        Facts affecters;
+        for (const int var : getVarsUsed(node.node)) {
+          affecters = unite(affecters, in[local].get(var));
+        }
+        for (const int affecter : affecters) {
+          relation.emplace_back(affecter, node.node);
+        }
+      }
+    }
+  }
+
+  const std::vector<std::pair<int, int>>& AffectsBipAnalysis::getRelation() const {
+    return relation;
+  }
+
+  size_t AffectsBipAnalysis::getNumFacts() const {
+    return numFacts;
+  }
+}
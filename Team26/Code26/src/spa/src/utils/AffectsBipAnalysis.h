@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Cfg.h"
+
+namespace Cfg {
+  /**
+   * Computes the AffectsBip or AffectsBipT relation with the functional approach to
+   * interprocedural dataflow analysis, over the graph of each procedure in the CFGBip.
+   *
+   * The facts at each node map variables to the assign statements whose value they carry.
+   * For AffectsBip, an assign statement a replaces the facts of the variable it modifies
+   * with { a }; for AffectsBipT, with { a } and the facts of all variables used by a. Read
+   * statements clear the facts of the variable they modify. The relation holds for (a1, a2)
+   * when a1 is in the facts of a variable used by a2 on entry to a2.
+   *
+   *   1) Callees first, each procedure is summarised by the facts on exit from it when
+   *      starting from a token fact per variable. Tokens on exit record which variables
+   *      flow through the procedure; other facts are generated inside it.
+   *   2) Callers first, each procedure is solved with the union of the facts on entry to
+   *      all of its call sites, applying the summary of the called procedure at each call.
+   *
+   * Facts are kept sparsely: a node holds only the variables whose facts differ from the
+   * default, which is no facts, or the variable's own token when summarising. A summary thus
+   * holds only the variables its procedure may modify, and applying it touches only those,
+   * so that the cost of the analysis scales with the facts generated rather than with the
+   * number of variables.
+   */
+  class AffectsBipAnalysis {
+  private:
+    std::vector<std::pair<int, int>> relation;
+    size_t numFacts;
+
+  public:
+    /**
+     * Computes the relation over the CFGBip of the given CFG.
+     *
+     * @param cfg Frozen CFG, with its CFGBip initialised.
+     * @param assignToVarModified Variable modified by each assign statement.
+     * @param readToVarModified Variable modified by each read statement.
+     * @param assignToVarsUsed Variables used by each assign statement using any.
+     * @param isTransitive Whether to compute AffectsBipT instead of AffectsBip.
+     */
+    AffectsBipAnalysis(const Cfg& cfg, const std::unordered_map<int, int>& assignToVarModified,
+      const std::unordered_map<int, int>& readToVarModified,
+      const std::unordered_map<int, std::vector<int>>& assignToVarsUsed, bool isTransitive);
+
+    /**
+     * Returns the pairs of statement numbers satisfying the relation.
+     *
+     * @returns The pairs, each once.
+     */
+    const std::vector<std::pair<int, int>>& getRelation() const;
+
+    /**
+     * Returns the number of variables and facts held on entry to all nodes, summed over both
+     * phases. The facts of a procedure are dropped once it is solved, so this bounds both
+     * the memory and the time taken.
+     *
+     * @returns Number of variables and facts held.
+     */
+    size_t getNumFacts() const;
+  };
+}
@@ -0,0 +1,132 @@
+#include "AffectsSearch.h"
+
+#include <assert.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "Cfg.h"
+
+namespace {
+  /**
+   * Checks if a variable is among the given variables.
+   *
+   * @param vars Variables to look in.
+   * @param var Variable of interest.
+   * @returns `true` if it is among them, `false` otherwise.
+   */
+  bool contains(const std::vector<int>& vars, const int var) {
+    return std::find(vars.begin(), vars.end(), var) != vars.end();
+  }
+}
+
+namespace Cfg {
+  AffectsSearch::AffectsSearch() {
+  }
+
+  AffectsSearch::AffectsSearch(const int maxStmt, const std::unordered_set<int>& assignStmts,
+    const std::unordered_map<int, std::vector<int>>& stmtToVarsModified,
+    const std::unordered_map<int, std::vector<int>>& stmtToVarsUsed) {
+    isAssign.assign(maxStmt + 1, false);
+    varsModified.resize(maxStmt + 1);
+    varsUsed.resize(maxStmt + 1);
+    for (const int stmt : assignStmts) {
+      isAssign[stmt] = true;
+    }
+    for (const std::pair<const int, std::vector<int>>& stmtAndVars : stmtToVarsModified) {
+      varsModified[stmtAndVars.first] = stmtAndVars.second;
+    }
+    for (const std::pair<const int, std::vector<int>>& stmtAndVars : stmtToVarsUsed) {
+      if (isAssignStmt(stmtAndVars.first)) {
+        varsUsed[stmtAndVars.first] = stmtAndVars.second;
+      }
+    }
+  }
+
+  bool AffectsSearch::isAssignStmt(int stmt) const {
+    return stmt >= 1 && (size_t)stmt < isAssign.size() && isAssign[stmt];
+  }
+
+  std::vector<int> AffectsSearch::getAffected(const Cfg& cfg, int stmt) const {
+    std::vector<int> affected;
+    if (!isAssignStmt(stmt)) {
+      return affected;
+    }
+
+    assert(varsModified[stmt].size() == 1);
+    const int var = varsModified[stmt][0];
+    std::vector<bool> isVisited(isAssign.size(), false);
+    std::vector<int> visited;
+    for (const int next : cfg.getNeighbours(stmt)) {
+      if (next > 0 && (size_t)next < isVisited.size() && !isVisited[next]) {
+        isVisited[next] = true;
+        visited.push_back(next);
+      }
+    }
+    for (size_t i = 0; i < visited.size(); i++) {
+      const int current = visited[i];
+      if (isAssign[current] && contains(varsUsed[current], var)) {
+        affected.push_back(current);
+      }
+      if (contains(varsModified[current], var)) {
+        continue;
+      }
+      for (const int next : cfg.getNeighbours(current)) {
+        if (next > 0 && (size_t)next < isVisited.size() && !isVisited[next]) {
+          isVisited[next] = true;
+          visited.push_back(next);
+        }
+      }
+    }
+
+    std::sort(affected.begin(), affected.end());
+    return affected;
+  }
+
+  std::vector<int> AffectsSearch::getAffecters(const Cfg& cfg, int stmt) const {
+    std::vector<int> affecters;
+    if (!isAssignStmt(stmt)) {
+      return affecters;
+    }
+
+    // One visited array serves the search for every variable used, reset through the
+    // statements visited rather than reallocated
+    std::vector<bool> isVisited(isAssign.size(), false);
+    std::vector<int> visited;
+    for (const int var : varsUsed[stmt]) {
+      for (const int current : visited) {
+        isVisited[current] = false;
+      }
+      visited.clear();
+
+      for (const int prev : cfg.getPredecessors(stmt)) {
+        if ((size_t)prev < isVisited.size() && !isVisited[prev]) {
+          isVisited[prev] = true;
+          visited.push_back(prev);
+        }
+      }
+      for (size_t i = 0; i < visited.size(); i++) {
+        const int current = visited[i];
+        if (contains(varsModified[current], var)) {
+          if (isAssign[current]) {
+            affecters.push_back(current);
+          }
+          continue;
+        }
+        for (const int prev : cfg.getPredecessors(current)) {
+          if ((size_t)prev < isVisited.size() && !isVisited[prev]) {
+            isVisited[prev] = true;
+            visited.push_back(prev);
+          }
+        }
+      }
+    }
+
+    // An assign statement modifies a single variable, so only its search finds it
+    std::sort(affecters.begin(), affecters.end());
+    return affecters;
+  }
+}
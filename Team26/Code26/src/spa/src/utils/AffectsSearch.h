@@ -0,0 +1,73 @@
+#pragma once
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "Cfg.h"
+
+namespace Cfg {
+  /**
+   * Answers Affects(a, _) and Affects(_, a') for a single assign statement by searching the
+   * CFG from it, without computing the relation for the whole program.
+   *
+   * Affects(a, a') holds when a' uses the variable v modified by a, and some path from a to
+   * a' does not pass through a statement modifying v in between. The search from a walks the
+   * successors of every statement until v is modified; the search from a' walks the
+   * predecessors of every statement, for each variable used by a', until it is modified.
+   */
+  class AffectsSearch {
+  private:
+    // Indexed by statement number. Container statements modify no variable here, as they
+    // never kill a definition.
+    std::vector<bool> isAssign;
+    std::vector<std::vector<int>> varsModified;
+    std::vector<std::vector<int>> varsUsed;
+
+    /**
+     * Checks if a number is an assign statement.
+     *
+     * @param stmt Number of interest.
+     * @returns `true` if it is an assign statement, `false` otherwise.
+     */
+    bool isAssignStmt(int stmt) const;
+
+  public:
+    /**
+     * Constructs a search with no statements.
+     */
+    AffectsSearch();
+
+    /**
+     * Indexes the statements of a program for searching.
+     *
+     * @param maxStmt Largest statement number of the program.
+     * @param assignStmts Statement numbers of all assign statements.
+     * @param stmtToVarsModified Variables modified by each statement other than containers.
+     * @param stmtToVarsUsed Variables used by each assign statement.
+     */
+    AffectsSearch(const int maxStmt, const std::unordered_set<int>& assignStmts,
+      const std::unordered_map<int, std::vector<int>>& stmtToVarsModified,
+      const std::unordered_map<int, std::vector<int>>& stmtToVarsUsed);
+
+    /**
+     * Finds the statements a' such that Affects(a, a') holds, searching forwards from a.
+     *
+     * @param cfg Frozen CFG of the program.
+     * @param stmt Statement number of a.
+     * @returns Statement numbers of all a', in ascending order. Empty if a is not an
+     *     assign statement.
+     */
+    std::vector<int> getAffected(const Cfg& cfg, int stmt) const;
+
+    /**
+     * Finds the statements a such that Affects(a, a') holds, searching backwards from a'.
+     *
+     * @param cfg Frozen CFG of the program.
+     * @param stmt Statement number of a'.
+     * @returns Statement numbers of all a, in ascending order. Empty if a' is not an
+     *     assign statement.
+     */
+    std::vector<int> getAffecters(const Cfg& cfg, int stmt) const;
+  };
+}
@@ -0,0 +1,250 @@
+#include "BipReachability.h"
+
+#include <assert.h>
+
+#include <unordered_map>
+#include <vector>
+
+#include "BitVector.h"
+#include "Cfg.h"
+#include "CondensedGraph.h"
+#include "Graph.h"
+
+namespace Cfg {
+  BipReachability::BipReachability() {
+  }
+
+  BipReachability::BipReachability(const Cfg& cfg) {
+    const CfgBip& cfgBip = cfg.getCfgBip();
+    const std::vector<ProcedureBip>& procedureBips = cfgBip.getProcedureBips();
+    const size_t numProcs = procedureBips.size();
+
+    // Number the statements densely. The statements of a procedure come before its dummy end
+    // node in the arena, so their position in the procedure is their local index.
+    localToIndex.resize(numProcs);
+    localToCalledProc.resize(numProcs);
+    for (size_t proc = 0; proc < numProcs; proc++) {
+      const ProcedureBip& procedureBip = procedureBips[proc];
+      for (BipIndex local = 0; local < procedureBip.numNodes; local++) {
+        const BipNode& node = cfgBip.getNode(procedureBip.firstNode + local);
+        if (node.node < 0) {
+          continue;
+        }
+        stmtToIndex.emplace(node.node, indexToStmt.size());
+        indexToProc.push_back(proc);
+        indexToLocal.push_back(local);
+        localToIndex[proc].push_back(indexToStmt.size());
+        localToCalledProc[proc].push_back(node.calledProc);
+        indexToStmt.push_back(node.node);
+      }
+    }
+    const size_t numStmts = indexToStmt.size();
+
+    // Number the basic blocks of each procedure densely. Statements are in ascending order,
+    // so the statements of a block are consecutive locals.
+    localToBlock.resize(numProcs);
+    blockToFirstLocal.resize(numProcs);
+    blockPrevs.resize(numProcs);
+    std::vector<int> cfgBlockToBlock(cfg.getNumBlocks());
+    for (size_t proc = 0; proc < numProcs; proc++) {
+      std::vector<int> blockToCfgBlock;
+      for (size_t local = 0; local < localToIndex[proc].size(); local++) {
+        const int cfgBlock = cfg.getBlock(indexToStmt[localToIndex[proc][local]]);
+        if (blockToCfgBlock.empty() || blockToCfgBlock.back() != cfgBlock) {
+          cfgBlockToBlock[cfgBlock] = blockToCfgBlock.size();
+          blockToCfgBlock.push_back(cfgBlock);
+          blockToFirstLocal[proc].push_back(local);
+        }
+        localToBlock[proc].push_back(blockToCfgBlock.size() - 1);
+      }
+      blockToFirstLocal[proc].push_back(localToIndex[proc].size());
+
+      // Condense the intraprocedural graph of the procedure, over its blocks
+      std::vector<std::vector<int>> successors(blockToCfgBlock.size());
+      for (size_t block = 0; block < blockToCfgBlock.size(); block++) {
+        for (const int nextCfgBlock : cfg.getBlockNexts(blockToCfgBlock[block])) {
+          successors[block].push_back(cfgBlockToBlock[nextCfgBlock]);
+        }
+      }
+      graphs.emplace_back(Graph(successors));
+
+      // Blocks are entered at their first statement only
+      const ProcedureBip& procedureBip = procedureBips[proc];
+      blockPrevs[proc].resize(blockToCfgBlock.size());
+      for (size_t block = 0; block < blockToCfgBlock.size(); block++) {
+        for (const BipIndex prev : cfgBip.getPrevs(procedureBip.firstNode + blockToFirstLocal[proc][block])) {
+          blockPrevs[proc][block].push_back(localToBlock[proc][prev - procedureBip.firstNode]);
+        }
+      }
+    }
+
+    callerIndices.resize(numProcs);
+    for (size_t proc = 0; proc < numProcs; proc++) {
+      for (const BipIndex caller : procedureBips[proc].callers) {
+        callerIndices[proc].push_back(stmtToIndex.at(cfgBip.getNode(caller).node));
+      }
+    }
+
+    // Statements executed by a call to each procedure, callees first
+    bodies.assign(numProcs, BitVector(numStmts));
+    for (size_t proc = numProcs; proc-- > 0;) {
+      addLocals(proc, 0, localToIndex[proc].size(), bodies[proc]);
+    }
+
+    // Statements reachable after each procedure returns, callers first
+    continuations.assign(numProcs, BitVector(numStmts));
+    for (size_t proc = 0; proc < numProcs; proc++) {
+      std::vector<BitVector> reachable;
+      for (size_t local = 0; local < localToIndex[proc].size(); local++) {
+        const int calledProc = localToCalledProc[proc][local];
+        if (calledProc == -1) {
+          continue;
+        }
+        if (reachable.empty()) {
+          reachable = graphs[proc].getReachableNodes();
+        }
+        const int block = localToBlock[proc][local];
+        continuations[calledProc].unionWith(expand(proc, reachable[graphs[proc].getComponent(block)]));
+        addLocals(proc, local + 1, blockToFirstLocal[proc][block + 1], continuations[calledProc]);
+        continuations[calledProc].unionWith(continuations[proc]);
+      }
+    }
+  }
+
+  void BipReachability::addLocals(int proc, size_t firstLocal, size_t endLocal, BitVector& reachable) const {
+    for (size_t local = firstLocal; local < endLocal; local++) {
+      reachable.set(localToIndex[proc][local]);
+      const int calledProc = localToCalledProc[proc][local];
+      if (calledProc != -1) {
+        reachable.unionWith(bodies[calledProc]);
+      }
+    }
+  }
+
+  BitVector BipReachability::expand(int proc, const BitVector& reachableBlocks) const {
+    BitVector reachable(indexToStmt.size());
+    reachableBlocks.forEachSetBit([&](size_t block) {
+      addLocals(proc, blockToFirstLocal[proc][block], blockToFirstLocal[proc][block + 1], reachable);
+    });
+    return reachable;
+  }
+
+  std::vector<int> BipReachability::getReachableStmts(int stmt) const {
+    std::vector<int> stmts;
+    if (stmtToIndex.count(stmt) == 0) {
+      return stmts;
+    }
+
+    const int index = stmtToIndex.at(stmt);
+    const int proc = indexToProc[index];
+    const int local = indexToLocal[index];
+    const int block = localToBlock[proc][local];
+
+    // The statements after s in its block, those reachable from its block, and the body of
+    // the call at s
+    BitVector reachable = expand(proc, graphs[proc].getReachableNodes(block));
+    addLocals(proc, local + 1, blockToFirstLocal[proc][block + 1], reachable);
+    const int calledProc = localToCalledProc[proc][local];
+    if (calledProc != -1) {
+      reachable.unionWith(bodies[calledProc]);
+    }
+    reachable.unionWith(continuations[proc]);
+
+    reachable.forEachSetBit([&](size_t reachedIndex) {
+      stmts.push_back(indexToStmt[reachedIndex]);
+    });
+    return stmts;
+  }
+
+  void BipReachability::addReaching(int proc, const std::vector<int>& targetLocals, BitVector& reaching) const {
+    const std::vector<size_t>& firstLocals = blockToFirstLocal[proc];
+    std::vector<bool> isVisited(firstLocals.size() - 1, false);
+    std::vector<int> visitedBlocks;
+    for (const int local : targetLocals) {
+      const int block = localToBlock[proc][local];
+      for (size_t prevLocal = firstLocals[block]; prevLocal < (size_t)local; prevLocal++) {
+        reaching.set(localToIndex[proc][prevLocal]);
+      }
+      visitedBlocks.push_back(block);
+    }
+
+    // The targets' own blocks are only reaching if they are reached again
+    const size_t numTargetBlocks = visitedBlocks.size();
+    for (size_t i = 0; i < visitedBlocks.size(); i++) {
+      if (i >= numTargetBlocks) {
+        const int block = visitedBlocks[i];
+        for (size_t local = firstLocals[block]; local < firstLocals[block + 1]; local++) {
+          reaching.set(localToIndex[proc][local]);
+        }
+      }
+      for (const int prevBlock : blockPrevs[proc][visitedBlocks[i]]) {
+        if (!isVisited[prevBlock]) {
+          isVisited[prevBlock] = true;
+          visitedBlocks.push_back(prevBlock);
+        }
+      }
+    }
+  }
+
+  std::vector<int> BipReachability::getReachingStmts(int stmt) const {
+    std::vector<int> stmts;
+    if (stmtToIndex.count(stmt) == 0) {
+      return stmts;
+    }
+
+    const int index = stmtToIndex.at(stmt);
+    const size_t numProcs = graphs.size();
+
+    // Procedures whose body executes s': its own, and those calling it, transitively
+    std::vector<bool> isExecuting(numProcs, false);
+    std::vector<int> executingProcs{ indexToProc[index] };
+    isExecuting[indexToProc[index]] = true;
+    for (size_t i = 0; i < executingProcs.size(); i++) {
+      for (const int caller : callerIndices[executingProcs[i]]) {
+        const int callerProc = indexToProc[caller];
+        if (!isExecuting[callerProc]) {
+          isExecuting[callerProc] = true;
+          executingProcs.push_back(callerProc);
+        }
+      }
+    }
+
+    // Statements reaching s', or a call executing it, within their procedure. Such a call
+    // reaches s' itself.
+    BitVector reaching(indexToStmt.size());
+    std::vector<std::vector<int>> targetLocals(numProcs);
+    targetLocals[indexToProc[index]].push_back(indexToLocal[index]);
+    BitVector executingCalls(indexToStmt.size());
+    for (const int proc : executingProcs) {
+      for (const int caller : callerIndices[proc]) {
+        targetLocals[indexToProc[caller]].push_back(indexToLocal[caller]);
+        executingCalls.set(caller);
+      }
+    }
+    for (size_t proc = 0; proc < numProcs; proc++) {
+      if (!targetLocals[proc].empty()) {
+        addReaching(proc, targetLocals[proc], reaching);
+      }
+    }
+
+    // Every statement of a procedure reaches s' if s' is reachable after the procedure
+    // returns, i.e. after one of its call sites. Callers come first.
+    std::vector<bool> isContinuing(numProcs, false);
+    for (size_t proc = 0; proc < numProcs; proc++) {
+      for (const int caller : callerIndices[proc]) {
+        isContinuing[proc] = isContinuing[proc] || reaching.test(caller) || isContinuing[indexToProc[caller]];
+      }
+      if (isContinuing[proc]) {
+        for (const int procIndex : localToIndex[proc]) {
+          reaching.set(procIndex);
+        }
+      }
+    }
+    reaching.unionWith(executingCalls);
+
+    reaching.forEachSetBit([&](size_t reachingIndex) {
+      stmts.push_back(indexToStmt[reachingIndex]);
+    });
+    return stmts;
+  }
+}
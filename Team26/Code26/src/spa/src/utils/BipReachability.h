@@ -0,0 +1,156 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "BitVector.h"
+#include "Cfg.h"
+#include "CondensedGraph.h"
+
+namespace Cfg {
+  /**
+   * Answers NextBip*(s, _) over the graphs of all procedures in the CFGBip.
+   *
+   * The graph of each procedure is taken over its basic blocks and condensed into its SCCs,
+   * so that every loop is a single component, and each procedure is summarised once:
+   *   1) The statements executed by a call to it (its own statements and those of the
+   *      procedures it calls), computed callees first.
+   *   2) The statements reachable after it returns, taken over all of its call sites,
+   *      computed callers first.
+   * NextBip*(s, _) is then the statements after s in its block, the statements of the
+   * blocks reachable from the block of s in the condensed graph of its procedure, the
+   * statements executed by every call among them and by a call at s, and the statements
+   * reachable after the procedure of s returns.
+   *
+   * NextBip*(_, s') is found by searching backwards instead: from s' and from every call
+   * executing the procedure of s' over the reversed block graphs, and then through the
+   * procedures whose continuation holds s'.
+   */
+  class BipReachability {
+  private:
+    // Statements numbered densely, procedure by procedure.
+    std::vector<int> indexToStmt;
+    std::unordered_map<int, int> stmtToIndex;
+
+    // Procedure of each statement index, and the position of the statement in it.
+    std::vector<int> indexToProc;
+    std::vector<int> indexToLocal;
+
+    // For each procedure, the statement index and the called procedure (-1 if none)
+    // of each of its statements.
+    std::vector<std::vector<int>> localToIndex;
+    std::vector<std::vector<int>> localToCalledProc;
+
+    // For each procedure, the basic block of each of its statements, and the first
+    // statement of each of its blocks followed by the number of its statements.
+    std::vector<std::vector<int>> localToBlock;
+    std::vector<std::vector<size_t>> blockToFirstLocal;
+
+    // Condensed intraprocedural graph of each procedure, over its blocks, and the
+    // predecessors of each of its blocks.
+    std::vector<CondensedGraph> graphs;
+    std::vector<std::vector<std::vector<int>>> blockPrevs;
+
+    // Statement index of each call statement calling each procedure.
+    std::vector<std::vector<int>> callerIndices;
+
+    // Statements executed by a call to each procedure.
+    std::vector<BitVector> bodies;
+
+    // Statements reachable after each procedure returns.
+    std::vector<BitVector> continuations;
+
+    /**
+     * Adds a range of statements of a procedure and the statements executed by the calls
+     * among them.
+     *
+     * @param proc Procedure of interest.
+     * @param firstLocal Position of the first statement in the procedure.
+     * @param endLocal Position after the last statement in the procedure.
+     * @param reachable Bit vector over all statements to add to.
+     */
+    void addLocals(int proc, size_t firstLocal, size_t endLocal, BitVector& reachable) const;
+
+    /**
+     * Maps blocks reachable within a procedure to all statements they lead to, by adding
+     * the statements executed by the calls among them.
+     *
+     * @param proc Procedure of interest.
+     * @param reachableBlocks Bit vector over the blocks of the procedure.
+     * @returns Bit vector over all statements.
+     */
+    BitVector expand(int proc, const BitVector& reachableBlocks) const;
+
+    /**
+     * Adds the statements of a procedure from which any of the given statements is reached
+     * by at least one intraprocedural edge, searching the blocks backwards.
+     *
+     * @param proc Procedure of interest.
+     * @param targetLocals Positions of the statements to reach in the procedure.
+     * @param reaching Bit vector over all statements to add to.
+     */
+    void addReaching(int proc, const std::vector<int>& targetLocals, BitVector& reaching) const;
+
+  public:
+    /**
+     * Constructs an index with no statements.
+     */
+    BipReachability();
+
+    /**
+     * Summarises the CFGBip of the given CFG.
+     *
+     * @param cfg Frozen CFG, with its CFGBip initialised.
+     */
+    BipReachability(const Cfg& cfg);
+
+    /**
+     * Finds the statements s' such that NextBip*(s, s') holds, traversing the condensed
+     * graph from the block of s only.
+     *
+     * @param stmt Statement number of s.
+     * @returns Statement numbers of all s'. Empty if s is not a statement.
+     */
+    std::vector<int> getReachableStmts(int stmt) const;
+
+    /**
+     * Finds the statements s such that NextBip*(s, s') holds, searching backwards from s'
+     * only.
+     *
+     * @param stmt Statement number of s'.
+     * @returns Statement numbers of all s. Empty if s' is not a statement.
+     */
+    std::vector<int> getReachingStmts(int stmt) const;
+
+    /**
+     * Calls the given function on every pair (s, s') such that NextBip*(s, s') holds,
+     * computing the reachable blocks of every component in a single pass over the
+     * condensed graph of each procedure. Each block is walked from its last statement, so
+     * that the statements after s in its block are accumulated rather than recomputed.
+     *
+     * @param fn Function taking the statement numbers of s and s'.
+     */
+    template <typename Function>
+    void forEachReachable(Function fn) const {
+      for (size_t proc = 0; proc < graphs.size(); proc++) {
+        const std::vector<BitVector>& reachable = graphs[proc].getReachableNodes();
+        for (size_t block = 0; block + 1 < blockToFirstLocal[proc].size(); block++) {
+          BitVector stmts = expand(proc, reachable[graphs[proc].getComponent(block)]);
+          stmts.unionWith(continuations[proc]);
+          for (size_t local = blockToFirstLocal[proc][block + 1]; local-- > blockToFirstLocal[proc][block];) {
+            const int index = localToIndex[proc][local];
+            const int calledProc = localToCalledProc[proc][local];
+            if (calledProc != -1) {
+              stmts.unionWith(bodies[calledProc]);
+            }
+            const int stmt = indexToStmt[index];
+            stmts.forEachSetBit([&](size_t reachedIndex) {
+              fn(stmt, indexToStmt[reachedIndex]);
+            });
+            stmts.set(index);
+          }
+        }
+      }
+    }
+  };
+}
@@ -0,0 +1,104 @@
+#include "BitVector.h"
+
+#include <assert.h>
+#include <stdint.h>
+
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+size_t BitVector::lowestSetBit(uint64_t word) {
+  assert(word != 0);
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward64(&index, word);
+  return index;
+#else
+  return __builtin_ctzll(word);
+#endif
+}
+
+BitVector::BitVector(size_t numBits)
+  : words((numBits + 63) / 64, 0), numBits(numBits) {
+}
+
+size_t BitVector::size() const {
+  return numBits;
+}
+
+void BitVector::set(size_t bit) {
+  assert(bit < numBits);
+  words[bit / 64] |= uint64_t(1) << (bit % 64);
+}
+
+void BitVector::reset(size_t bit) {
+  assert(bit < numBits);
+  words[bit / 64] &= ~(uint64_t(1) << (bit % 64));
+}
+
+bool BitVector::test(size_t bit) const {
+  assert(bit < numBits);
+  return (words[bit / 64] >> (bit % 64)) & 1;
+}
+
+bool BitVector::none() const {
+  for (const uint64_t word : words) {
+    if (word != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool BitVector::unionWith(const BitVector& other) {
+  assert(numBits == other.numBits);
+  bool isChanged = false;
+  for (size_t i = 0; i < words.size(); i++) {
+    const uint64_t merged = words[i] | other.words[i];
+    isChanged = isChanged || (merged != words[i]);
+    words[i] = merged;
+  }
+  return isChanged;
+}
+
+void BitVector::intersectWith(const BitVector& other) {
+  assert(numBits == other.numBits);
+  for (size_t i = 0; i < words.size(); i++) {
+    words[i] &= other.words[i];
+  }
+}
+
+void BitVector::subtract(const BitVector& other) {
+  assert(numBits == other.numBits);
+  for (size_t i = 0; i < words.size(); i++) {
+    words[i] &= ~other.words[i];
+  }
+}
+
+bool BitVector::intersects(const BitVector& other) const {
+  assert(numBits == other.numBits);
+  for (size_t i = 0; i < words.size(); i++) {
+    if ((words[i] & other.words[i]) != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::vector<size_t> BitVector::getSetBits() const {
+  std::vector<size_t> setBits;
+  forEachSetBit([&setBits](size_t bit) {
+    setBits.push_back(bit);
+  });
+  return setBits;
+}
+
+bool BitVector::operator==(const BitVector& other) const {
+  return numBits == other.numBits && words == other.words;
+}
+
+bool BitVector::operator!=(const BitVector& other) const {
+  return !(*this == other);
+}
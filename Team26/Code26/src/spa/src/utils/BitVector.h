@@ -0,0 +1,127 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+class BitVector {
+private:
+  // Bits are packed into 64-bit words, lowest bit first.
+  std::vector<uint64_t> words;
+
+  // Number of bits in the vector.
+  size_t numBits;
+
+  /**
+   * Returns the index of the lowest set bit of a non-zero word.
+   *
+   * @param word Non-zero word to scan.
+   * @returns Index of the lowest set bit.
+   */
+  static size_t lowestSetBit(uint64_t word);
+
+public:
+  /**
+   * Constructs a bit vector of the given size with all bits cleared.
+   *
+   * @param numBits Number of bits in the vector.
+   */
+  BitVector(size_t numBits = 0);
+
+  /**
+   * Returns the number of bits in the vector.
+   *
+   * @returns Number of bits in the vector.
+   */
+  size_t size() const;
+
+  /**
+   * Sets the given bit.
+   *
+   * @param bit Index of the bit to set.
+   */
+  void set(size_t bit);
+
+  /**
+   * Clears the given bit.
+   *
+   * @param bit Index of the bit to clear.
+   */
+  void reset(size_t bit);
+
+  /**
+   * Checks if the given bit is set.
+   *
+   * @param bit Index of the bit to check.
+   * @returns `true` if the bit is set, `false` otherwise.
+   */
+  bool test(size_t bit) const;
+
+  /**
+   * Checks if no bits are set.
+   *
+   * @returns `true` if no bits are set, `false` otherwise.
+   */
+  bool none() const;
+
+  /**
+   * Performs this := this OR other.
+   * Both vectors must be of the same size.
+   *
+   * @param other The vector to union with.
+   * @returns `true` if any bit of this vector changed, `false` otherwise.
+   */
+  bool unionWith(const BitVector& other);
+
+  /**
+   * Performs this := this AND other.
+   * Both vectors must be of the same size.
+   *
+   * @param other The vector to intersect with.
+   */
+  void intersectWith(const BitVector& other);
+
+  /**
+   * Performs this := this AND NOT other.
+   * Both vectors must be of the same size.
+   *
+   * @param other The vector whose bits are to be cleared.
+   */
+  void subtract(const BitVector& other);
+
+  /**
+   * Checks if this vector shares any set bit with the other vector.
+   * Both vectors must be of the same size.
+   *
+   * @param other The vector to check against.
+   * @returns `true` if some bit is set in both vectors, `false` otherwise.
+   */
+  bool intersects(const BitVector& other) const;
+
+  /**
+   * Returns the indices of all set bits in ascending order.
+   *
+   * @returns Indices of all set bits.
+   */
+  std::vector<size_t> getSetBits() const;
+
+  /**
+   * Calls the given function on the index of every set bit in ascending order.
+   *
+   * @param fn Function taking the index of a set bit.
+   */
+  template <typename Function>
+  void forEachSetBit(Function fn) const {
+    for (size_t w = 0; w < words.size(); w++) {
+      uint64_t word = words[w];
+      while (word != 0) {
+        fn(w * 64 + lowestSetBit(word));
+        word &= word - 1; // clear lowest set bit
+      }
+    }
+  }
+
+  bool operator==(const BitVector& other) const;
+  bool operator!=(const BitVector& other) const;
+};
@@ -2,130 +2,295 @@
 
 #include <assert.h>
 
-#include <memory>
-#include <stack>
+#include <algorithm>
+#include <cstdlib>
+#include <list>
+#include <string>
 #include <unordered_map>
-#include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include "BitVector.h"
+#include "Span.h"
+
+namespace {
+  /**
+   * Lays out the given edges as compressed sparse rows grouped by one of their endpoints,
+   * keeping the order in which the edges were added within each row.
+   *
+   * @param numSlots Number of rows.
+   * @param keySlots Row of each edge.
+   * @param values Value stored for each edge.
+   * @param offsets Filled with the start of each row, followed by the number of edges.
+   * @param rows Filled with the values of the edges, row by row.
+   */
+  void layOutRows(size_t numSlots, const std::vector<int>& keySlots, const std::vector<int>& values,
+    std::vector<int>& offsets, std::vector<int>& rows) {
+    offsets.assign(numSlots + 1, 0);
+    for (const int slot : keySlots) {
+      offsets[slot + 1]++;
+    }
+    for (size_t slot = 0; slot < numSlots; slot++) {
+      offsets[slot + 1] += offsets[slot];
+    }
+
+    std::vector<int> nextPosition(offsets.begin(), offsets.end() - 1);
+    rows.assign(values.size(), 0);
+    for (size_t i = 0; i < values.size(); i++) {
+      rows[nextPosition[keySlots[i]]++] = values[i];
+    }
+  }
+}
+
 namespace Cfg {
   void Cfg::addEdge(const int from, const int to) {
-    if (adjLst.count(from) == 0) {
-      adjLst.emplace(from, std::vector<int>{ to });
-    } else {
-      adjLst.at(from).emplace_back(to);
+    edges.emplace_back(from, to);
+    isFrozenFlag = false;
+  }
+
+  void Cfg::freeze() {
+    if (isFrozenFlag) {
+      return;
+    }
+
+    maxStmt = 0;
+    for (const std::pair<int, int>& edge : edges) {
+      maxStmt = std::max(maxStmt, std::max(std::abs(edge.first), std::abs(edge.second)));
+    }
+    isFrozenFlag = true;
+
+    std::vector<int> fromSlots, toSlots, froms, tos;
+    for (const std::pair<int, int>& edge : edges) {
+      fromSlots.push_back(getSlot(edge.first));
+      toSlots.push_back(getSlot(edge.second));
+      froms.push_back(edge.first);
+      tos.push_back(edge.second);
+    }
+    const size_t numSlots = 2 * maxStmt + 1;
+    layOutRows(numSlots, fromSlots, tos, nextOffsets, nexts);
+    layOutRows(numSlots, toSlots, froms, prevOffsets, prevs);
+    formBasicBlocks();
+  }
+
+  void Cfg::formBasicBlocks() {
+    // Statement s falls through into s + 1 when that is its only successor and s is the
+    // only predecessor of s + 1
+    stmtToBlock.assign(maxStmt + 1, -1);
+    blockFirstStmts.clear();
+    for (int stmt = 1; stmt <= maxStmt; stmt++) {
+      const Span<int> prevNexts = getNeighbours(stmt - 1);
+      const bool isFallThrough = stmt > 1 && prevNexts.size() == 1 && prevNexts[0] == stmt &&
+        getPredecessors(stmt).size() == 1;
+      if (!isFallThrough) {
+        blockFirstStmts.push_back(stmt);
+      }
+      stmtToBlock[stmt] = blockFirstStmts.size() - 1;
+    }
+    const size_t numBlocks = blockFirstStmts.size();
+    blockFirstStmts.push_back(maxStmt + 1);
+
+    // Blocks are left from their last statement and entered at their first
+    std::vector<int> fromBlocks, toBlocks;
+    for (size_t block = 0; block < numBlocks; block++) {
+      for (const int nextStmt : getNeighbours(getBlockLastStmt(block))) {
+        if (nextStmt > 0) {
+          fromBlocks.push_back(block);
+          toBlocks.push_back(stmtToBlock[nextStmt]);
+        }
+      }
+    }
+    layOutRows(numBlocks, fromBlocks, toBlocks, blockNextOffsets, blockNexts);
+    layOutRows(numBlocks, toBlocks, fromBlocks, blockPrevOffsets, blockPrevs);
+  }
+
+  bool Cfg::isFrozen() const {
+    return isFrozenFlag;
+  }
+
+  int Cfg::getSlot(const int node) const {
+    if (node == 0 || node > maxStmt || node < -maxStmt) {
+      return -1;
     }
+    return node > 0 ? node : maxStmt - node;
   }
 
-  std::vector<int> Cfg::getNeighbours(const int node) const {
-    if (adjLst.count(node) == 0) {
-      return {};
+  Span<int> Cfg::getNeighbours(const int node) const {
+    assert(isFrozenFlag);
+    const int slot = getSlot(node);
+    if (slot == -1) {
+      return Span<int>();
     }
-    return adjLst.at(node);
+    return Span<int>(nexts.data() + nextOffsets[slot], nexts.data() + nextOffsets[slot + 1]);
+  }
+
+  Span<int> Cfg::getPredecessors(const int node) const {
+    assert(isFrozenFlag);
+    const int slot = getSlot(node);
+    if (slot == -1) {
+      return Span<int>();
+    }
+    return Span<int>(prevs.data() + prevOffsets[slot], prevs.data() + prevOffsets[slot + 1]);
+  }
+
+  size_t Cfg::getNumSlots() const {
+    return nextOffsets.empty() ? 0 : nextOffsets.size() - 1;
+  }
+
+  size_t Cfg::getNumBlocks() const {
+    assert(isFrozenFlag);
+    return blockFirstStmts.empty() ? 0 : blockFirstStmts.size() - 1;
+  }
+
+  int Cfg::getBlock(const int stmt) const {
+    assert(isFrozenFlag);
+    if (stmt <= 0 || stmt > maxStmt) {
+      return -1;
+    }
+    return stmtToBlock[stmt];
+  }
+
+  int Cfg::getBlockFirstStmt(const int block) const {
+    assert(block >= 0 && (size_t)block < getNumBlocks());
+    return blockFirstStmts[block];
+  }
+
+  int Cfg::getBlockLastStmt(const int block) const {
+    assert(block >= 0 && (size_t)block < getNumBlocks());
+    return blockFirstStmts[block + 1] - 1;
+  }
+
+  Span<int> Cfg::getBlockNexts(const int block) const {
+    assert(block >= 0 && (size_t)block < getNumBlocks());
+    return Span<int>(blockNexts.data() + blockNextOffsets[block], blockNexts.data() + blockNextOffsets[block + 1]);
+  }
+
+  Span<int> Cfg::getBlockPrevs(const int block) const {
+    assert(block >= 0 && (size_t)block < getNumBlocks());
+    return Span<int>(blockPrevs.data() + blockPrevOffsets[block], blockPrevs.data() + blockPrevOffsets[block + 1]);
   }
 
   void Cfg::initialiseCfgBip(
     const std::list<std::string>& topoProc,
     const std::unordered_map<std::string, int>& procStartMapper,
-    const std::unordered_map<std::string, std::vector<int>>& procEndMapper,
     const std::unordered_map<int, std::string>& callStmtToProcMapper) {
+    assert(isFrozenFlag);
+    cfgBip = CfgBip(*this, topoProc, procStartMapper, callStmtToProcMapper);
+  }
 
-    // For each procedure, generate the graph and store the procStartNode
-    std::unordered_set<std::string> visitedProcs;
+  const CfgBip& Cfg::getCfgBip() const {
+    return cfgBip;
+  }
 
+  CfgBip::CfgBip() {
+  }
+
+  CfgBip::CfgBip(
+    const Cfg& cfg,
+    const std::list<std::string>& topoProc,
+    const std::unordered_map<std::string, int>& procStartMapper,
+    const std::unordered_map<int, std::string>& callStmtToProcMapper) {
+    std::unordered_map<std::string, int> procToIndex;
     for (const std::string& procName : topoProc) {
-      if (visitedProcs.count(procName) == 1) {
-        continue;
-      }
-      visitedProcs.emplace(procName);
-
-      CfgBipStartEnd& procStartEnd = createProcedureCfg(procName, procStartMapper);
-      std::shared_ptr<BipNode>& startPtr = procStartEnd.start;
-      startNodes.emplace_back(startPtr); // store the procStartNodes
-
-      std::unordered_set<std::shared_ptr<BipNode>> visited;
-      std::stack<std::shared_ptr<BipNode>> stack;
-      stack.push(startPtr); // push startNode to stack
-      visited.emplace(startPtr); // mark startNode as visited
-
-      while (!stack.empty()) {
-        std::shared_ptr<BipNode>& currPtr = stack.top();
-        const int node = currPtr->node;
-        stack.pop();
-
-        // If currNode is a call statement - generate procedure CFG for the called proc
-        if (callStmtToProcMapper.count(node) == 1) {
-          const std::string calledProc = callStmtToProcMapper.at(node);
-          CfgBipStartEnd& calledProcStartEnd = createProcedureCfg(calledProc, procStartMapper);
-          visitedProcs.emplace(calledProc);
-
-          // Add the ptrs from the called proc's end to currNode's nextNodes
-          assert(currPtr->nexts.size() == 1);
-          std::shared_ptr<BipNode>& nextNode = currPtr->nexts[0];
-          calledProcStartEnd.end->nexts.emplace_back(nextNode);
-
-          // Add the ptrs from curr to called proc's start
-          currPtr->nexts.clear();
-          currPtr->nexts.emplace_back(calledProcStartEnd.start);
-        }
+      procToIndex.emplace(procName, procToIndex.size());
+    }
 
-        // Add nextNodes to the stack under certain conditions
-        for (std::shared_ptr<BipNode>& nextPtr : currPtr->nexts) {
-          // Add nextNode to stack only if not visited
-          if (visited.count(nextPtr) == 0) {
-            stack.push(nextPtr);
-            visited.emplace(nextPtr); // mark nextNode as visited
+    // Allocate the nodes reachable from the start of each procedure, procedure by procedure
+    BitVector visited(cfg.getNumSlots());
+    std::vector<BipIndex> slotToIndex(cfg.getNumSlots());
+    for (const std::string& procName : topoProc) {
+      const int startValue = procStartMapper.at(procName);
+      std::vector<int> values{ startValue };
+      visited.set(cfg.getSlot(startValue));
+      for (size_t i = 0; i < values.size(); i++) {
+        for (const int neighbourValue : cfg.getNeighbours(values[i])) {
+          const int neighbourSlot = cfg.getSlot(neighbourValue);
+          if (!visited.test(neighbourSlot)) {
+            visited.set(neighbourSlot);
+            values.push_back(neighbourValue);
           }
         }
       }
-    }
-  }
 
-  CfgBipStartEnd Cfg::createProcedureCfg(const std::string& procName, const std::unordered_map<std::string, int>& procStartMapper) {
-    std::unordered_map<int, std::shared_ptr<BipNode>> valueToNode;
-    std::unordered_set<int> visited;
-    std::stack<int> stack;
+      // Statements in ascending order, followed by the dummy end node
+      std::sort(values.begin(), values.end(), [](const int first, const int second) {
+        if ((first < 0) != (second < 0)) {
+          return second < 0;
+        }
+        return first < second;
+      });
+      assert(values.back() == -startValue);
 
-    const int startValue = procStartMapper.at(procName);
-    std::shared_ptr<BipNode> startNode(new BipNode{ startValue });
-    valueToNode.emplace(startValue, startNode);
-    stack.push(startValue);
-    visited.emplace(startValue);
-    while (!stack.empty()) {
-      const int currentValue = stack.top();
-      std::shared_ptr<BipNode> currentNode = valueToNode.at(currentValue);
-      stack.pop();
+      ProcedureBip procedureBip;
+      procedureBip.procName = procName;
+      procedureBip.firstNode = nodes.size();
+      procedureBip.numNodes = values.size();
+      for (const int value : values) {
+        slotToIndex[cfg.getSlot(value)] = nodes.size();
+        BipNode node;
+        node.node = value;
+        node.proc = procedureBips.size();
+        node.calledProc = -1;
+        if (callStmtToProcMapper.count(value) == 1) {
+          node.calledProc = procToIndex.at(callStmtToProcMapper.at(value));
+        }
+        nodes.push_back(node);
+      }
+      procedureBip.start = slotToIndex[cfg.getSlot(startValue)];
+      procedureBip.end = nodes.size() - 1;
+      procedureBips.push_back(procedureBip);
+    }
 
+    // Lay out the successors, and link each call statement to the procedure it calls
+    nextOffsets.push_back(0);
+    for (BipIndex index = 0; index < nodes.size(); index++) {
+      for (const int neighbourValue : cfg.getNeighbours(nodes[index].node)) {
+        nexts.push_back(slotToIndex[cfg.getSlot(neighbourValue)]);
+      }
+      nextOffsets.push_back(nexts.size());
 
-      // Check if there are neighbours
-      if (adjLst.count(currentValue) == 0) {
-        continue;
+      if (nodes[index].calledProc != -1) {
+        assert(getNexts(index).size() == 1);
+        procedureBips[nodes[index].calledProc].callers.push_back(index);
       }
+    }
 
-      // Push all unvisited neighbours into stack
-      const std::vector<int>& neighbours = adjLst.at(currentValue);
-      for (const int neighbourValue : neighbours) {
-        if (valueToNode.count(neighbourValue) == 0) { // Node not yet created
-          valueToNode.emplace(neighbourValue, new BipNode{ neighbourValue });
-        }
+    // Lay out the predecessors, keeping the order of the nodes within each row
+    prevOffsets.assign(nodes.size() + 1, 0);
+    for (const BipIndex next : nexts) {
+      prevOffsets[next + 1]++;
+    }
+    for (BipIndex index = 0; index < nodes.size(); index++) {
+      prevOffsets[index + 1] += prevOffsets[index];
+    }
+    std::vector<BipIndex> nextPosition(prevOffsets.begin(), prevOffsets.end() - 1);
+    prevs.resize(nexts.size());
+    for (BipIndex index = 0; index < nodes.size(); index++) {
+      for (const BipIndex next : getNexts(index)) {
+        prevs[nextPosition[next]++] = index;
+      }
+    }
+  }
 
-        // Add to currentNode.nexts
-        const std::shared_ptr<BipNode>& neighbourNode = valueToNode.at(neighbourValue);
-        currentNode->nexts.emplace_back(neighbourNode);
+  const std::vector<ProcedureBip>& CfgBip::getProcedureBips() const {
+    return procedureBips;
+  }
 
-        if (visited.count(neighbourValue) == 0) {
-          stack.push(neighbourValue);
-          visited.emplace(neighbourValue);
-        }
+  size_t CfgBip::getNumNodes() const {
+    return nodes.size();
+  }
 
-      }
-    }
+  const BipNode& CfgBip::getNode(const BipIndex index) const {
+    assert(index < nodes.size());
+    return nodes[index];
+  }
 
-    const std::shared_ptr<BipNode>& endNode = valueToNode.at(startValue * -1);
-    return CfgBipStartEnd{ startNode, endNode };
+  Span<BipIndex> CfgBip::getNexts(const BipIndex index) const {
+    assert(index + 1 < nextOffsets.size());
+    return Span<BipIndex>(nexts.data() + nextOffsets[index], nexts.data() + nextOffsets[index + 1]);
   }
 
-  std::vector<std::shared_ptr<BipNode>> Cfg::getStartBipNodes() const {
-    return startNodes;
+  Span<BipIndex> CfgBip::getPrevs(const BipIndex index) const {
+    assert(index + 1 < prevOffsets.size());
+    return Span<BipIndex>(prevs.data() + prevOffsets[index], prevs.data() + prevOffsets[index + 1]);
   }
 }
@@ -1,38 +1,173 @@
 #pragma once
 
-#include <memory>
+#include <stdint.h>
+
+#include <list>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include "Span.h"
+
 namespace Cfg {
+  class Cfg;
+
+  // Position of a node in the arena of the CFGBip.
+  typedef uint32_t BipIndex;
+
   struct BipNode {
     int node;
-    std::vector<std::shared_ptr<BipNode>> nexts;
-    std::vector<std::shared_ptr<BipNode>> affectsNexts;
+
+    // Index of the procedure the node belongs to.
+    int proc;
+
+    // Index of the called procedure if the node is a call statement, -1 otherwise.
+    int calledProc;
   };
 
-  struct CfgBipStartEnd {
-    std::shared_ptr<BipNode> start;
-    std::shared_ptr<BipNode> end;
+  struct ProcedureBip {
+    std::string procName;
+    BipIndex start;
+    BipIndex end;
+
+    // All nodes of the procedure are contiguous in the arena, from firstNode on: statements
+    // in ascending order followed by the dummy end node.
+    BipIndex firstNode;
+    BipIndex numNodes;
+
+    // Call statements (in other procedures) that call this procedure.
+    std::vector<BipIndex> callers;
   };
 
-  class Cfg {
+  /**
+   * Graphs of all procedures in the CFGBip. Each procedure gets a single graph shared by all
+   * of its call sites; calls and returns are matched through ProcedureBip::callers instead of
+   * copying the called procedure into every call site.
+   *
+   * The nodes of all graphs are allocated from one arena and addressed by their index in it.
+   * Intraprocedural successors and predecessors are stored as compressed sparse rows; the
+   * only successor of a call statement is its return site.
+   */
+  class CfgBip {
   private:
-    std::unordered_map<int, std::vector<int>> adjLst;
-    std::vector<std::shared_ptr<BipNode>> startNodes;
+    std::vector<BipNode> nodes;
+    std::vector<BipIndex> nextOffsets;
+    std::vector<BipIndex> nexts;
+    std::vector<BipIndex> prevOffsets;
+    std::vector<BipIndex> prevs;
+    std::vector<ProcedureBip> procedureBips;
+
+  public:
+    /**
+     * Constructs a CFGBip with no procedures.
+     */
+    CfgBip();
+
+    /**
+     * Generates the graph of each procedure from the frozen CFG.
+     *
+     * @param cfg Frozen CFG, including the dummy end nodes.
+     * @param topoProc List of procedures in topological order of the call graph.
+     * @param procStartMapper Mapping of procedures to their respective start statements.
+     * @param callStmtToProcMapper Mapping of call statements to their respective called procedures.
+     */
+    CfgBip(
+      const Cfg& cfg,
+      const std::list<std::string>& topoProc,
+      const std::unordered_map<std::string, int>& procStartMapper,
+      const std::unordered_map<int, std::string>& callStmtToProcMapper);
 
     /**
-     * Creates a CFG of a target procedure.
+     * Gets the graphs of all procedures, in topological order of the call graph
+     * (callers before callees).
      *
-     * @param procName Procedure of interest.
-     * @param procStartMapper Mapping of procedure to their respective start statements.
+     * @return std::vector<ProcedureBip> Graphs of all procedures.
+     */
+    const std::vector<ProcedureBip>& getProcedureBips() const;
+
+    /**
+     * Gets the number of nodes in the arena.
+     *
+     * @return size_t Number of nodes.
+     */
+    size_t getNumNodes() const;
+
+    /**
+     * Gets the node at the given index of the arena.
+     *
+     * @param index Index of the node.
+     * @return BipNode The node.
+     */
+    const BipNode& getNode(const BipIndex index) const;
+
+    /**
+     * Gets the intraprocedural successors of the node at the given index of the arena.
+     *
+     * @param index Index of the node.
+     * @return Span<BipIndex> Indices of the successors.
+     */
+    Span<BipIndex> getNexts(const BipIndex index) const;
+
+    /**
+     * Gets the intraprocedural predecessors of the node at the given index of the arena.
+     *
+     * @param index Index of the node.
+     * @return Span<BipIndex> Indices of the predecessors.
+     */
+    Span<BipIndex> getPrevs(const BipIndex index) const;
+  };
+
+  /**
+   * Control flow graph over statement numbers, with a dummy end node -s for the procedure
+   * starting at statement s.
+   *
+   * Edges are added while parsing and then frozen into compressed sparse rows: the successors
+   * (and predecessors) of every node are stored contiguously, in the order their edges were
+   * added, and looked up by the slot of the node. Statement s has slot s, and the dummy end
+   * node -s has slot maxStmt + s, where maxStmt is the largest statement number in the graph.
+   *
+   * Freezing also groups statements 1 to maxStmt into basic blocks: maximal runs of
+   * consecutive statements s, s + 1, ..., t where every statement but t has the next one as
+   * its only successor, and every statement but s has the previous one as its only
+   * predecessor. A block is thus a statement range, within which execution order is the
+   * order of statement numbers, and traversals can step over whole blocks.
+   */
+  class Cfg {
+  private:
+    // Edges added since the graph was created, in the order they were added.
+    std::vector<std::pair<int, int>> edges;
+    bool isFrozenFlag = true;
+
+    // Compressed sparse rows, indexed by slot: the successors of the node in slot i are
+    // nexts[nextOffsets[i]] to nexts[nextOffsets[i + 1] - 1], and likewise for predecessors.
+    int maxStmt = 0;
+    std::vector<int> nextOffsets;
+    std::vector<int> nexts;
+    std::vector<int> prevOffsets;
+    std::vector<int> prevs;
+
+    // Basic blocks, numbered in order of their statements: block b holds statements
+    // blockFirstStmts[b] to blockFirstStmts[b + 1] - 1. Edges between blocks are compressed
+    // sparse rows indexed by block, leaving out the dummy end nodes.
+    std::vector<int> stmtToBlock;
+    std::vector<int> blockFirstStmts;
+    std::vector<int> blockNextOffsets;
+    std::vector<int> blockNexts;
+    std::vector<int> blockPrevOffsets;
+    std::vector<int> blockPrevs;
+
+    CfgBip cfgBip;
+
+    /**
+     * Groups the statements of the frozen CFG into basic blocks.
      */
-    CfgBipStartEnd createProcedureCfg(const std::string& procName, const std::unordered_map<std::string, int>& procStartMapper);
+    void formBasicBlocks();
 
   public:
     /**
-     * Adds a directed edge into the CFG.
+     * Adds a directed edge into the CFG. The CFG has to be frozen again before it is traversed.
      *
      * @param from From node to be inserted.
      * @param to To node to be inserted.
@@ -40,32 +175,115 @@ namespace Cfg {
     void addEdge(const int from, const int to);
 
     /**
-     * Finds the list of neighbouring nodes of the given node.
-     * If there are no neighbouring nodes, an empty list is returned.
+     * Lays out all edges added so far as compressed sparse rows. Spans returned before are
+     * invalidated. Does nothing if no edge was added since the CFG was last frozen.
+     */
+    void freeze();
+
+    /**
+     * Checks if every edge added is in the compressed sparse rows.
+     *
+     * @return `true` if the CFG is frozen, `false` otherwise.
+     */
+    bool isFrozen() const;
+
+    /**
+     * Finds the neighbouring (successor) nodes of the given node in the frozen CFG.
+     * If there are no neighbouring nodes, an empty span is returned.
+     *
+     * @param node Node of interest.
+     * @return Span of neighbouring nodes, valid until the CFG is frozen again.
+     */
+    Span<int> getNeighbours(const int node) const;
+
+    /**
+     * Finds the predecessor nodes of the given node in the frozen CFG.
+     * If there are no predecessor nodes, an empty span is returned.
+     *
+     * @param node Node of interest.
+     * @return Span of predecessor nodes, valid until the CFG is frozen again.
+     */
+    Span<int> getPredecessors(const int node) const;
+
+    /**
+     * Gets the number of slots of the frozen CFG.
+     *
+     * @return size_t Number of slots.
+     */
+    size_t getNumSlots() const;
+
+    /**
+     * Finds the slot of a node in the frozen CFG.
      *
      * @param node Node of interest.
-     * @return List of neighbouring nodes.
+     * @return The slot of the node, or -1 if the node is not in the graph.
      */
-    std::vector<int> getNeighbours(const int node) const;
+    int getSlot(const int node) const;
 
     /**
-     * Initialises and generates the CFGBip of all procedures.
-     * 
+     * Gets the number of basic blocks of the frozen CFG.
+     *
+     * @return size_t Number of basic blocks.
+     */
+    size_t getNumBlocks() const;
+
+    /**
+     * Finds the basic block holding a statement.
+     *
+     * @param stmt Statement number of interest.
+     * @return The index of the block, or -1 if the statement is not in the graph.
+     */
+    int getBlock(const int stmt) const;
+
+    /**
+     * Gets the first statement of a basic block.
+     *
+     * @param block Index of the block.
+     * @return int Statement number of the first statement.
+     */
+    int getBlockFirstStmt(const int block) const;
+
+    /**
+     * Gets the last statement of a basic block.
+     *
+     * @param block Index of the block.
+     * @return int Statement number of the last statement.
+     */
+    int getBlockLastStmt(const int block) const;
+
+    /**
+     * Finds the blocks that can be executed immediately after a basic block.
+     *
+     * @param block Index of the block.
+     * @return Span<int> Indices of the successor blocks, valid until the CFG is frozen again.
+     */
+    Span<int> getBlockNexts(const int block) const;
+
+    /**
+     * Finds the blocks that can be executed immediately before a basic block.
+     *
+     * @param block Index of the block.
+     * @return Span<int> Indices of the predecessor blocks, valid until the CFG is frozen again.
+     */
+    Span<int> getBlockPrevs(const int block) const;
+
+    /**
+     * Initialises the CFGBip of all procedures from the frozen CFG.
+     *
+     * @param topoProc List of procedures in topological order of the call graph.
      * @param procStartMapper Mapping of procedures to their respective start statements.
-     * @param procEndMapper Mapping of procedures to their respective end statements.
      * @param callStmtToProcMapper Mapping of call statements to their respective called procedures.
      */
     void initialiseCfgBip(
       const std::list<std::string>& topoProc,
       const std::unordered_map<std::string, int>& procStartMapper,
-      const std::unordered_map<std::string, std::vector<int>>& procEndMapper,
       const std::unordered_map<int, std::string>& callStmtToProcMapper);
 
     /**
-     * Gets the list of pointers to the startNodes of relevant topo-sorted procedures in the CFGBip.
+     * Gets the CFGBip of all procedures.
      *
-     * @return std::vector<std::shared_ptr<Cfg::BipNode>> List of pointers to the startNodes of relevant topo-sorted procedures in the CFGBip.
+     * @return CfgBip Graphs of all procedures in the CFGBip.
      */
-    std::vector<std::shared_ptr<BipNode>> getStartBipNodes() const;
+    const CfgBip& getCfgBip() const;
   };
 }
@@ -0,0 +1,115 @@
+#include "CondensedGraph.h"
+
+#include <assert.h>
+
+#include <stack>
+#include <vector>
+
+#include "BitVector.h"
+#include "Graph.h"
+
+CondensedGraph::CondensedGraph(const Graph& graph)
+  : nodeToComponent(graph.getStronglyConnectedComponents()) {
+  for (size_t node = 0; node < nodeToComponent.size(); node++) {
+    const size_t component = nodeToComponent[node];
+    if (component >= components.size()) {
+      components.resize(component + 1);
+    }
+    components[component].push_back(node);
+  }
+
+  const size_t numComponents = components.size();
+  componentSuccessors.resize(numComponents);
+  isComponentCyclic.resize(numComponents, false);
+  std::vector<int> lastSeenFrom(numComponents, -1); // deduplicates successors
+  for (size_t component = 0; component < numComponents; component++) {
+    isComponentCyclic[component] = components[component].size() > 1;
+    for (const int node : components[component]) {
+      for (const int successor : graph.getSuccessors(node)) {
+        const int successorComponent = nodeToComponent[successor];
+        if (successorComponent == (int)component) {
+          isComponentCyclic[component] = true;
+        } else if (lastSeenFrom[successorComponent] != (int)component) {
+          lastSeenFrom[successorComponent] = component;
+          componentSuccessors[component].push_back(successorComponent);
+        }
+      }
+    }
+  }
+}
+
+size_t CondensedGraph::getNumComponents() const {
+  return components.size();
+}
+
+int CondensedGraph::getComponent(int node) const {
+  assert(node >= 0 && (size_t)node < nodeToComponent.size());
+  return nodeToComponent[node];
+}
+
+const std::vector<int>& CondensedGraph::getNodes(int component) const {
+  return components[component];
+}
+
+const std::vector<int>& CondensedGraph::getSuccessors(int component) const {
+  return componentSuccessors[component];
+}
+
+bool CondensedGraph::isCyclic(int component) const {
+  return isComponentCyclic[component];
+}
+
+std::vector<BitVector> CondensedGraph::getReachableNodes() const {
+  const size_t numNodes = nodeToComponent.size();
+  std::vector<BitVector> reachable(components.size(), BitVector(numNodes));
+
+  // Successors are numbered lower, so they are complete by the time they are read
+  for (size_t component = 0; component < components.size(); component++) {
+    if (isComponentCyclic[component]) {
+      for (const int node : components[component]) {
+        reachable[component].set(node);
+      }
+    }
+    for (const int successor : componentSuccessors[component]) {
+      reachable[component].unionWith(reachable[successor]);
+      for (const int node : components[successor]) {
+        reachable[component].set(node);
+      }
+    }
+  }
+
+  return reachable;
+}
+
+BitVector CondensedGraph::getReachableNodes(int node) const {
+  BitVector reachable(nodeToComponent.size());
+  std::vector<bool> isVisited(components.size(), false);
+  std::stack<int> toVisit;
+
+  const int start = getComponent(node);
+  if (isComponentCyclic[start]) {
+    toVisit.push(start);
+    isVisited[start] = true;
+  } else {
+    for (const int successor : componentSuccessors[start]) {
+      toVisit.push(successor);
+      isVisited[successor] = true;
+    }
+  }
+
+  while (!toVisit.empty()) {
+    const int component = toVisit.top();
+    toVisit.pop();
+    for (const int member : components[component]) {
+      reachable.set(member);
+    }
+    for (const int successor : componentSuccessors[component]) {
+      if (!isVisited[successor]) {
+        toVisit.push(successor);
+        isVisited[successor] = true;
+      }
+    }
+  }
+
+  return reachable;
+}
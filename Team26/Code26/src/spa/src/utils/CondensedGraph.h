@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vector>
+
+#include "BitVector.h"
+#include "Graph.h"
+
+/**
+ * The condensation of a directed graph whose nodes are numbered densely from 0: every
+ * strongly connected component (SCC) is collapsed into a single node, leaving a DAG.
+ *
+ * Components are numbered in reverse topological order, i.e. every successor of a
+ * component has a smaller number than the component itself.
+ */
+class CondensedGraph {
+private:
+  // Component of each node.
+  std::vector<int> nodeToComponent;
+
+  // Nodes of each component.
+  std::vector<std::vector<int>> components;
+
+  // Successors of each component in the condensed DAG, without duplicates.
+  std::vector<std::vector<int>> componentSuccessors;
+
+  // Whether each component contains a cycle (more than one node, or a self loop).
+  std::vector<bool> isComponentCyclic;
+
+public:
+  /**
+   * Condenses the given graph, finding its SCCs with Tarjan's algorithm.
+   *
+   * @param graph Graph to condense.
+   */
+  CondensedGraph(const Graph& graph);
+
+  /**
+   * Returns the number of components.
+   *
+   * @returns Number of components.
+   */
+  size_t getNumComponents() const;
+
+  /**
+   * Returns the component containing the given node.
+   *
+   * @param node Node of interest.
+   * @returns Component containing the node.
+   */
+  int getComponent(int node) const;
+
+  /**
+   * Returns the nodes of the given component.
+   *
+   * @param component Component of interest.
+   * @returns Nodes of the component.
+   */
+  const std::vector<int>& getNodes(int component) const;
+
+  /**
+   * Returns the successors of the given component in the condensed DAG.
+   *
+   * @param component Component of interest.
+   * @returns Successors of the component, all numbered lower than it.
+   */
+  const std::vector<int>& getSuccessors(int component) const;
+
+  /**
+   * Checks if the nodes of the given component can reach themselves.
+   *
+   * @param component Component of interest.
+   * @returns `true` if the component contains a cycle, `false` otherwise.
+   */
+  bool isCyclic(int component) const;
+
+  /**
+   * Computes, for every component, the nodes reachable from its nodes along paths of
+   * at least one edge, in a single pass over the condensed DAG.
+   *
+   * @returns Bit vector over the nodes of the graph for each component.
+   */
+  std::vector<BitVector> getReachableNodes() const;
+
+  /**
+   * Computes the nodes reachable from the given node along paths of at least one edge,
+   * by traversing the condensed DAG from its component only.
+   *
+   * @param node Node of interest.
+   * @returns Bit vector over the nodes of the graph.
+   */
+  BitVector getReachableNodes(int node) const;
+};
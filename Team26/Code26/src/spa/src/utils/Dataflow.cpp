@@ -0,0 +1,46 @@
+#include "Dataflow.h"
+
+#include <assert.h>
+
+#include <vector>
+
+#include "BitVector.h"
+
+namespace Dataflow {
+  BitVectorProblem::BitVectorProblem(size_t numNodes, size_t numBits)
+    : numBits(numBits), successors(numNodes),
+    gen(numNodes, BitVector(numBits)), kill(numNodes, BitVector(numBits)) {
+  }
+
+  size_t BitVectorProblem::getNumNodes() const {
+    return successors.size();
+  }
+
+  void BitVectorProblem::addEdge(int from, int to) {
+    assert(from >= 0 && (size_t)from < successors.size());
+    assert(to >= 0 && (size_t)to < successors.size());
+    successors[from].push_back(to);
+  }
+
+  void BitVectorProblem::addGen(int node, size_t bit) {
+    gen[node].set(bit);
+  }
+
+  void BitVectorProblem::addKill(int node, const BitVector& bits) {
+    kill[node].unionWith(bits);
+  }
+
+  Solution BitVectorProblem::solve() const {
+    Solution solution;
+    solution.in.assign(successors.size(), BitVector(numBits));
+    solution.out = solveForward(successors, solution.in,
+      [this](int node, const BitVector& in) -> BitVector {
+        // out[n] = gen[n] OR (in[n] AND NOT kill[n])
+        BitVector out = in;
+        out.subtract(kill[node]);
+        out.unionWith(gen[node]);
+        return out;
+      });
+    return solution;
+  }
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <queue>
+#include <vector>
+
+#include "BitVector.h"
+
+namespace Dataflow {
+  /**
+   * Computes the least fixed point of a forward dataflow problem with union as the
+   * meet operator, using a worklist solver. A node is re-evaluated only when the
+   * facts flowing into it change. Backward problems are solved by passing the
+   * predecessors of each node as its successors.
+   *
+   * State must provide `bool unionWith(const State&)`, returning whether it changed,
+   * and the transfer function must be monotone.
+   *
+   * @param successors Successors of each node, with nodes numbered densely from 0.
+   * @param in Facts on entry to each node, seeded with the facts holding at the
+   *     entry nodes. Updated in place with the solution.
+   * @param transfer Function taking a node and the facts on entry to it, and
+   *     returning the facts on exit from it.
+   * @returns The facts on exit from each node.
+   */
+  template <typename State, typename Transfer>
+  std::vector<State> solveForward(const std::vector<std::vector<int>>& successors,
+    std::vector<State>& in, Transfer transfer) {
+    const size_t numNodes = successors.size();
+    std::vector<State> out(in);
+
+    // Every node is evaluated at least once, in index order. For CFGs numbered
+    // in program order this approximates a reverse postorder.
+    std::queue<int> worklist;
+    std::vector<bool> isInWorklist(numNodes, true);
+    for (size_t node = 0; node < numNodes; node++) {
+      worklist.push(node);
+    }
+
+    while (!worklist.empty()) {
+      const int node = worklist.front();
+      worklist.pop();
+      isInWorklist[node] = false;
+
+      out[node] = transfer(node, in[node]);
+
+      // Push the out facts into the successors, revisiting those that changed
+      for (const int successor : successors[node]) {
+        const bool isChanged = in[successor].unionWith(out[node]);
+        if (isChanged && !isInWorklist[successor]) {
+          worklist.push(successor);
+          isInWorklist[successor] = true;
+        }
+      }
+    }
+
+    return out;
+  }
+
+  struct Solution {
+    // Facts holding on entry to each node.
+    std::vector<BitVector> in;
+
+    // Facts holding on exit from each node.
+    std::vector<BitVector> out;
+  };
+
+  /**
+   * A bit-vector dataflow problem over a directed graph whose nodes are numbered
+   * densely from 0, with union as the meet operator (a "may" analysis such as
+   * reaching definitions or reachability). The transfer function of each node is
+   *
+   *     out[n] = gen[n] OR (in[n] AND NOT kill[n])
+   *     in[n]  = OR of out[p] over all predecessors p of n
+   *
+   * Backward problems are posed by adding the edges of the graph in reverse.
+   */
+  class BitVectorProblem {
+  private:
+    size_t numBits;
+    std::vector<std::vector<int>> successors;
+    std::vector<BitVector> gen;
+    std::vector<BitVector> kill;
+
+  public:
+    /**
+     * Constructs a problem with no edges and empty GEN/KILL sets.
+     *
+     * @param numNodes Number of nodes in the graph.
+     * @param numBits Number of facts tracked per node.
+     */
+    BitVectorProblem(size_t numNodes, size_t numBits);
+
+    /**
+     * Returns the number of nodes in the graph.
+     *
+     * @returns Number of nodes in the graph.
+     */
+    size_t getNumNodes() const;
+
+    /**
+     * Adds a directed edge along which facts flow.
+     *
+     * @param from Node that facts flow out of.
+     * @param to Node that facts flow into.
+     */
+    void addEdge(int from, int to);
+
+    /**
+     * Adds a fact to the GEN set of the given node.
+     *
+     * @param node Node of interest.
+     * @param bit Fact generated by the node.
+     */
+    void addGen(int node, size_t bit);
+
+    /**
+     * Adds facts to the KILL set of the given node.
+     *
+     * @param node Node of interest.
+     * @param bits Facts killed by the node.
+     */
+    void addKill(int node, const BitVector& bits);
+
+    /**
+     * Computes the least fixed point of the problem with a worklist solver.
+     * A node is re-evaluated only when the facts flowing into it change.
+     *
+     * @returns The in and out facts of every node.
+     */
+    Solution solve() const;
+  };
+}
@@ -0,0 +1,165 @@
+#include "ExprDag.h"
+
+#include <assert.h>
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+  /**
+   * Mixes a value into a hash, as boost::hash_combine does.
+   *
+   * @param hash Hash to mix into.
+   * @param value Value to mix in.
+   */
+  void combineHash(size_t& hash, const size_t value) {
+    hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+  }
+
+  /**
+   * Checks if a token of a postfix expression is an operator.
+   *
+   * @param token Token of interest.
+   * @returns True if the token is '+', '-', '*', '/' or '%'.
+   */
+  bool isOperator(const std::string& token) {
+    return token.size() == 1 &&
+      (token[0] == '+' || token[0] == '-' || token[0] == '*' || token[0] == '/' || token[0] == '%');
+  }
+
+  /**
+   * Walks the tokens of a postfix expression, separated by spaces, keeping the nodes of the
+   * operands on a stack.
+   *
+   * @param postfixExpr Expression in postfix form.
+   * @param getLeaf Returns the node of a variable or constant, -1 if it has none.
+   * @param getOperator Returns the node applying an operator to two nodes, -1 if it has none.
+   * @returns Node of the expression, -1 if any of its subexpressions has none.
+   */
+  int walkPostfixExpr(const std::string& postfixExpr, const std::function<int(const std::string&)>& getLeaf,
+    const std::function<int(char, int, int)>& getOperator) {
+    std::vector<int> operands;
+    size_t start = 0;
+    while (start < postfixExpr.size()) {
+      size_t end = postfixExpr.find(' ', start);
+      if (end == std::string::npos) {
+        end = postfixExpr.size();
+      }
+      if (end == start) {
+        start++;
+        continue;
+      }
+
+      const std::string token = postfixExpr.substr(start, end - start);
+      start = end;
+      int node;
+      if (isOperator(token)) {
+        assert(operands.size() >= 2);
+        const int right = operands.back();
+        operands.pop_back();
+        const int left = operands.back();
+        operands.pop_back();
+        node = left == -1 || right == -1 ? -1 : getOperator(token[0], left, right);
+      } else {
+        node = getLeaf(token);
+      }
+      operands.push_back(node);
+    }
+
+    assert(operands.size() == 1);
+    return operands.back();
+  }
+}
+
+bool ExprDag::Node::operator==(const Node& other) const {
+  return op == other.op && left == other.left && right == other.right;
+}
+
+size_t ExprDag::NodeHash::operator()(const Node& node) const {
+  return node.hash;
+}
+
+ExprDag::Node ExprDag::makeNode(const char op, const int left, const int right) const {
+  size_t hash = std::hash<int>()(op);
+  if (op == LEAF) {
+    combineHash(hash, std::hash<int>()(left));
+  } else {
+    combineHash(hash, nodes[left].hash);
+    combineHash(hash, nodes[right].hash);
+  }
+  return { op, left, right, hash };
+}
+
+int ExprDag::add(const Node& node) {
+  const auto inserted = nodeToId.emplace(node, (int)nodes.size());
+  if (inserted.second) {
+    nodes.push_back(node);
+  }
+  return inserted.first->second;
+}
+
+int ExprDag::find(const Node& node) const {
+  const auto it = nodeToId.find(node);
+  return it == nodeToId.end() ? -1 : it->second;
+}
+
+int ExprDag::addPostfixExpr(const std::string& postfixExpr,
+  const std::function<int(const std::string&)>& getNameId) {
+  return walkPostfixExpr(postfixExpr,
+    [this, &getNameId](const std::string& name) { return addLeaf(getNameId(name)); },
+    [this](char op, int left, int right) { return addOperator(op, left, right); });
+}
+
+int ExprDag::findPostfixExpr(const std::string& postfixExpr,
+  const std::function<int(const std::string&)>& getNameId) const {
+  return walkPostfixExpr(postfixExpr,
+    [this, &getNameId](const std::string& name) {
+      const int nameId = getNameId(name);
+      return nameId == -1 ? -1 : find(makeNode(LEAF, nameId, -1));
+    },
+    [this](char op, int left, int right) { return find(makeNode(op, left, right)); });
+}
+
+int ExprDag::addLeaf(const int name) {
+  assert(name >= 0);
+  return add(makeNode(LEAF, name, -1));
+}
+
+int ExprDag::addOperator(const char op, const int left, const int right) {
+  assert(op != LEAF);
+  assert(left >= 0 && left < (int)nodes.size() && right >= 0 && right < (int)nodes.size());
+  return add(makeNode(op, left, right));
+}
+
+const ExprDag::Node& ExprDag::getNode(const int id) const {
+  return nodes[id];
+}
+
+size_t ExprDag::getNumNodes() const {
+  return nodes.size();
+}
+
+bool ExprDag::contains(const int expr, const int subExpr) const {
+  // Operands are added before the nodes using them, so only nodes numbered at least subExpr
+  // can have it as a descendant
+  std::vector<int> stack{ expr };
+  std::vector<bool> isVisited(expr + 1, false);
+  while (!stack.empty()) {
+    const int node = stack.back();
+    stack.pop_back();
+    if (node == subExpr) {
+      return true;
+    }
+    if (node < subExpr || isVisited[node]) {
+      continue;
+    }
+    isVisited[node] = true;
+    if (nodes[node].op != LEAF) {
+      stack.push_back(nodes[node].left);
+      stack.push_back(nodes[node].right);
+    }
+  }
+  return false;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Expressions stored as a DAG of hash-consed nodes: every distinct subexpression is stored as
+ * one node, however many expressions it appears in, so that two expressions are equal exactly
+ * when their nodes are.
+ *
+ * Nodes are numbered densely from 0 in the order they were added, and the operands of a node
+ * are always added before it.
+ */
+class ExprDag {
+public:
+  // Operator of a leaf, which is a variable or constant
+  const static char LEAF = 0;
+
+  struct Node {
+    char op; // Operator ('+', '-', '*', '/' or '%'), or LEAF
+    int left; // Left operand, or the id of the name of a leaf
+    int right; // Right operand, or -1 for a leaf
+    size_t hash; // Hash of the structure of the subexpression, independent of node numbers
+
+    bool operator==(const Node& other) const;
+  };
+
+private:
+  struct NodeHash {
+    size_t operator()(const Node& node) const;
+  };
+
+  std::vector<Node> nodes;
+  std::unordered_map<Node, int, NodeHash> nodeToId;
+
+  /**
+   * Returns the node with the given operator and operands, with its structural hash.
+   *
+   * @param op Operator of the node, or LEAF.
+   * @param left Left operand, or the id of the name of a leaf.
+   * @param right Right operand, or -1 for a leaf.
+   * @returns Node with its hash set.
+   */
+  Node makeNode(char op, int left, int right) const;
+
+  /**
+   * Returns the id of a node, adding it if new.
+   *
+   * @param node Node of interest.
+   * @returns Id of the node.
+   */
+  int add(const Node& node);
+
+  /**
+   * Returns the id of a node.
+   *
+   * @param node Node of interest.
+   * @returns Id of the node, -1 if it has not been added.
+   */
+  int find(const Node& node) const;
+
+public:
+  /**
+   * Adds an expression in postfix form, with tokens separated by spaces, adding only the
+   * subexpressions that are new.
+   *
+   * @param postfixExpr Expression in postfix form, such as " x 1 + ".
+   * @param getNameId Returns the id of a variable or constant, adding it if new.
+   * @returns Id of the node of the expression.
+   */
+  int addPostfixExpr(const std::string& postfixExpr, const std::function<int(const std::string&)>& getNameId);
+
+  /**
+   * Returns the node of an expression in postfix form, without adding it.
+   *
+   * @param postfixExpr Expression in postfix form, such as " x 1 + ".
+   * @param getNameId Returns the id of a variable or constant, or -1 if it has none.
+   * @returns Id of the node of the expression, -1 if it has not been added.
+   */
+  int findPostfixExpr(const std::string& postfixExpr,
+    const std::function<int(const std::string&)>& getNameId) const;
+
+  /**
+   * Returns the leaf of a variable or constant, adding it if new.
+   *
+   * @param name Id of the variable or constant.
+   * @returns Id of the leaf.
+   */
+  int addLeaf(int name);
+
+  /**
+   * Returns the node applying an operator to two operands, adding it if new.
+   *
+   * @param op Operator of the node.
+   * @param left Left operand.
+   * @param right Right operand.
+   * @returns Id of the node.
+   */
+  int addOperator(char op, int left, int right);
+
+  /**
+   * Returns the node with the given id.
+   *
+   * @param id Id of the node.
+   * @returns The node, valid until the next node is added.
+   */
+  const Node& getNode(int id) const;
+
+  /**
+   * Returns the number of nodes.
+   *
+   * @returns Number of nodes.
+   */
+  size_t getNumNodes() const;
+
+  /**
+   * Checks if an expression has another as a subexpression, or is the other.
+   *
+   * @param expr Node of the expression.
+   * @param subExpr Node of the subexpression.
+   * @returns True if subExpr is expr or one of its descendants.
+   */
+  bool contains(int expr, int subExpr) const;
+};
@@ -16,19 +16,105 @@ namespace ExprProcessor {
   //==================//
 
   CondExprParser::CondExprParser(std::list<Token>& tokens) : tokens(tokens) {
-    it = this->tokens.begin();
   };
 
+  // Shunting-yard over the tokens, with the type of each value tracked on a second stack so
+  // that the SIMPLE grammar is checked as operators are applied: arithmetic operators take
+  // arithmetic operands, relational operators compare them, and '!', '&&' and '||' only take
+  // conditional expressions in parentheses.
   void CondExprParser::parse() {
-    parseCondExpr();
-
-    // Should have no more tokens left
-    if (it != tokens.end()) {
-      throw SyntaxError(
-        ErrorMessage::SYNTAX_ERROR_COND_EXPR_ADDITIONAL_TOKENS +
-        ErrorMessage::APPEND_TOKEN_RECEIVED +
-        it->value
-      );
+    std::stack<Token> operators;
+    std::stack<ValueType> values;
+    bool expectOperand = true;
+
+    for (const Token& token : tokens) {
+      const bool isOperand = token.type == NAME.type || token.type == CONST.type;
+
+      if (isOperand) {
+        if (!expectOperand) {
+          throw SyntaxError(
+            ErrorMessage::SYNTAX_ERROR_COND_EXPR_INVALID_FACTOR +
+            ErrorMessage::APPEND_TOKEN_RECEIVED +
+            token.value
+          );
+        }
+        expectOperand = false;
+
+        values.push(ValueType::ARITH);
+      } else if (token == COND_EXPR_NOT || token == LEFT_PARENTHESIS) {
+        if (!expectOperand) {
+          throw SyntaxError(
+            ErrorMessage::SYNTAX_ERROR_COND_EXPR_INVALID_COND_SUB_EXPR +
+            ErrorMessage::APPEND_TOKEN_RECEIVED +
+            token.value
+          );
+        }
+
+        operators.push(token);
+      } else if (token == RIGHT_PARENTHESIS) {
+        if (expectOperand) {
+          throw SyntaxError(
+            ErrorMessage::SYNTAX_ERROR_COND_EXPR_INVALID_FACTOR +
+            ErrorMessage::APPEND_TOKEN_RECEIVED +
+            token.value
+          );
+        }
+
+        while (!operators.empty() && operators.top() != LEFT_PARENTHESIS) {
+          applyOperator(operators.top(), values);
+          operators.pop();
+        }
+        if (operators.empty()) { // Missing '(' to pop
+          throw SyntaxError(
+            ErrorMessage::SYNTAX_ERROR_COND_EXPR_ADDITIONAL_TOKENS +
+            ErrorMessage::APPEND_TOKEN_RECEIVED +
+            token.value
+          );
+        }
+        operators.pop(); // Pop '(' in the stack
+
+        // A conditional expression can only be parenthesised once, e.g. not ((x < 1))
+        if (values.top() == ValueType::PARENTHESISED_COND) {
+          throw SyntaxError(ErrorMessage::SYNTAX_ERROR_COND_EXPR_INVALID_COND_SUB_EXPR);
+        }
+        if (values.top() == ValueType::COND) {
+          values.top() = ValueType::PARENTHESISED_COND;
+        }
+      } else {
+        const int precedence = getOperatorPrecedence(token);
+        if (precedence == 0 || expectOperand) { // Invalid tokens or missing operands. e.g. '{', '= ='
+          throw SyntaxError(
+            ErrorMessage::SYNTAX_ERROR_COND_EXPR_INVALID_FACTOR +
+            ErrorMessage::APPEND_TOKEN_RECEIVED +
+            token.value
+          );
+        }
+        expectOperand = true;
+
+        // All binary operators are left-associative
+        while (!operators.empty() && operators.top() != LEFT_PARENTHESIS &&
+          getOperatorPrecedence(operators.top()) >= precedence) {
+          applyOperator(operators.top(), values);
+          operators.pop();
+        }
+        operators.push(token);
+      }
+    }
+
+    if (expectOperand) {
+      throw SyntaxError(ErrorMessage::SYNTAX_ERROR_COND_EXPR_NOT_ENOUGH_TOKENS);
+    }
+    while (!operators.empty()) {
+      if (operators.top() == LEFT_PARENTHESIS) {
+        throw SyntaxError(ErrorMessage::SYNTAX_ERROR_COND_EXPR_NOT_ENOUGH_TOKENS);
+      }
+      applyOperator(operators.top(), values);
+      operators.pop();
+    }
+
+    assert(values.size() == 1);
+    if (values.top() != ValueType::COND) {
+      throw SyntaxError(ErrorMessage::SYNTAX_ERROR_COND_EXPR_INVALID_REL_EXPR);
     }
   }
 
@@ -52,167 +138,58 @@ namespace ExprProcessor {
     return resultSet;
   }
 
-  void CondExprParser::parseCondExpr() {
-    if (it == tokens.end()) {
-      throw SyntaxError(ErrorMessage::SYNTAX_ERROR_COND_EXPR_ADDITIONAL_TOKENS);
-    }
-
-    Token& currentToken = *it;
-    if (currentToken == COND_EXPR_NOT) {
-      validateAndConsume(COND_EXPR_NOT);
-      validateAndConsume(LEFT_PARENTHESIS);
-      parseCondExpr();
-      validateAndConsume(RIGHT_PARENTHESIS);
-    } else if (currentToken == LEFT_PARENTHESIS) {
-      parseCondSubExpr();
-    } else {
-      parseRelExpr();
-    }
-  }
-
-
-  void CondExprParser::parseCondSubExpr() {
-    // Current token == '(' can mean a cond_expr or factor
-    // Thus, try parsing a cond_expr first. If parsing fails, parse factor only
-    std::list<Token>::iterator tempPosition = it;
-    try {
-      validateAndConsume(LEFT_PARENTHESIS);
-      parseCondExpr();
-      validateAndConsume(RIGHT_PARENTHESIS);
-
-      if (it == tokens.end()) {
-        throw SyntaxError(ErrorMessage::SYNTAX_ERROR_COND_EXPR_ADDITIONAL_TOKENS);
-      }
-
-      Token& condExprBinaryOperatorToken = *it;
-      ++it;
-      if (isCondExprBinaryOperator(condExprBinaryOperatorToken)) {
-        std::list<Token>::iterator secondTempPosition = it;
-        try {
-          validateAndConsume(LEFT_PARENTHESIS);
-          parseCondExpr();
-          validateAndConsume(RIGHT_PARENTHESIS);
-        } catch (const SyntaxError&) {
-          it = secondTempPosition;
-          parseRelExpr();
-        }
-      } else {
+  void CondExprParser::applyOperator(const Token& op, std::stack<ValueType>& values) const {
+    if (op == COND_EXPR_NOT) {
+      if (values.top() != ValueType::PARENTHESISED_COND) {
         throw SyntaxError(ErrorMessage::SYNTAX_ERROR_COND_EXPR_INVALID_COND_SUB_EXPR);
       }
-    } catch (const SyntaxError&) {
-      it = tempPosition;
-      parseRelExpr();
-    }
-  }
-
-  void CondExprParser::parseRelExpr() {
-    parseRelFactor();
-
-    if (it == tokens.end()) {
-      throw SyntaxError(ErrorMessage::SYNTAX_ERROR_COND_EXPR_ADDITIONAL_TOKENS);
-    }
-    Token& currentToken = *it;
-    ++it;
-
-    if (!isRelExprOperator(currentToken)) {
-      throw SyntaxError(ErrorMessage::SYNTAX_ERROR_COND_EXPR_INVALID_REL_EXPR);
+      values.top() = ValueType::COND;
+      return;
     }
-    parseRelFactor();
-  }
 
-  // This method is redundant but we are following the redundant SIMPLE grammar rule
-  void CondExprParser::parseRelFactor() {
-    parseExpr();
-  }
+    assert(values.size() >= 2);
+    const ValueType right = values.top();
+    values.pop();
+    const ValueType left = values.top();
+    values.pop();
 
-  void CondExprParser::parseExpr() {
-    parseTerm();
-    while (it != tokens.end() && isExprOperator(*it)) {
-      ++it;
-      parseTerm();
+    const int precedence = getOperatorPrecedence(op);
+    if (precedence == 1) { // '&&', '||'
+      if (left != ValueType::PARENTHESISED_COND || right != ValueType::PARENTHESISED_COND) {
+        throw SyntaxError(ErrorMessage::SYNTAX_ERROR_COND_EXPR_INVALID_COND_SUB_EXPR);
+      }
+      values.push(ValueType::COND);
+    } else if (precedence == 2) { // relational operators
+      if (left != ValueType::ARITH || right != ValueType::ARITH) {
+        throw SyntaxError(ErrorMessage::SYNTAX_ERROR_COND_EXPR_INVALID_REL_EXPR);
+      }
+      values.push(ValueType::COND);
+    } else { // arithmetic operators
+      if (left != ValueType::ARITH || right != ValueType::ARITH) {
+        throw SyntaxError(ErrorMessage::SYNTAX_ERROR_COND_EXPR_INVALID_FACTOR);
+      }
+      values.push(ValueType::ARITH);
     }
   }
 
-  void CondExprParser::parseTerm() {
-    parseFactor();
-    while (it != tokens.end() && isTermOperator(*it)) {
-      ++it;
-      parseFactor();
+  int CondExprParser::getOperatorPrecedence(const Token& token) const {
+    if (token == COND_EXPR_NOT) {
+      return 5;
     }
-  }
-
-  void CondExprParser::parseFactor() {
-    if (it == tokens.end()) {
-      throw SyntaxError(ErrorMessage::SYNTAX_ERROR_COND_EXPR_ADDITIONAL_TOKENS);
+    if (token == EXPR_OP_TIMES || token == EXPR_OP_DIVIDE || token == EXPR_OP_MOD) {
+      return 4;
     }
-
-    const Token& currentToken = *it;
-    ++it;
-
-    const bool isVarOrConst = currentToken.type == NAME.type || currentToken.type == CONST.type;
-    if (currentToken == LEFT_PARENTHESIS) {
-      parseExpr();
-      validateAndConsume(RIGHT_PARENTHESIS);
-    } else if (!isVarOrConst) {
-      throw SyntaxError(ErrorMessage::SYNTAX_ERROR_COND_EXPR_INVALID_FACTOR);
+    if (token == EXPR_OP_PLUS || token == EXPR_OP_MINUS) {
+      return 3;
     }
-    // Else isVarOrConst is true, do nothing
-  }
-
-  void CondExprParser::validateAndConsume(const Token& validationToken) {
-    if (it == tokens.end()) {
-      throw SyntaxError(ErrorMessage::SYNTAX_ERROR_COND_EXPR_NOT_ENOUGH_TOKENS);
+    if (token == REL_EXPR_OP_GRT || token == REL_EXPR_OP_GEQ || token == REL_EXPR_OP_LET ||
+      token == REL_EXPR_OP_LEQ || token == REL_EXPR_OP_EQV || token == REL_EXPR_OP_NEQ) {
+      return 2;
     }
-
-    const Token frontToken = *it;
-
-    const bool isValidateTokenType = validationToken.value.empty();
-    if (isValidateTokenType) {
-      // Check type only for empty token value
-      if (frontToken.type != validationToken.type) {
-        throw SyntaxError(
-          ErrorMessage::SYNTAX_ERROR_COND_EXPR_WRONG_TOKEN_TYPE +
-          ErrorMessage::APPEND_TOKEN_RECEIVED +
-          frontToken.value
-        );
-      }
-    } else {
-      // Check exact match otherwise
-      if (frontToken != validationToken) {
-        throw SyntaxError(
-          ErrorMessage::SYNTAX_ERROR_COND_EXPR_WRONG_TOKEN_VALUE +
-          ErrorMessage::APPEND_TOKEN_EXPECTED +
-          validationToken.value +
-          ErrorMessage::APPEND_TOKEN_RECEIVED +
-          frontToken.value
-        );
-      }
+    if (token == COND_EXPR_AND || token == COND_EXPR_OR) {
+      return 1;
     }
-
-    // Validation success
-    ++it;
-  }
-
-  bool CondExprParser::isCondExprBinaryOperator(const Token& token) const {
-    return token == COND_EXPR_AND || token == COND_EXPR_OR;
-  }
-
-  bool CondExprParser::isRelExprOperator(const Token& token) const {
-    return token == REL_EXPR_OP_GRT ||
-      token == REL_EXPR_OP_GEQ ||
-      token == REL_EXPR_OP_LET ||
-      token == REL_EXPR_OP_LEQ ||
-      token == REL_EXPR_OP_EQV ||
-      token == REL_EXPR_OP_NEQ;;
-  }
-
-
-  bool CondExprParser::isExprOperator(const Token& token) const {
-    return token == EXPR_OP_PLUS || token == EXPR_OP_MINUS;
-  }
-
-  bool CondExprParser::isTermOperator(const Token& token) const {
-    return token == EXPR_OP_TIMES || token == EXPR_OP_DIVIDE || token == EXPR_OP_MOD;
+    return 0;
   }
 
   //==================//
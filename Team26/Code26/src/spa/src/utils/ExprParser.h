@@ -1,6 +1,7 @@
 #pragma once
 
 #include <list>
+#include <stack>
 #include <string>
 #include <unordered_set>
 
@@ -38,10 +39,21 @@ namespace ExprProcessor {
   // Dummy result token
   const static Token DUMMY_RESULT = { TokenType::IDENTIFIER, "dummy" };
 
+  /**
+   * Parser of conditional expressions. Expressions are parsed without recursing, with the
+   * operators awaiting their operands on an explicit stack, so that neither long nor deeply
+   * parenthesised expressions are limited by the call stack.
+   */
   class CondExprParser {
   private:
+    // What an operand or a parsed subexpression is
+    enum class ValueType {
+      ARITH, // Variable, constant or arithmetic expression, e.g. (x + 1)
+      COND, // Conditional expression, e.g. x < 1
+      PARENTHESISED_COND // Conditional expression in parentheses, e.g. (x < 1)
+    };
+
     std::list<Token>& tokens;
-    std::list<Token>::iterator it;
 
   public:
     /**
@@ -52,7 +64,7 @@ namespace ExprProcessor {
     CondExprParser(std::list<Token>& tokens);
 
     /**
-     * Runs the parser to parse an assignment expression
+     * Runs the parser to parse a conditional expression
      */
     void parse();
 
@@ -71,20 +83,22 @@ namespace ExprProcessor {
     std::unordered_set<std::string> getConstants() const;
 
   private:
-    void parseCondExpr();
-    void parseCondSubExpr();
-    void parseRelExpr();
-    void parseRelFactor();
-    void parseExpr();
-    void parseTerm();
-    void parseFactor();
-    void validateAndConsume(const Token& validationToken);
-    bool isCondExprBinaryOperator(const Token& token) const;
-    bool isRelExprOperator(const Token& token) const;
-    bool isExprOperator(const Token& token) const;
-    bool isTermOperator(const Token& token) const;
-
+    /**
+     * Replaces the operands of an operator on top of the stack of values by the type of its
+     * result, if they are of the types the operator takes.
+     *
+     * @param op Operator to apply.
+     * @param values Stack of the types of the values parsed so far.
+     */
+    void applyOperator(const Token& op, std::stack<ValueType>& values) const;
 
+    /**
+     * Returns the precedence of an operator, higher for operators that bind tighter.
+     *
+     * @param token Token of interest.
+     * @returns Precedence of the operator, 0 if the token is not an operator.
+     */
+    int getOperatorPrecedence(const Token& token) const;
   };
 
   class AssignExprParser {
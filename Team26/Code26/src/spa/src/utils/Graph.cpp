@@ -0,0 +1,247 @@
+#include "Graph.h"
+
+#include <assert.h>
+
+#include <algorithm>
+#include <stack>
+#include <utility>
+#include <vector>
+
+#include "BitVector.h"
+#include "Span.h"
+
+namespace {
+  /**
+   * Lays out the given edges as compressed sparse rows grouped by one of their endpoints,
+   * keeping the order of the edges within each row.
+   *
+   * @param numNodes Number of rows.
+   * @param edges Edges to lay out.
+   * @param isByTarget Whether to group the edges by their target instead of their source.
+   * @param offsets Filled with the start of each row, followed by the number of edges.
+   * @param rows Filled with the other endpoint of the edges, row by row.
+   */
+  void layOutRows(size_t numNodes, const std::vector<std::pair<int, int>>& edges, bool isByTarget,
+    std::vector<int>& offsets, std::vector<int>& rows) {
+    offsets.assign(numNodes + 1, 0);
+    for (const std::pair<int, int>& edge : edges) {
+      const int key = isByTarget ? edge.second : edge.first;
+      assert(key >= 0 && (size_t)key < numNodes);
+      offsets[key + 1]++;
+    }
+    for (size_t node = 0; node < numNodes; node++) {
+      offsets[node + 1] += offsets[node];
+    }
+
+    std::vector<int> nextPosition(offsets.begin(), offsets.end() - 1);
+    rows.assign(edges.size(), 0);
+    for (const std::pair<int, int>& edge : edges) {
+      const int key = isByTarget ? edge.second : edge.first;
+      rows[nextPosition[key]++] = isByTarget ? edge.first : edge.second;
+    }
+  }
+
+  /**
+   * Lists the edges given by the successors of each node.
+   *
+   * @param successors Successors of each node.
+   * @returns Edges (from, to), node by node.
+   */
+  std::vector<std::pair<int, int>> toEdges(const std::vector<std::vector<int>>& successors) {
+    std::vector<std::pair<int, int>> edges;
+    for (size_t node = 0; node < successors.size(); node++) {
+      for (const int successor : successors[node]) {
+        edges.emplace_back(node, successor);
+      }
+    }
+    return edges;
+  }
+}
+
+Graph::Graph(size_t numNodes, const std::vector<std::pair<int, int>>& edges) {
+  layOutRows(numNodes, edges, false, nextOffsets, nexts);
+  layOutRows(numNodes, edges, true, prevOffsets, prevs);
+}
+
+Graph::Graph(const std::vector<std::vector<int>>& successors)
+  : Graph(successors.size(), toEdges(successors)) {
+}
+
+size_t Graph::getNumNodes() const {
+  return nextOffsets.size() - 1;
+}
+
+Span<int> Graph::getSuccessors(int node) const {
+  assert(node >= 0 && (size_t)node < getNumNodes());
+  return Span<int>(nexts.data() + nextOffsets[node], nexts.data() + nextOffsets[node + 1]);
+}
+
+Span<int> Graph::getPredecessors(int node) const {
+  assert(node >= 0 && (size_t)node < getNumNodes());
+  return Span<int>(prevs.data() + prevOffsets[node], prevs.data() + prevOffsets[node + 1]);
+}
+
+std::vector<int> Graph::getTopologicalOrder() const {
+  const size_t numNodes = getNumNodes();
+  std::vector<int> inDegrees(numNodes);
+  std::vector<int> order;
+  for (size_t node = 0; node < numNodes; node++) {
+    inDegrees[node] = getPredecessors(node).size();
+    if (inDegrees[node] == 0) {
+      order.push_back(node);
+    }
+  }
+
+  // The order doubles as the queue of nodes whose predecessors are all ordered
+  for (size_t i = 0; i < order.size(); i++) {
+    for (const int successor : getSuccessors(order[i])) {
+      if (--inDegrees[successor] == 0) {
+        order.push_back(successor);
+      }
+    }
+  }
+  return order;
+}
+
+std::vector<int> Graph::getStronglyConnectedComponents() const {
+  const size_t numNodes = getNumNodes();
+  std::vector<int> nodeToComponent(numNodes, -1);
+  std::vector<int> discovery(numNodes, -1);
+  std::vector<int> lowLink(numNodes, 0);
+  std::vector<bool> isOnStack(numNodes, false);
+  std::stack<int> sccStack;
+  std::stack<std::pair<int, size_t>> callStack; // node, index of the next successor to visit
+  int time = 0;
+  int numComponents = 0;
+
+  for (size_t root = 0; root < numNodes; root++) {
+    if (discovery[root] != -1) {
+      continue;
+    }
+
+    discovery[root] = lowLink[root] = time++;
+    sccStack.push(root);
+    isOnStack[root] = true;
+    callStack.emplace(root, 0);
+
+    while (!callStack.empty()) {
+      const int node = callStack.top().first;
+      const size_t next = callStack.top().second;
+      const Span<int> successors = getSuccessors(node);
+
+      if (next < successors.size()) {
+        callStack.top().second++;
+        const int successor = successors[next];
+        if (discovery[successor] == -1) {
+          discovery[successor] = lowLink[successor] = time++;
+          sccStack.push(successor);
+          isOnStack[successor] = true;
+          callStack.emplace(successor, 0);
+        } else if (isOnStack[successor]) {
+          lowLink[node] = std::min(lowLink[node], discovery[successor]);
+        }
+        continue;
+      }
+
+      callStack.pop();
+      if (!callStack.empty()) {
+        const int parent = callStack.top().first;
+        lowLink[parent] = std::min(lowLink[parent], lowLink[node]);
+      }
+
+      // node is the root of an SCC, whose nodes are on top of it in sccStack.
+      // Every SCC reachable from it has already been popped, so it is numbered lower.
+      if (lowLink[node] == discovery[node]) {
+        int member;
+        do {
+          member = sccStack.top();
+          sccStack.pop();
+          isOnStack[member] = false;
+          nodeToComponent[member] = numComponents;
+        } while (member != node);
+        numComponents++;
+      }
+    }
+  }
+
+  return nodeToComponent;
+}
+
+std::vector<int> Graph::getConnectedComponents() const {
+  const size_t numNodes = getNumNodes();
+  std::vector<int> nodeToComponent(numNodes, -1);
+  int numComponents = 0;
+
+  for (size_t root = 0; root < numNodes; root++) {
+    if (nodeToComponent[root] != -1) {
+      continue;
+    }
+
+    std::vector<int> toVisit{ (int)root };
+    nodeToComponent[root] = numComponents;
+    while (!toVisit.empty()) {
+      const int node = toVisit.back();
+      toVisit.pop_back();
+      for (const Span<int>& neighbours : { getSuccessors(node), getPredecessors(node) }) {
+        for (const int neighbour : neighbours) {
+          if (nodeToComponent[neighbour] == -1) {
+            nodeToComponent[neighbour] = numComponents;
+            toVisit.push_back(neighbour);
+          }
+        }
+      }
+    }
+    numComponents++;
+  }
+
+  return nodeToComponent;
+}
+
+std::vector<int> Graph::getDepthFirstOrder(int root) const {
+  assert(root >= 0 && (size_t)root < getNumNodes());
+  std::vector<int> order{ root };
+  std::vector<bool> isVisited(getNumNodes(), false);
+  std::stack<std::pair<int, size_t>> callStack; // node, index of the next successor to visit
+  isVisited[root] = true;
+  callStack.emplace(root, 0);
+
+  while (!callStack.empty()) {
+    const Span<int> successors = getSuccessors(callStack.top().first);
+    if (callStack.top().second == successors.size()) {
+      callStack.pop();
+      continue;
+    }
+
+    const int successor = successors[callStack.top().second++];
+    if (!isVisited[successor]) {
+      isVisited[successor] = true;
+      order.push_back(successor);
+      callStack.emplace(successor, 0);
+    }
+  }
+
+  return order;
+}
+
+BitVector Graph::getReachableNodes(int node) const {
+  BitVector reachable(getNumNodes());
+  std::vector<int> toVisit;
+  for (const int successor : getSuccessors(node)) {
+    if (!reachable.test(successor)) {
+      reachable.set(successor);
+      toVisit.push_back(successor);
+    }
+  }
+
+  // toVisit doubles as the queue of the breadth first traversal
+  for (size_t i = 0; i < toVisit.size(); i++) {
+    for (const int successor : getSuccessors(toVisit[i])) {
+      if (!reachable.test(successor)) {
+        reachable.set(successor);
+        toVisit.push_back(successor);
+      }
+    }
+  }
+
+  return reachable;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <utility>
+#include <vector>
+
+#include "BitVector.h"
+#include "Span.h"
+
+/**
+ * Directed graph whose nodes are numbered densely from 0, with the successors and
+ * predecessors of every node stored as compressed sparse rows.
+ *
+ * All algorithms run in O(V + E) time and are iterative, so that deep graphs (such as long
+ * call chains) do not overflow the call stack.
+ */
+class Graph {
+private:
+  // Successors of node i are nexts[nextOffsets[i]] to nexts[nextOffsets[i + 1] - 1], in the
+  // order their edges were given, and likewise for predecessors.
+  std::vector<int> nextOffsets;
+  std::vector<int> nexts;
+  std::vector<int> prevOffsets;
+  std::vector<int> prevs;
+
+public:
+  /**
+   * Constructs a graph from its edges.
+   *
+   * @param numNodes Number of nodes.
+   * @param edges Edges (from, to) of the graph.
+   */
+  Graph(size_t numNodes, const std::vector<std::pair<int, int>>& edges);
+
+  /**
+   * Constructs a graph from the successors of each node.
+   *
+   * @param successors Successors of each node.
+   */
+  Graph(const std::vector<std::vector<int>>& successors);
+
+  /**
+   * Returns the number of nodes.
+   *
+   * @returns Number of nodes.
+   */
+  size_t getNumNodes() const;
+
+  /**
+   * Returns the successors of the given node.
+   *
+   * @param node Node of interest.
+   * @returns Successors of the node, valid as long as the graph.
+   */
+  Span<int> getSuccessors(int node) const;
+
+  /**
+   * Returns the predecessors of the given node.
+   *
+   * @param node Node of interest.
+   * @returns Predecessors of the node, valid as long as the graph.
+   */
+  Span<int> getPredecessors(int node) const;
+
+  /**
+   * Orders the nodes topologically with Kahn's algorithm. Nodes of in-degree 0 are taken in
+   * ascending order first, and the successors of each node in the order of its edges.
+   *
+   * @returns Nodes in topological order. Nodes on or after a cycle are left out, so the
+   *     order is shorter than the number of nodes exactly when the graph is cyclic.
+   */
+  std::vector<int> getTopologicalOrder() const;
+
+  /**
+   * Finds the strongly connected components (SCCs) with Tarjan's algorithm.
+   *
+   * @returns Component of each node. Components are numbered in reverse topological order,
+   *     i.e. every edge between two components leads to the lower numbered one.
+   */
+  std::vector<int> getStronglyConnectedComponents() const;
+
+  /**
+   * Finds the connected components, ignoring the direction of edges.
+   *
+   * @returns Component of each node. Components are numbered in order of their smallest node.
+   */
+  std::vector<int> getConnectedComponents() const;
+
+  /**
+   * Traverses the nodes reachable from the given node depth first.
+   *
+   * @param root Node to start from.
+   * @returns Nodes reachable from the root, including the root, in preorder.
+   */
+  std::vector<int> getDepthFirstOrder(int root) const;
+
+  /**
+   * Finds the nodes reachable from the given node along paths of at least one edge,
+   * traversing breadth first.
+   *
+   * @param node Node of interest.
+   * @returns Bit vector over the nodes of the graph.
+   */
+  BitVector getReachableNodes(int node) const;
+};
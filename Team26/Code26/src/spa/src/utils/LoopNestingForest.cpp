@@ -0,0 +1,156 @@
+#include "LoopNestingForest.h"
+
+#include <assert.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "Cfg.h"
+
+namespace Cfg {
+  LoopNestingForest::LoopNestingForest() {
+  }
+
+  LoopNestingForest::LoopNestingForest(const Cfg& cfg, const std::vector<int>& stmtToParent,
+    const std::vector<int>& procStartStmts)
+    : parents(stmtToParent) {
+    const int numStmts = parents.empty() ? 0 : parents.size() - 1;
+
+    // Descendants are numbered after their ancestors
+    lastDescendants.assign(numStmts + 1, 0);
+    for (int stmt = numStmts; stmt >= 1; stmt--) {
+      lastDescendants[stmt] = std::max(lastDescendants[stmt], stmt);
+      assert(parents[stmt] < stmt);
+      if (parents[stmt] != 0) {
+        lastDescendants[parents[stmt]] = std::max(lastDescendants[parents[stmt]], lastDescendants[stmt]);
+      }
+    }
+
+    // A container is an if statement when it can jump into its own descendants (its else
+    // branch), and a while loop otherwise
+    elseStarts.assign(numStmts + 1, 0);
+    outermostLoops.assign(numStmts + 1, 0);
+    for (int stmt = 1; stmt <= numStmts; stmt++) {
+      const bool isContainer = lastDescendants[stmt] > stmt;
+      for (const int next : cfg.getNeighbours(stmt)) {
+        if (isContainer && next > stmt + 1 && next <= lastDescendants[stmt]) {
+          elseStarts[stmt] = next;
+        }
+      }
+
+      outermostLoops[stmt] = parents[stmt] == 0 ? 0 : outermostLoops[parents[stmt]];
+      if (outermostLoops[stmt] == 0 && isContainer && elseStarts[stmt] == 0) {
+        outermostLoops[stmt] = stmt;
+      }
+    }
+
+    // Procedures are consecutive ranges of statements. Statements before the first known
+    // procedure are taken to form one.
+    std::vector<int> starts(procStartStmts);
+    starts.push_back(1);
+    std::sort(starts.begin(), starts.end());
+    starts.erase(std::unique(starts.begin(), starts.end()), starts.end());
+    procFirstStmts.assign(numStmts + 1, 0);
+    procLastStmts.assign(numStmts + 1, 0);
+    for (size_t proc = 0; proc < starts.size() && starts[proc] <= numStmts; proc++) {
+      const int last = proc + 1 < starts.size() ? std::min(starts[proc + 1] - 1, numStmts) : numStmts;
+      for (int stmt = starts[proc]; stmt <= last; stmt++) {
+        procFirstStmts[stmt] = starts[proc];
+        procLastStmts[stmt] = last;
+      }
+    }
+  }
+
+  bool LoopNestingForest::isStmt(int stmt) const {
+    return stmt >= 1 && (size_t)stmt < parents.size();
+  }
+
+  bool LoopNestingForest::isNextT(int prev, int next) const {
+    if (!isStmt(prev) || !isStmt(next) || procFirstStmts[prev] != procFirstStmts[next]) {
+      return false;
+    }
+
+    const int loop = outermostLoops[prev];
+    if (loop != 0 && loop <= next && next <= lastDescendants[loop]) {
+      return true;
+    }
+    if (next <= prev) {
+      return false;
+    }
+    for (int container = parents[prev]; container != 0; container = parents[container]) {
+      const int elseStart = elseStarts[container];
+      if (elseStart != 0 && prev < elseStart && elseStart <= next && next <= lastDescendants[container]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::vector<StmtRange> LoopNestingForest::getNextTRanges(int stmt) const {
+    std::vector<StmtRange> ranges;
+    if (!isStmt(stmt)) {
+      return ranges;
+    }
+
+    // All of the outermost loop around the statement
+    const int loop = outermostLoops[stmt];
+    int first = stmt + 1;
+    if (loop != 0) {
+      ranges.emplace_back(loop, lastDescendants[loop]);
+      first = lastDescendants[loop] + 1;
+    }
+
+    // Statements after it, skipping the else branches of the ifs whose then branch holds it.
+    // Inner containers come first, so the skipped branches are in ascending order.
+    for (int container = parents[stmt]; container != 0; container = parents[container]) {
+      const int elseStart = elseStarts[container];
+      if (elseStart == 0 || stmt >= elseStart || lastDescendants[container] < first) {
+        continue;
+      }
+      if (first < elseStart) {
+        ranges.emplace_back(first, elseStart - 1);
+      }
+      first = lastDescendants[container] + 1;
+    }
+    if (first <= procLastStmts[stmt]) {
+      ranges.emplace_back(first, procLastStmts[stmt]);
+    }
+    return ranges;
+  }
+
+  std::vector<StmtRange> LoopNestingForest::getPrevTRanges(int stmt) const {
+    std::vector<StmtRange> ranges;
+    if (!isStmt(stmt)) {
+      return ranges;
+    }
+
+    // Statements before it, skipping the then branches of the ifs whose else branch holds it.
+    // Inner containers come first, so the skipped branches are in descending order.
+    const int loop = outermostLoops[stmt];
+    int last = stmt - 1;
+    if (loop != 0) {
+      last = loop - 1;
+    }
+    std::vector<StmtRange> rangesBefore;
+    for (int container = parents[stmt]; container != 0; container = parents[container]) {
+      const int elseStart = elseStarts[container];
+      if (elseStart == 0 || stmt < elseStart || container + 1 > last) {
+        continue;
+      }
+      if (elseStart - 1 < last) {
+        rangesBefore.emplace_back(elseStart, last);
+      }
+      last = container;
+    }
+    if (procFirstStmts[stmt] <= last) {
+      rangesBefore.emplace_back(procFirstStmts[stmt], last);
+    }
+    ranges.assign(rangesBefore.rbegin(), rangesBefore.rend());
+
+    // All of the outermost loop around the statement
+    if (loop != 0) {
+      ranges.emplace_back(loop, lastDescendants[loop]);
+    }
+    return ranges;
+  }
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "Cfg.h"
+
+namespace Cfg {
+  // Statements first to second, inclusive.
+  typedef std::pair<int, int> StmtRange;
+
+  /**
+   * Answers Next*(s, s') from the nesting of statements, without traversing the CFG.
+   *
+   * Statements of a SIMPLE procedure are numbered in program order, so the statements
+   * nested in a container form the range of numbers up to its last descendant, and every
+   * while loop is strongly connected in the CFG. Within a procedure, Next*(s, s') holds
+   * exactly when either
+   *   1) s and s' are in (or are) a common while loop, or
+   *   2) s' comes after s, and s' is not in the else branch of an if whose then branch
+   *      holds s.
+   * The outermost loop around each statement decides 1) in O(1); 2) walks the containers
+   * of a statement, in O(depth).
+   */
+  class LoopNestingForest {
+  private:
+    // Indexed by statement number, 0 being no statement.
+    std::vector<int> parents;
+    std::vector<int> lastDescendants;
+
+    // First statement of the else branch of each if statement, 0 for other statements.
+    std::vector<int> elseStarts;
+
+    // Outermost while loop containing each statement (or the statement itself), 0 if none.
+    std::vector<int> outermostLoops;
+
+    // First and last statement of the procedure of each statement.
+    std::vector<int> procFirstStmts;
+    std::vector<int> procLastStmts;
+
+    /**
+     * Checks if a number is a statement of the program.
+     *
+     * @param stmt Number of interest.
+     * @returns `true` if it is a statement, `false` otherwise.
+     */
+    bool isStmt(int stmt) const;
+
+  public:
+    /**
+     * Constructs a forest with no statements.
+     */
+    LoopNestingForest();
+
+    /**
+     * Builds the forest of the given program.
+     *
+     * @param cfg Frozen CFG of the program, from which if statements and their else
+     *     branches are found.
+     * @param stmtToParent Parent of each statement number (0 if none), from 0 to the number
+     *     of statements.
+     * @param procStartStmts First statement of each procedure.
+     */
+    LoopNestingForest(const Cfg& cfg, const std::vector<int>& stmtToParent, const std::vector<int>& procStartStmts);
+
+    /**
+     * Checks if Next*(prev, next) holds.
+     *
+     * @param prev Statement number of the first statement.
+     * @param next Statement number of the second statement.
+     * @returns `true` if the relation holds, `false` otherwise.
+     */
+    bool isNextT(int prev, int next) const;
+
+    /**
+     * Finds the statements s' such that Next*(s, s') holds.
+     *
+     * @param stmt Statement number of s.
+     * @returns Disjoint ranges of all s', in ascending order. Empty if s is not a statement.
+     */
+    std::vector<StmtRange> getNextTRanges(int stmt) const;
+
+    /**
+     * Finds the statements s such that Next*(s, s') holds.
+     *
+     * @param stmt Statement number of s'.
+     * @returns Disjoint ranges of all s, in ascending order. Empty if s' is not a statement.
+     */
+    std::vector<StmtRange> getPrevTRanges(int stmt) const;
+
+    /**
+     * Calls the given function on every pair (s, s') such that Next*(s, s') holds.
+     *
+     * @param fn Function taking the statement numbers of s and s'.
+     */
+    template <typename Function>
+    void forEachNextT(Function fn) const {
+      for (int stmt = 1; isStmt(stmt); stmt++) {
+        for (const StmtRange& range : getNextTRanges(stmt)) {
+          for (int next = range.first; next <= range.second; next++) {
+            fn(stmt, next);
+          }
+        }
+      }
+    }
+  };
+}
@@ -0,0 +1,107 @@
+#include "MappedFile.h"
+
+#include <assert.h>
+
+#include <string>
+
+#include "Span.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string& path) : data(nullptr), size(0), isOpened(false) {
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+    FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    return;
+  }
+
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file, &fileSize)) {
+    CloseHandle(file);
+    return;
+  }
+  if (fileSize.QuadPart == 0) {
+    // Empty files cannot be mapped
+    CloseHandle(file);
+    isOpened = true;
+    return;
+  }
+
+  // The view keeps the mapping, and the mapping the file, open once their handles are closed
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  CloseHandle(file);
+  if (mapping == NULL) {
+    return;
+  }
+  const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (view == NULL) {
+    return;
+  }
+
+  data = static_cast<const char*>(view);
+  size = (size_t)fileSize.QuadPart;
+  isOpened = true;
+}
+
+MappedFile::~MappedFile() {
+  if (data != nullptr) {
+    UnmapViewOfFile(data);
+  }
+}
+#else
+MappedFile::MappedFile(const std::string& path) : data(nullptr), size(0), isOpened(false) {
+  const int file = open(path.c_str(), O_RDONLY);
+  if (file == -1) {
+    return;
+  }
+
+  struct stat fileStat;
+  if (fstat(file, &fileStat) == -1) {
+    close(file);
+    return;
+  }
+  if (fileStat.st_size == 0) {
+    // Empty files cannot be mapped
+    close(file);
+    isOpened = true;
+    return;
+  }
+
+  // The mapping keeps the file open once its descriptor is closed
+  void* view = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+  close(file);
+  if (view == MAP_FAILED) {
+    return;
+  }
+  madvise(view, (size_t)fileStat.st_size, MADV_SEQUENTIAL);
+
+  data = static_cast<const char*>(view);
+  size = (size_t)fileStat.st_size;
+  isOpened = true;
+}
+
+MappedFile::~MappedFile() {
+  if (data != nullptr) {
+    munmap(const_cast<char*>(data), size);
+  }
+}
+#endif
+
+bool MappedFile::isOpen() const {
+  return isOpened;
+}
+
+Span<char> MappedFile::getText() const {
+  assert(data != nullptr || size == 0);
+  return Span<char>(data, data + size);
+}
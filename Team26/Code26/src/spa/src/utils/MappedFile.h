@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <string>
+
+#include "Span.h"
+
+/**
+ * Read-only view of the contents of a file, mapped into memory instead of read into a
+ * buffer, so that the pages of the file are brought in by the operating system as they are
+ * scanned and never copied.
+ *
+ * Like std::ifstream, failing to open the file is reported by isOpen() rather than thrown.
+ */
+class MappedFile {
+private:
+  const char* data;
+  size_t size;
+  bool isOpened;
+
+public:
+  /**
+   * Maps the given file into memory.
+   *
+   * @param path Path of the file.
+   */
+  explicit MappedFile(const std::string& path);
+
+  /**
+   * Unmaps the file.
+   */
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /**
+   * Checks if the file was opened. An empty file is opened but has nothing mapped.
+   *
+   * @returns `true` if the file was opened, `false` otherwise.
+   */
+  bool isOpen() const;
+
+  /**
+   * Returns the contents of the file.
+   *
+   * @returns View of the contents, valid as long as this object. Empty if the file could not
+   *     be opened.
+   */
+  Span<char> getText() const;
+};
@@ -0,0 +1,159 @@
+#include "Profiler.h"
+
+#include <assert.h>
+
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <sys/time.h>
+#endif
+
+namespace {
+  /**
+   * Escapes a string for use as a JSON string literal, including the quotes.
+   *
+   * @param string String to escape.
+   * @returns The JSON string literal.
+   */
+  std::string toJsonString(const std::string& string) {
+    std::ostringstream json;
+    json << '"';
+    for (const char c : string) {
+      if (c == '"' || c == '\\') {
+        json << '\\' << c;
+      } else if ((unsigned char)c < 0x20) {
+        json << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c << std::dec;
+      } else {
+        json << c;
+      }
+    }
+    json << '"';
+    return json.str();
+  }
+}
+
+double Profiler::getWallMs() {
+  const std::chrono::steady_clock::duration sinceEpoch = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration<double, std::milli>(sinceEpoch).count();
+}
+
+double Profiler::getCpuMs() {
+#ifdef _WIN32
+  FILETIME creationTime, exitTime, kernelTime, userTime;
+  if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+    return 0;
+  }
+  // FILETIMEs count 100ns intervals
+  const double kernel100ns = ((double)kernelTime.dwHighDateTime * 4294967296.0) + kernelTime.dwLowDateTime;
+  const double user100ns = ((double)userTime.dwHighDateTime * 4294967296.0) + userTime.dwLowDateTime;
+  return (kernel100ns + user100ns) / 10000;
+#else
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 +
+    (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+#endif
+}
+
+long Profiler::getPeakRssKb() {
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+    return 0;
+  }
+  return (long)(counters.PeakWorkingSetSize / 1024);
+#else
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024; // bytes on macOS
+#else
+  return usage.ru_maxrss;
+#endif
+#endif
+}
+
+Profiler::Profiler(bool isEnabled)
+  : isEnabledFlag(isEnabled), startWallMs(0), startCpuMs(0), startPeakRssKb(0) {
+}
+
+bool Profiler::isEnabled() const {
+  return isEnabledFlag;
+}
+
+void Profiler::startPhase(const std::string& name, const TableSizes& tableSizes) {
+  assert(currentPhaseName.empty()); // Phases do not nest
+  currentPhaseName = name;
+  startTableSizes = tableSizes;
+  startPeakRssKb = getPeakRssKb();
+  startCpuMs = getCpuMs();
+  startWallMs = getWallMs();
+}
+
+void Profiler::endPhase(const TableSizes& tableSizes) {
+  const double endWallMs = getWallMs();
+  const double endCpuMs = getCpuMs();
+  assert(!currentPhaseName.empty());
+
+  Phase phase;
+  phase.name = currentPhaseName;
+  phase.wallMs = endWallMs - startWallMs;
+  phase.cpuMs = endCpuMs - startCpuMs;
+  phase.peakRssDeltaKb = getPeakRssKb() - startPeakRssKb;
+
+  std::unordered_map<std::string, size_t> startSizes(startTableSizes.begin(), startTableSizes.end());
+  for (const std::pair<std::string, size_t>& tableSize : tableSizes) {
+    const size_t startSize = startSizes.count(tableSize.first) == 1 ? startSizes.at(tableSize.first) : 0;
+    if (tableSize.second > startSize) {
+      phase.rowsAdded.emplace_back(tableSize.first, tableSize.second - startSize);
+    }
+  }
+
+  phases.push_back(phase);
+  currentPhaseName.clear();
+}
+
+const std::vector<Profiler::Phase>& Profiler::getPhases() const {
+  return phases;
+}
+
+std::string Profiler::toJson() const {
+  std::ostringstream json;
+  json << std::fixed << std::setprecision(3);
+
+  double totalWallMs = 0;
+  double totalCpuMs = 0;
+  json << "{\n  \"phases\": [";
+  for (size_t i = 0; i < phases.size(); i++) {
+    const Phase& phase = phases[i];
+    totalWallMs += phase.wallMs;
+    totalCpuMs += phase.cpuMs;
+
+    json << (i == 0 ? "\n" : ",\n");
+    json << "    { \"name\": " << toJsonString(phase.name)
+      << ", \"wallMs\": " << phase.wallMs
+      << ", \"cpuMs\": " << phase.cpuMs
+      << ", \"peakRssDeltaKb\": " << phase.peakRssDeltaKb
+      << ", \"rowsAdded\": {";
+    for (size_t j = 0; j < phase.rowsAdded.size(); j++) {
+      json << (j == 0 ? " " : ", ") << toJsonString(phase.rowsAdded[j].first) << ": " << phase.rowsAdded[j].second;
+    }
+    json << (phase.rowsAdded.empty() ? "} }" : " } }");
+  }
+  json << (phases.empty() ? "],\n" : "\n  ],\n");
+  json << "  \"totalWallMs\": " << totalWallMs << ",\n";
+  json << "  \"totalCpuMs\": " << totalCpuMs << ",\n";
+  json << "  \"peakRssKb\": " << getPeakRssKb() << "\n";
+  json << "}\n";
+  return json.str();
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Records the cost of each phase of loading a source program: wall time, CPU time, the
+ * growth of the peak resident set size and the rows added to each PKB table.
+ */
+class Profiler {
+public:
+  // Name and number of rows of each table.
+  typedef std::vector<std::pair<std::string, size_t>> TableSizes;
+
+  struct Phase {
+    std::string name;
+    double wallMs;
+    double cpuMs;
+    long peakRssDeltaKb;
+
+    // Rows added to each table that grew during the phase.
+    TableSizes rowsAdded;
+  };
+
+private:
+  bool isEnabledFlag;
+  std::vector<Phase> phases;
+
+  // Measurements taken when the current phase started.
+  std::string currentPhaseName;
+  double startWallMs;
+  double startCpuMs;
+  long startPeakRssKb;
+  TableSizes startTableSizes;
+
+  static double getWallMs();
+  static double getCpuMs();
+  static long getPeakRssKb();
+
+public:
+  /**
+   * Constructs a profiler with no phases recorded.
+   *
+   * @param isEnabled Whether phases are measured. A disabled profiler only runs them.
+   */
+  Profiler(bool isEnabled = false);
+
+  /**
+   * Checks if phases are measured.
+   *
+   * @returns `true` if phases are measured, `false` otherwise.
+   */
+  bool isEnabled() const;
+
+  /**
+   * Starts measuring a phase. Phases do not nest.
+   *
+   * @param name Name of the phase.
+   * @param tableSizes Sizes of the tables before the phase.
+   */
+  void startPhase(const std::string& name, const TableSizes& tableSizes);
+
+  /**
+   * Stops measuring the current phase and records it.
+   *
+   * @param tableSizes Sizes of the tables after the phase.
+   */
+  void endPhase(const TableSizes& tableSizes);
+
+  /**
+   * Runs a phase, measuring it if the profiler is enabled.
+   *
+   * @param name Name of the phase.
+   * @param source Object whose tables are counted, providing `TableSizes getTableSizes() const`.
+   * @param phase Function running the phase.
+   */
+  template <typename Source, typename Function>
+  void measure(const std::string& name, const Source& source, Function phase) {
+    if (!isEnabledFlag) {
+      phase();
+      return;
+    }
+    startPhase(name, source.getTableSizes());
+    phase();
+    endPhase(source.getTableSizes());
+  }
+
+  /**
+   * Returns the phases recorded so far, in the order they ran.
+   *
+   * @returns The recorded phases.
+   */
+  const std::vector<Phase>& getPhases() const;
+
+  /**
+   * Formats the recorded phases and their totals as a JSON object.
+   *
+   * @returns The report in JSON.
+   */
+  std::string toJson() const;
+};
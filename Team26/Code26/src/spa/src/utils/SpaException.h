@@ -102,6 +102,10 @@ namespace Pql {
     const static std::string SYNTAX_ERROR_INVALID_DESIGN_ENTITY = "Encountered an invalid design entity for declaration.";
     const static std::string SYNTAX_ERROR_INVALID_RELATION = "Encountered an invalid relation for such that clause.";
     const static std::string SYNTAX_ERROR_INVALID_ATTRIBUTE_NAME = "Expected an attribute name but encountered an invalid token.";
+    const static std::string SYNTAX_ERROR_INVALID_PLACEHOLDER = "Encountered a placeholder where only an integer or a quoted name can be.";
+    const static std::string SYNTAX_ERROR_UNBOUND_PLACEHOLDER = "Expected a value for every placeholder but found none for one.";
+    const static std::string SYNTAX_ERROR_INVALID_BINDING = "Encountered a value of the wrong type for a placeholder.";
+    const static std::string SYNTAX_ERROR_UNKNOWN_PLACEHOLDER = "Encountered a value for a placeholder not in the query.";
 
     // Semantic Errors
     const static std::string SEMANTIC_ERROR_DUPLICATE_SYNONYM_DECLARATION = "Encountered an already declared synonym.";
@@ -122,6 +126,7 @@ namespace Pql {
     const static std::string APPEND_TOKEN_EXPECTED = "\nToken expected: ";
     const static std::string APPEND_TOKEN_RECEIVED = "\nToken received: ";
     const static std::string APPEND_SYNONYM_WITH_MISSING_ATTR_REF = "\nSynonym with missing attrRef: ";
+    const static std::string APPEND_PLACEHOLDER = "\nPlaceholder: ";
   }
 
   /**
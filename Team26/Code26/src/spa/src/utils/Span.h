@@ -0,0 +1,54 @@
+#pragma once
+
+#include <assert.h>
+
+#include <stddef.h>
+
+/**
+ * Non-owning view of a contiguous, read-only sequence of elements. The view is only valid as
+ * long as the storage it points into is neither modified nor destroyed.
+ */
+template <typename T>
+class Span {
+private:
+  const T* first;
+  const T* last;
+
+public:
+  /**
+   * Constructs an empty view.
+   */
+  Span() : first(nullptr), last(nullptr) {
+  }
+
+  /**
+   * Constructs a view of the elements in [first, last).
+   *
+   * @param first Pointer to the first element.
+   * @param last Pointer past the last element.
+   */
+  Span(const T* first, const T* last) : first(first), last(last) {
+    assert(first <= last);
+  }
+
+  const T* begin() const {
+    return first;
+  }
+
+  const T* end() const {
+    return last;
+  }
+
+  size_t size() const {
+    return last - first;
+  }
+
+  bool empty() const {
+    return first == last;
+  }
+
+  const T& operator[](size_t index) const {
+    assert(index < size());
+    return first[index];
+  }
+};
@@ -5,6 +5,7 @@
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace {
   bool areAllHeadersUnique(const Header& newHeader) {
@@ -43,6 +44,15 @@ void Table::insertRow(const Row& row) {
   data.emplace(row);
 }
 
+void Table::insertRows(const std::vector<int>& values) {
+  const size_t numColumns = header.size();
+  assert(values.size() % numColumns == 0);
+  data.reserve(data.size() + values.size() / numColumns);
+  for (std::vector<int>::const_iterator row = values.begin(); row != values.end(); row += numColumns) {
+    data.emplace(row, row + numColumns);
+  }
+}
+
 Header Table::getHeader() const {
   return header;
 }
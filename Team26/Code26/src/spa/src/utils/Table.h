@@ -61,6 +61,13 @@ public:
    */
   void insertRow(const Row& row);
 
+  /**
+   * Inserts many rows into Table at once, reserving space for all of them first.
+   *
+   * @param values The values of the rows, laid out one row after another.
+   */
+  void insertRows(const std::vector<int>& values);
+
   /**
    * @return The headers of the Table.
    */
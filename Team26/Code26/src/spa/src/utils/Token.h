@@ -1,7 +1,11 @@
 #pragma once
 
+#include <stdint.h>
+
 #include <string>
 
+#include "Span.h"
+
 /**
  * Defines the types of Tokens that we can have.
  *
@@ -63,6 +67,48 @@ struct Token {
   }
 };
 
+/**
+ * Compact token produced by scanning a source text in place. Instead of a copy of its
+ * value, it holds where the value lies in the text, so tokenising allocates nothing per
+ * token and the text must outlive the token.
+ */
+struct SourceToken {
+  // The type of the token.
+  TokenType type;
+
+  // Offset of the first character of the value in the text.
+  uint32_t offset;
+
+  // Number of characters in the value.
+  uint32_t length;
+
+  // Line of the first character, starting from 1.
+  uint32_t line;
+
+  // Column of the first character within its line, starting from 1.
+  uint32_t column;
+
+  /**
+   * Copies the value of the token out of the text it was scanned from.
+   *
+   * @param text The text the token was scanned from.
+   * @returns The value of the token.
+   */
+  std::string getValue(const Span<char>& text) const {
+    return std::string(text.begin() + offset, length);
+  }
+
+  /**
+   * Converts the token into a standalone Token owning a copy of its value.
+   *
+   * @param text The text the token was scanned from.
+   * @returns Token with the same type and value.
+   */
+  Token toToken(const Span<char>& text) const {
+    return { type, getValue(text) };
+  }
+};
+
 namespace std {
   /**
    * Hash function for the Token class.
@@ -0,0 +1,43 @@
+#include "TokenCursor.h"
+
+#include <assert.h>
+
+#include <iterator>
+#include <list>
+
+#include "Span.h"
+#include "Token.h"
+#include "Tokeniser.h"
+
+TokenCursor::TokenCursor(const Span<char>& text, const Tokeniser& tokeniser)
+  : text(text), tokeniser(tokeniser), position(START_OF_TEXT) {
+}
+
+TokenCursor::TokenCursor(std::list<Token> tokens) : position(START_OF_TEXT) {
+  pending.swap(tokens);
+}
+
+void TokenCursor::fill(size_t numTokens) {
+  SourceToken token;
+  while (pending.size() < numTokens && tokeniser.scanToken(text, position, token)) {
+    pending.push_back(token.toToken(text));
+  }
+}
+
+bool TokenCursor::hasToken(size_t ahead) {
+  assert(ahead <= MAX_LOOK_AHEAD);
+  fill(ahead + 1);
+  return pending.size() > ahead;
+}
+
+const Token& TokenCursor::peek(size_t ahead) {
+  const bool isPresent = hasToken(ahead);
+  assert(isPresent);
+  return *std::next(pending.begin(), ahead);
+}
+
+void TokenCursor::advance() {
+  fill(1);
+  assert(!pending.empty());
+  pending.pop_front();
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <list>
+
+#include "Span.h"
+#include "Token.h"
+#include "Tokeniser.h"
+
+/**
+ * Cursor over a sequence of tokens, for parsers that look a bounded number of tokens ahead.
+ *
+ * A cursor over a text tokenises it as tokens are pulled, so that at most MAX_LOOK_AHEAD + 1
+ * tokens are held at a time rather than the tokens of the whole text. A cursor over a list of
+ * tokens walks the list.
+ */
+class TokenCursor {
+private:
+  Span<char> text;
+  Tokeniser tokeniser;
+  ScanPosition position;
+
+  // Tokens pulled from the text but not consumed yet, in order
+  std::list<Token> pending;
+
+  /**
+   * Pulls tokens from the text until the given number are pending or the text has no more
+   * tokens.
+   *
+   * @param numTokens Number of tokens wanted.
+   */
+  void fill(size_t numTokens);
+
+public:
+  // Number of tokens after the next one that can be looked at
+  static const size_t MAX_LOOK_AHEAD = 1;
+
+  /**
+   * Constructs a cursor that tokenises a text as tokens are pulled.
+   *
+   * @param text The text to tokenise, which must outlive the cursor.
+   * @param tokeniser The tokeniser to tokenise it with.
+   */
+  TokenCursor(const Span<char>& text, const Tokeniser& tokeniser);
+
+  /**
+   * Constructs a cursor over tokens that have already been tokenised.
+   *
+   * @param tokens The tokens to walk.
+   */
+  TokenCursor(std::list<Token> tokens);
+
+  /**
+   * Checks if there is a token the given number of tokens after the next one.
+   * Throws TokeniserException if the text cannot be tokenised up to that token.
+   *
+   * @param ahead Number of tokens to look past, at most MAX_LOOK_AHEAD.
+   * @returns `true` if there is such a token, `false` otherwise.
+   */
+  bool hasToken(size_t ahead = 0);
+
+  /**
+   * Returns the token the given number of tokens after the next one, without consuming it.
+   * Pre-condition: hasToken(ahead) is `true`.
+   *
+   * @param ahead Number of tokens to look past, at most MAX_LOOK_AHEAD.
+   * @returns The token, valid until the cursor is advanced.
+   */
+  const Token& peek(size_t ahead = 0);
+
+  /**
+   * Consumes the next token.
+   * Pre-condition: hasToken() is `true`.
+   */
+  void advance();
+};
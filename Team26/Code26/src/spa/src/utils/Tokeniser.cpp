@@ -1,103 +1,269 @@
 #include "Tokeniser.h"
 
-#include <fstream>
-#include <iostream>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <array>
+#include <iterator>
 #include <list>
 #include <string>
-#include <unordered_set>
+#include <vector>
+
+#include "Span.h"
+#include "Token.h"
 
 namespace {
+  /**
+   * Classes a character can belong to. They are bit flags, so that a character can belong to
+   * several and testing for any of several classes is a single lookup and mask.
+   */
+  namespace CharClass {
+    const uint16_t ALPHA = 1 << 0;
+    const uint16_t DIGIT = 1 << 1;
+    const uint16_t WHITESPACE = 1 << 2;
+    const uint16_t DELIMITER = 1 << 3;
+    const uint16_t SINGLE_OPERATOR = 1 << 4;
+    const uint16_t CAN_HAVE_EQUALS = 1 << 5;
+    const uint16_t EXPECT_EQUALS = 1 << 6;
+    const uint16_t EXPECT_AMPERSAND = 1 << 7;
+    const uint16_t EXPECT_SHEFFER_STROKE = 1 << 8;
+    const uint16_t OPERATOR = SINGLE_OPERATOR | CAN_HAVE_EQUALS | EXPECT_EQUALS |
+      EXPECT_AMPERSAND | EXPECT_SHEFFER_STROKE;
+  }
+
+  /**
+   * Adds a class to each of the given characters.
+   *
+   * @param classes Table of the classes of each character.
+   * @param chars The characters to add the class to.
+   * @param charClass The class to add.
+   */
+  void addClass(std::array<uint16_t, 256>& classes, const std::string& chars, uint16_t charClass) {
+    for (const char c : chars) {
+      classes[(unsigned char)c] |= charClass;
+    }
+  }
+
+  /**
+   * Builds the table of the classes of each character. Letters, digits and whitespace are
+   * those of the "C" locale, as with std::isalpha, std::isdigit and std::isspace.
+   *
+   * @returns Classes of each character, indexed by the character as an unsigned char.
+   */
+  std::array<uint16_t, 256> buildCharClasses() {
+    std::array<uint16_t, 256> classes;
+    classes.fill(0);
+    addClass(classes, "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ", CharClass::ALPHA);
+    addClass(classes, "0123456789", CharClass::DIGIT);
+    addClass(classes, " \t\n\v\f\r", CharClass::WHITESPACE);
+    addClass(classes, "{}();_\",.#", CharClass::DELIMITER);
+    addClass(classes, "+-*/%", CharClass::SINGLE_OPERATOR);
+    addClass(classes, "><=!", CharClass::CAN_HAVE_EQUALS);
+    addClass(classes, "&", CharClass::EXPECT_AMPERSAND);
+    addClass(classes, "|", CharClass::EXPECT_SHEFFER_STROKE);
+    return classes;
+  }
+
+  // Looked up once per character of input, instead of testing the character against sets
+  const std::array<uint16_t, 256> CHAR_CLASSES = buildCharClasses();
+
+  /**
+   * Checks if a character belongs to any of the given classes.
+   *
+   * @param c The character to check, or EOF.
+   * @param classes The classes to check for.
+   * @returns `true` if the character belongs to any of them, `false` otherwise.
+   */
+  bool isInClass(int c, uint16_t classes) {
+    return c != EOF && (CHAR_CLASSES[(unsigned char)c] & classes) != 0;
+  }
+
+  /**
+   * Cursor over the text being tokenised, which keeps track of the line and column it is at
+   * so that tokens and errors can point back into the source.
+   */
+  class Scanner {
+  private:
+    const Span<char>& text;
+    ScanPosition& position;
+
+  public:
+    Scanner(const Span<char>& text, ScanPosition& position) : text(text), position(position) {
+    }
+
+    /**
+     * Returns the next character without consuming it, like std::istream::peek.
+     *
+     * @returns The next character as an unsigned char, or EOF at the end of the text.
+     */
+    int peek() const {
+      return position.offset < text.size() ? (unsigned char)text.begin()[position.offset] : EOF;
+    }
+
+    /**
+     * Returns the classes of the next character without consuming it.
+     *
+     * @returns The classes of the next character, or none at the end of the text.
+     */
+    uint16_t peekClasses() const {
+      if (position.offset == text.size()) {
+        return 0;
+      }
+      return CHAR_CLASSES[(unsigned char)text.begin()[position.offset]];
+    }
+
+    /**
+     * Consumes the next character.
+     *
+     * @returns The consumed character.
+     */
+    char get() {
+      const char c = text.begin()[position.offset++];
+      if (c == '\n') {
+        position.line++;
+        position.column = 1;
+      } else {
+        position.column++;
+      }
+      return c;
+    }
+
+    /**
+     * Consumes characters for as long as they belong to any of the given classes.
+     *
+     * @param classes The classes of the characters to consume.
+     */
+    void skipWhile(uint16_t classes) {
+      const char* const data = text.begin();
+      const size_t size = text.size();
+      size_t offset = position.offset;
+      while (offset < size && (CHAR_CLASSES[(unsigned char)data[offset]] & classes) != 0) {
+        if (data[offset++] == '\n') {
+          position.line++;
+          position.column = 1;
+        } else {
+          position.column++;
+        }
+      }
+      position.offset = offset;
+    }
+
+    /**
+     * Starts a token at the next character.
+     *
+     * @param type The type of the token.
+     * @returns Token of no characters, to be ended with endToken.
+     */
+    SourceToken startToken(TokenType type) const {
+      return { type, (uint32_t)position.offset, 0, position.line, position.column };
+    }
+
+    /**
+     * Ends a token just before the next character.
+     *
+     * @param token Token started with startToken.
+     * @returns The token spanning all characters consumed since it was started.
+     */
+    SourceToken endToken(SourceToken token) const {
+      token.length = (uint32_t)(position.offset - token.offset);
+      return token;
+    }
+
+    /**
+     * Describes the next character and where it is, for error messages.
+     *
+     * @returns Description of the next character.
+     */
+    std::string describeNext() const {
+      const std::string where = " at line " + std::to_string(position.line) + ", column " +
+        std::to_string(position.column);
+      if (peek() == EOF) {
+        return "end of input" + where;
+      }
+      return "'" + std::string(1, (char)peek()) + "'" + where;
+    }
+  };
+
   /**
    * Checks if a given character is a delimiter or not.
    *
    * @param c The character to check.
    * @returns `true` if the character is a delimiter, `false` otherwise.
    */
-  bool isDelimiter(char c) {
-    std::unordered_set<char> delims{ '{' , '}', '(', ')', ';', '_', '"', ',', '.', '#' };
-    return delims.count(c) > 0;
+  bool isDelimiter(int c) {
+    return isInClass(c, CharClass::DELIMITER);
   }
 
   /**
    * Constructs a Token from a delimiter.
    *
-   * @param stream The stream to read from.
-   * @returns Token representing a delimiter. Throws std::invalid_argument
+   * @param scanner The scanner to read from.
+   * @returns Token representing a delimiter. Throws TokeniserException
    *    if a non-delimiter character is encountered.
    */
-  Token constructDelimiter(std::istream& stream) {
-    TokenType type = TokenType::DELIMITER;
-    std::string value;
+  SourceToken constructDelimiter(Scanner& scanner) {
+    SourceToken token = scanner.startToken(TokenType::DELIMITER);
 
-    bool isNextCharDelimiter = isDelimiter(stream.peek());
+    bool isNextCharDelimiter = isDelimiter(scanner.peek());
     if (isNextCharDelimiter) {
-      value.push_back(stream.get());
+      scanner.get();
     } else {
-      throw TokeniserException("Expected one of {}();_\", but got " + stream.peek());
+      throw TokeniserException("Expected one of {}();_\",.# but got " + scanner.describeNext());
     }
 
-    return { type, value };
+    return scanner.endToken(token);
   }
 
   /**
    * Constructs a Token from an identifier.
    * Identifiers cannot have a digit as the first character.
    *
-   * @param stream The stream to read from.
+   * @param scanner The scanner to read from.
    * @returns Token representing an identifier.
    */
-  Token constructIdentifier(std::istream& stream) {
-    TokenType type = TokenType::IDENTIFIER;
-    std::string value;
+  SourceToken constructIdentifier(Scanner& scanner) {
+    SourceToken token = scanner.startToken(TokenType::IDENTIFIER);
 
-    bool isFirstChar = true;
-
-    while (std::isalnum(stream.peek())) {
-      bool isFirstCharDigit = isFirstChar && std::isdigit(stream.peek());
-
-      // Identifiers cannot have digits as the first character.
-      if (isFirstCharDigit) {
-        throw TokeniserException("Encountered a digit as the first character of a name.");
-      } else {
-        isFirstChar = false;
-      }
-      value.push_back(stream.get());
+    // Identifiers cannot have digits as the first character.
+    if (isInClass(scanner.peek(), CharClass::DIGIT)) {
+      throw TokeniserException("Encountered a digit as the first character of a name " +
+        scanner.describeNext());
     }
 
-    return { type, value };
+    scanner.skipWhile(CharClass::ALPHA | CharClass::DIGIT);
+
+    return scanner.endToken(token);
   }
 
   /**
    * Constructs a Token from a number.
    * Numbers cannot have 0 as the first digit.
    *
-   * @param stream The stream to read from.
+   * @param scanner The scanner to read from.
+   * @param isAllowLeadingZeroes Whether numbers may have 0 as the first digit.
    * @returns Token representing a number.
    */
-  Token constructNumber(std::istream& stream, bool isAllowLeadingZeroes) {
-    TokenType type = TokenType::NUMBER;
-    std::string value;
-
-    bool isFirstChar = true;
-
-    while (std::isdigit(stream.peek())) {
-      // Since we peek ahead, if value equals "0" at any time it means that
-      // we are at least on the second digit, hence an invalid construction.
-      if (value == "0") {
-        if (!isAllowLeadingZeroes) {
-          throw TokeniserException("Encountered 0 as the first digit of a number.");
-        }
-      }
+  SourceToken constructNumber(Scanner& scanner, bool isAllowLeadingZeroes) {
+    SourceToken token = scanner.startToken(TokenType::NUMBER);
 
-      value.push_back(stream.get());
-    }
+    if (scanner.peek() == '0' && !isAllowLeadingZeroes) {
+      scanner.get();
 
-    if (std::isalpha(stream.peek())) {
-      throw TokeniserException("Encountered an alphabetical letter while constructing a number.");
+      // Any digit after a first digit of 0 is an invalid construction.
+      if (isInClass(scanner.peek(), CharClass::DIGIT)) {
+        throw TokeniserException("Encountered 0 as the first digit of a number before " +
+          scanner.describeNext());
+      }
     }
+    scanner.skipWhile(CharClass::DIGIT);
 
-    return { type, value };
+    if (isInClass(scanner.peek(), CharClass::ALPHA)) {
+      throw TokeniserException(
+        "Encountered an alphabetical letter while constructing a number: " +
+        scanner.describeNext());
+    }
 
+    return scanner.endToken(token);
   }
 
   /**
@@ -107,10 +273,8 @@ namespace {
    * @param c The character to check.
    * @returns `true` if the character is a single-character operator, `false` otherwise.
    */
-  bool isSingleOperator(char c) {
-    std::unordered_set<char> singleOperators{ '+', '-', '*', '/', '%' };
-
-    return singleOperators.count(c) > 0;
+  bool isSingleOperator(int c) {
+    return isInClass(c, CharClass::SINGLE_OPERATOR);
   }
 
   /**
@@ -124,10 +288,8 @@ namespace {
    * @returns `true` if the character is the first char of a double-character
    *    operator, `false` otherwise.
    */
-  bool isCanHaveEquals(char c) {
-    std::unordered_set<char> canHaveEquals{ '>', '<', '=', '!' };
-
-    return canHaveEquals.count(c) > 0;
+  bool isCanHaveEquals(int c) {
+    return isInClass(c, CharClass::CAN_HAVE_EQUALS);
   }
 
   /**
@@ -141,10 +303,8 @@ namespace {
    * @returns `true` if the character is the first char of a double-character
    *    operator, `false` otherwise.
    */
-  bool isExpectEquals(char c) {
-    std::unordered_set<char> expectEquals;
-
-    return expectEquals.count(c) > 0;
+  bool isExpectEquals(int c) {
+    return isInClass(c, CharClass::EXPECT_EQUALS);
   }
 
   /**
@@ -156,10 +316,8 @@ namespace {
    * @returns `true` if the character is the first char of a double-character
    *    operator, `false` otherwise.
    */
-  bool isExpectAmpersand(char c) {
-    std::unordered_set<char> expectAmpersand{ '&' };
-
-    return expectAmpersand.count(c) > 0;
+  bool isExpectAmpersand(int c) {
+    return isInClass(c, CharClass::EXPECT_AMPERSAND);
   }
 
   /**
@@ -171,10 +329,8 @@ namespace {
    * @returns `true` if the character is the first char of a double-character
    *    operator, `false` otherwise.
    */
-  bool isExpectShefferStroke(char c) {
-    std::unordered_set<char> expectShefferStroke{ '|' };
-
-    return expectShefferStroke.count(c) > 0;
+  bool isExpectShefferStroke(int c) {
+    return isInClass(c, CharClass::EXPECT_SHEFFER_STROKE);
   }
 
   /**
@@ -184,122 +340,114 @@ namespace {
    * @returns `true` if the character is an operator or the first
    *    character of a two-character operator, `false` otherwise.
    */
-  bool isOperator(char c) {
-    return isSingleOperator(c) ||
-      isCanHaveEquals(c) ||
-      isExpectEquals(c) ||
-      isExpectAmpersand(c) ||
-      isExpectShefferStroke(c);
+  bool isOperator(int c) {
+    return isInClass(c, CharClass::OPERATOR);
   }
 
   /**
    * Constructs a Token from an operator.
    *
-   * @param stream The stream to read from.
+   * @param scanner The scanner to read from.
    * @returns Token representing an operator.
    */
-  Token constructOperator(std::istream& stream) {
-    TokenType type = TokenType::OPERATOR;
-    std::string value;
+  SourceToken constructOperator(Scanner& scanner) {
+    SourceToken token = scanner.startToken(TokenType::OPERATOR);
 
     // We need to treat the operators depending on the first char
     // we see, since some operators consist of two characters e.g. <=
     // We thus need to also perform checks to ensure that the two character
     // operators are valid e.g. we allow <= but not !<
 
-    if (!isOperator(stream.peek())) {
-      throw TokeniserException("Expected one of +-*/%>=<!&| but got " + stream.peek());
+    if (!isOperator(scanner.peek())) {
+      throw TokeniserException("Expected one of +-*/%>=<!&| but got " + scanner.describeNext());
     }
 
-    if (isSingleOperator(stream.peek())) {
-      value.push_back(stream.get());
-      return { type, value };
+    if (isSingleOperator(scanner.peek())) {
+      scanner.get();
+      return scanner.endToken(token);
     }
 
     // We distinguish the cases where the operator is valid with or without
     // an = after it, and the cases where the operator is invalid without 
     // an = after it. Right now, there aren't any operators that are invalid
     // without an = after it, but for extensibility we'll leave this logic in.
-    if (isCanHaveEquals(stream.peek())) {
-      value.push_back(stream.get());
-      bool isNextCharEquals = stream.peek() == '=';
+    if (isCanHaveEquals(scanner.peek())) {
+      scanner.get();
+      bool isNextCharEquals = scanner.peek() == '=';
 
       if (isNextCharEquals) {
-        value.push_back(stream.get());
+        scanner.get();
       }
 
-      return { type, value };
+      return scanner.endToken(token);
     }
 
-    if (isExpectEquals(stream.peek())) {
-      value.push_back(stream.get());
-      bool isNextCharEquals = stream.peek() == '=';
+    if (isExpectEquals(scanner.peek())) {
+      scanner.get();
+      bool isNextCharEquals = scanner.peek() == '=';
 
       if (isNextCharEquals) {
-        value.push_back(stream.get());
+        scanner.get();
       } else {
-        throw TokeniserException("Expected = but got " + stream.peek());
+        throw TokeniserException("Expected = but got " + scanner.describeNext());
       }
 
-      return { type, value };
+      return scanner.endToken(token);
     }
 
-    if (isExpectAmpersand(stream.peek())) {
-      value.push_back(stream.get());
-      bool isNextCharAmpersand = stream.peek() == '&';
+    if (isExpectAmpersand(scanner.peek())) {
+      scanner.get();
+      bool isNextCharAmpersand = scanner.peek() == '&';
 
       if (isNextCharAmpersand) {
-        value.push_back(stream.get());
+        scanner.get();
       } else {
-        throw TokeniserException("Expected & but got " + stream.peek());
+        throw TokeniserException("Expected & but got " + scanner.describeNext());
       }
 
-      return { type, value };
+      return scanner.endToken(token);
     }
 
-    if (isExpectShefferStroke(stream.peek())) {
-      value.push_back(stream.get());
-      bool isNextCharShefferStroke = stream.peek() == '|';
+    if (isExpectShefferStroke(scanner.peek())) {
+      scanner.get();
+      bool isNextCharShefferStroke = scanner.peek() == '|';
 
       if (isNextCharShefferStroke) {
-        value.push_back(stream.get());
+        scanner.get();
       } else {
-        throw TokeniserException("Expected | but got " + stream.peek());
+        throw TokeniserException("Expected | but got " + scanner.describeNext());
       }
 
-      return { type, value };
+      return scanner.endToken(token);
     }
 
-    throw TokeniserException("Failed to construct operator, got " + stream.peek());
+    throw TokeniserException("Failed to construct operator, got " + scanner.describeNext());
   }
 
   /**
    * Constructs a Token from a whitespace.
    *
-   * @param stream The stream to read from.
+   * @param scanner The scanner to read from.
    * @returns Token representing a single whitespace character.
    */
-  Token constructWhitespace(std::istream& stream) {
-    TokenType type = TokenType::WHITESPACE;
-    std::string value;
+  SourceToken constructWhitespace(Scanner& scanner) {
+    SourceToken token = scanner.startToken(TokenType::WHITESPACE);
 
-    if (!std::isspace(stream.peek())) {
-      throw TokeniserException("Expected whitespace character but got " + stream.peek());
+    if (!isInClass(scanner.peek(), CharClass::WHITESPACE)) {
+      throw TokeniserException("Expected whitespace character but got " + scanner.describeNext());
     }
-    value.push_back(stream.get());
-    return { type, value };
+    scanner.get();
+    return scanner.endToken(token);
   }
 
   /**
    * Help to discard whitespace characters.
-   * Advances the stream until it encounters a non-whitespace character.
+   * Advances the scanner until it encounters a non-whitespace character.
    *
-   * @param stream The stream to read from.
+   * @param scanner The scanner to read from.
    */
-  void consumeWhitespace(std::istream& stream) {
-    while (std::isspace(stream.peek())) {
-      stream.get();
-    }
+  void consumeWhitespace(Scanner& scanner) {
+    scanner.skipWhile(CharClass::WHITESPACE);
   }
 }
 
@@ -307,33 +455,67 @@ TokeniserException::TokeniserException(const std::string& msg)
   : std::exception(("[Tokeniser Parsing Error] " + msg).c_str()) {}
 
 std::list<Token> Tokeniser::tokenise(std::istream& stream) {
-  std::list<Token> tokens;
+  const std::string text((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+  const Span<char> textSpan(text.data(), text.data() + text.size());
+  return toTokens(textSpan, tokenise(textSpan));
+}
+
+std::vector<SourceToken> Tokeniser::tokenise(const Span<char>& text) const {
+  std::vector<SourceToken> tokens;
+  // Tokens of SIMPLE programs average a few characters including the whitespace after them
+  tokens.reserve(text.size() / 4);
+  ScanPosition position = START_OF_TEXT;
+  SourceToken token;
+  while (scanToken(text, position, token)) {
+    tokens.push_back(token);
+  }
+  return tokens;
+}
+
+bool Tokeniser::scanToken(const Span<char>& text, ScanPosition& position, SourceToken& token) const {
+  if (text.size() > UINT32_MAX) {
+    throw TokeniserException("Text of " + std::to_string(text.size()) +
+      " characters is too long to tokenise.");
+  }
 
-  while (stream.peek() != EOF) {
-    bool isAlphabet = std::isalpha(stream.peek());
-    bool isDigit = std::isdigit(stream.peek());
-    bool isWhitespace = std::isspace(stream.peek());
+  Scanner scanner(text, position);
+  while (scanner.peek() != EOF) {
+    const uint16_t classes = scanner.peekClasses();
+    bool isAlphabet = (classes & CharClass::ALPHA) != 0;
+    bool isDigit = (classes & CharClass::DIGIT) != 0;
+    bool isWhitespace = (classes & CharClass::WHITESPACE) != 0;
 
     if (isAlphabet) {
-      tokens.push_back(constructIdentifier(stream));
-    } else if (isDelimiter(stream.peek())) {
-      tokens.push_back(constructDelimiter(stream));
+      token = constructIdentifier(scanner);
+    } else if ((classes & CharClass::DELIMITER) != 0) {
+      token = constructDelimiter(scanner);
     } else if (isDigit) {
-      tokens.push_back(constructNumber(stream, isAllowLeadingZeroes));
-    } else if (isOperator(stream.peek())) {
-      tokens.push_back(constructOperator(stream));
+      token = constructNumber(scanner, isAllowLeadingZeroes);
+    } else if ((classes & CharClass::OPERATOR) != 0) {
+      token = constructOperator(scanner);
     } else if (isWhitespace) {
       if (!isConsumeWhitespace) {
-        tokens.push_back(constructWhitespace(stream));
+        token = constructWhitespace(scanner);
       } else {
-        consumeWhitespace(stream);
+        consumeWhitespace(scanner);
+        continue;
       }
     } else {
-      throw TokeniserException("Failed to recognise character " + stream.peek());
+      throw TokeniserException("Failed to recognise " + scanner.describeNext());
     }
+    return true;
   }
 
-  return tokens;
+  return false;
+}
+
+std::list<Token> Tokeniser::toTokens(const Span<char>& text,
+  const std::vector<SourceToken>& tokens) {
+  std::list<Token> standaloneTokens;
+  for (const SourceToken& token : tokens) {
+    standaloneTokens.push_back(token.toToken(text));
+  }
+  return standaloneTokens;
 }
 
 Tokeniser Tokeniser::consumingWhitespace() {
@@ -2,19 +2,42 @@
 
 #include "Token.h"
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <fstream>
 #include <list>
 #include <string>
+#include <vector>
+
+#include "Span.h"
 
 class TokeniserException : public std::exception {
 public:
   TokeniserException(const std::string& msg);
 };
 
+/**
+ * Where a Tokeniser is in a text that it tokenises a token at a time.
+ */
+struct ScanPosition {
+  // Offset of the next character in the text.
+  size_t offset;
+
+  // Line of the next character, starting from 1.
+  uint32_t line;
+
+  // Column of the next character within its line, starting from 1.
+  uint32_t column;
+};
+
+// Position at the start of any text
+const ScanPosition START_OF_TEXT{ 0, 1, 1 };
+
 /**
  * Concrete API for the Tokeniser.
- * Handles conversion of a file (given as an input file stream)
- * into a list of Tokens for parsing.
+ * Handles conversion of a file (given as an input file stream, or as text
+ * already in memory such as a MappedFile) into a list of Tokens for parsing.
  *
  * @author Darien Chong
  */
@@ -52,6 +75,41 @@ public:
    */
   std::list<Token> tokenise(std::istream& stream);
 
+  /**
+   * Tokenises text in place, without copying any of it. SIMPLE programs and
+   * PQL queries are scanned by the same engine; tokenise(std::istream&) reads
+   * the stream into memory and then scans it this way.
+   *
+   * @param text The text to tokenise, which must outlive the tokens.
+   * @returns Tokens referring into the text, in order. Throws
+   *    TokeniserException on the first character that cannot be tokenised.
+   */
+  std::vector<SourceToken> tokenise(const Span<char>& text) const;
+
+  /**
+   * Scans the next token of a text in place, for tokenising it a token at a
+   * time. Consumed whitespace before the token is skipped.
+   *
+   * @param text The text to tokenise, which must outlive the token.
+   * @param position Where to scan from, starting at START_OF_TEXT. It is
+   *    advanced past the token.
+   * @param token Set to the token scanned, if any.
+   * @returns `true` if a token was scanned, `false` if the text has no more
+   *    tokens. Throws TokeniserException on a character that cannot be
+   *    tokenised.
+   */
+  bool scanToken(const Span<char>& text, ScanPosition& position, SourceToken& token) const;
+
+  /**
+   * Converts tokens scanned in place into standalone Tokens for parsing.
+   *
+   * @param text The text the tokens were scanned from.
+   * @param tokens The tokens to convert.
+   * @returns List of Tokens with copies of their values.
+   */
+  static std::list<Token> toTokens(const Span<char>& text,
+    const std::vector<SourceToken>& tokens);
+
   /**
    * Returns a Tokeniser that consumes all encountered whitespace characters
    * while tokenizing. The default behaviour is to consume whitespace.
@@ -0,0 +1,56 @@
+#include "catch.hpp"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "AffectsBipAnalysis.h"
+#include "Cfg.h"
+
+TEST_CASE("AffectsBip analysis scales with the facts generated", "[AffectsBip]") {
+  // procedure First { 1..n: x = x + v1..vn; n + 1: call Second; }
+  // procedure Second { n + 2..2n + 1: x = x + w1..wn; }
+  // Only x ever carries a fact, while the 2n + 1 variables would give each node a dense
+  // matrix of (2n + 1) * (4n + 1) bits.
+  const int n = 1000;
+  const int x = 0;
+  Cfg::Cfg cfg;
+  std::unordered_map<int, int> assignToVarModified;
+  std::unordered_map<int, std::vector<int>> assignToVarsUsed;
+  for (int stmt = 1; stmt <= 2 * n + 1; stmt++) {
+    if (stmt == n + 1) {
+      cfg.addEdge(stmt, -1);
+      continue;
+    }
+    cfg.addEdge(stmt, stmt == 2 * n + 1 ? -(n + 2) : stmt + 1);
+    assignToVarModified.emplace(stmt, x);
+    assignToVarsUsed.emplace(stmt, std::vector<int>{ x, stmt });
+  }
+  cfg.freeze();
+  cfg.initialiseCfgBip({ "First", "Second" }, { { "First", 1 }, { "Second", n + 2 } }, { { n + 1, "Second" } });
+  const size_t numNodes = cfg.getCfgBip().getNumNodes();
+
+  SECTION("AffectsBip") {
+    const Cfg::AffectsBipAnalysis affectsBip(cfg, assignToVarModified, {}, assignToVarsUsed, false);
+    const std::vector<std::pair<int, int>>& relation = affectsBip.getRelation();
+    REQUIRE(relation.size() == 2 * n - 1);
+    REQUIRE(std::find(relation.begin(), relation.end(), std::make_pair(n, n + 2)) != relation.end());
+    REQUIRE(std::find(relation.begin(), relation.end(), std::make_pair(n - 1, n)) != relation.end());
+
+    // At most x and one fact per node in each phase
+    REQUIRE(affectsBip.getNumFacts() <= 4 * numNodes);
+  }
+
+  SECTION("AffectsBipT") {
+    const Cfg::AffectsBipAnalysis affectsBipT(cfg, assignToVarModified, {}, assignToVarsUsed, true);
+    const std::vector<std::pair<int, int>>& relation = affectsBipT.getRelation();
+    REQUIRE(relation.size() == (size_t)n * (2 * n - 1));
+    REQUIRE(std::find(relation.begin(), relation.end(), std::make_pair(1, 2 * n + 1)) != relation.end());
+
+    // The facts on entry to each assign statement are the pairs it completes, along with the
+    // tokens of the variables used before it when summarising
+    REQUIRE(affectsBipT.getNumFacts() <= 4 * (numNodes + relation.size()));
+  }
+}
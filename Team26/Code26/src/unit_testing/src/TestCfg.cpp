@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "Cfg.h"
+#include "Span.h"
 
 TEST_CASE("CFG", "[CFG]") {
   Cfg::Cfg cfg;
@@ -10,9 +11,10 @@ TEST_CASE("CFG", "[CFG]") {
   cfg.addEdge(1, 3);
   cfg.addEdge(1, 4);
   cfg.addEdge(4, 5);
+  cfg.freeze();
 
-  std::vector<int> neighbours1 = cfg.getNeighbours(1);
-  std::vector<int> neighbours4 = cfg.getNeighbours(4);
+  Span<int> neighbours1 = cfg.getNeighbours(1);
+  Span<int> neighbours4 = cfg.getNeighbours(4);
   REQUIRE(std::find(neighbours1.begin(), neighbours1.end(), 2) != neighbours1.end());
   REQUIRE(std::find(neighbours1.begin(), neighbours1.end(), 3) != neighbours1.end());
   REQUIRE(std::find(neighbours1.begin(), neighbours1.end(), 4) != neighbours1.end());
@@ -24,3 +26,122 @@ TEST_CASE("CFG", "[CFG]") {
   REQUIRE(cfg.getNeighbours(5).size() == 0);
   REQUIRE(cfg.getNeighbours(6).size() == 0);
 }
+
+TEST_CASE("CFG predecessors and dummy end nodes", "[CFG]") {
+  Cfg::Cfg cfg;
+  cfg.addEdge(1, 2);
+  cfg.addEdge(2, 1);
+  cfg.addEdge(1, 3);
+  cfg.addEdge(3, -1);
+  cfg.addEdge(4, -4);
+  cfg.freeze();
+
+  Span<int> predecessors1 = cfg.getPredecessors(1);
+  REQUIRE(predecessors1.size() == 1);
+  REQUIRE(predecessors1[0] == 2);
+  REQUIRE(cfg.getPredecessors(2).size() == 1);
+  REQUIRE(cfg.getPredecessors(4).empty());
+
+  // Successors keep the order in which their edges were added
+  Span<int> neighbours1 = cfg.getNeighbours(1);
+  REQUIRE(neighbours1.size() == 2);
+  REQUIRE(neighbours1[0] == 2);
+  REQUIRE(neighbours1[1] == 3);
+
+  // Dummy end nodes have their own rows, apart from the statements
+  Span<int> predecessorsOfDummy1 = cfg.getPredecessors(-1);
+  REQUIRE(predecessorsOfDummy1.size() == 1);
+  REQUIRE(predecessorsOfDummy1[0] == 3);
+  REQUIRE(cfg.getPredecessors(-4).size() == 1);
+  REQUIRE(cfg.getNeighbours(-1).empty());
+  REQUIRE(cfg.getPredecessors(-5).empty());
+
+  // Edges added after freezing are laid out by the next freeze
+  cfg.addEdge(4, 5);
+  REQUIRE(!cfg.isFrozen());
+  cfg.freeze();
+  REQUIRE(cfg.getNeighbours(4).size() == 2);
+  REQUIRE(cfg.getPredecessors(5).size() == 1);
+  REQUIRE(cfg.getPredecessors(-4).size() == 1);
+}
+
+TEST_CASE("CFGBip arena", "[CFG][CfgBip]") {
+  // procedure First { 1: call Second; 2: x = 1; } procedure Second { 3: while { 4: y = 2; } }
+  Cfg::Cfg cfg;
+  cfg.addEdge(1, 2);
+  cfg.addEdge(2, -1);
+  cfg.addEdge(3, 4);
+  cfg.addEdge(4, 3);
+  cfg.addEdge(3, -3);
+  cfg.freeze();
+  cfg.initialiseCfgBip({ "First", "Second" }, { { "First", 1 }, { "Second", 3 } }, { { 1, "Second" } });
+
+  const Cfg::CfgBip& cfgBip = cfg.getCfgBip();
+  const std::vector<Cfg::ProcedureBip>& procs = cfgBip.getProcedureBips();
+  REQUIRE(procs.size() == 2);
+  REQUIRE(cfgBip.getNumNodes() == 6);
+
+  // Nodes of each procedure are contiguous, statements first and the dummy end node last
+  REQUIRE(procs[1].procName == "Second");
+  REQUIRE(procs[1].firstNode == 3);
+  REQUIRE(procs[1].numNodes == 3);
+  REQUIRE(cfgBip.getNode(procs[1].start).node == 3);
+  REQUIRE(cfgBip.getNode(procs[1].end).node == -3);
+  REQUIRE(cfgBip.getNode(4).node == 4);
+  REQUIRE(cfgBip.getNode(4).proc == 1);
+
+  Span<Cfg::BipIndex> nextsOfWhile = cfgBip.getNexts(procs[1].start);
+  REQUIRE(nextsOfWhile.size() == 2);
+  REQUIRE(cfgBip.getNode(nextsOfWhile[0]).node == 4);
+  REQUIRE(cfgBip.getNode(nextsOfWhile[1]).node == -3);
+
+  // Predecessors mirror the successors
+  Span<Cfg::BipIndex> prevsOfWhile = cfgBip.getPrevs(procs[1].start);
+  REQUIRE(prevsOfWhile.size() == 1);
+  REQUIRE(cfgBip.getNode(prevsOfWhile[0]).node == 4);
+  REQUIRE(cfgBip.getPrevs(procs[1].end).size() == 1);
+  REQUIRE(cfgBip.getPrevs(procs[0].start).empty());
+
+  // Call statements know the procedure they call, which knows its callers
+  REQUIRE(cfgBip.getNode(procs[0].start).calledProc == 1);
+  REQUIRE(cfgBip.getNode(procs[1].start).calledProc == -1);
+  REQUIRE(procs[1].callers.size() == 1);
+  REQUIRE(procs[1].callers[0] == procs[0].start);
+  REQUIRE(procs[0].callers.empty());
+}
+
+TEST_CASE("CFG basic blocks", "[CFG]") {
+  // 1: x = 1; 2: while { 3: y = 2; 4: z = 3; } 5: if { 6: a = 1; } else { 7: b = 2; 8: c = 3; } 9: d = 4;
+  Cfg::Cfg cfg;
+  cfg.addEdge(1, 2);
+  cfg.addEdge(2, 3);
+  cfg.addEdge(3, 4);
+  cfg.addEdge(4, 2);
+  cfg.addEdge(2, 5);
+  cfg.addEdge(5, 6);
+  cfg.addEdge(5, 7);
+  cfg.addEdge(7, 8);
+  cfg.addEdge(6, 9);
+  cfg.addEdge(8, 9);
+  cfg.freeze();
+
+  REQUIRE(cfg.getNumBlocks() == 7);
+  REQUIRE(cfg.getBlock(1) == 0);
+  REQUIRE(cfg.getBlock(3) == cfg.getBlock(4));
+  REQUIRE(cfg.getBlock(7) == cfg.getBlock(8));
+  REQUIRE(cfg.getBlock(10) == -1);
+  REQUIRE(cfg.getBlock(-1) == -1);
+
+  const int loopBody = cfg.getBlock(3);
+  REQUIRE(cfg.getBlockFirstStmt(loopBody) == 3);
+  REQUIRE(cfg.getBlockLastStmt(loopBody) == 4);
+  REQUIRE(cfg.getBlockNexts(loopBody).size() == 1);
+  REQUIRE(cfg.getBlockNexts(loopBody)[0] == cfg.getBlock(2));
+  REQUIRE(cfg.getBlockPrevs(cfg.getBlock(9)).size() == 2);
+
+  // An edge into the middle of a block splits it
+  cfg.addEdge(1, 4);
+  cfg.freeze();
+  REQUIRE(cfg.getNumBlocks() == 8);
+  REQUIRE(cfg.getBlock(3) != cfg.getBlock(4));
+}
@@ -0,0 +1,34 @@
+#include "catch.hpp"
+
+#include <vector>
+
+#include "CondensedGraph.h"
+
+TEST_CASE("CondensedGraph", "[CondensedGraph]") {
+  // 0 -> 1 <-> 2 -> 3, 3 -> 3, 4 -> 0
+  std::vector<std::vector<int>> successors{ { 1 }, { 2 }, { 1, 3 }, { 3 }, { 0 } };
+  CondensedGraph graph(successors);
+
+  REQUIRE(graph.getNumComponents() == 4);
+  REQUIRE(graph.getComponent(1) == graph.getComponent(2));
+  REQUIRE(graph.isCyclic(graph.getComponent(1)));
+  REQUIRE(graph.isCyclic(graph.getComponent(3)));
+  REQUIRE(!graph.isCyclic(graph.getComponent(0)));
+
+  // Successors are numbered lower
+  for (size_t component = 0; component < graph.getNumComponents(); component++) {
+    for (const int successor : graph.getSuccessors(component)) {
+      REQUIRE(successor < (int)component);
+    }
+  }
+
+  const std::vector<BitVector>& reachable = graph.getReachableNodes();
+  REQUIRE(reachable[graph.getComponent(4)].getSetBits() == std::vector<size_t>{ 0, 1, 2, 3 });
+  REQUIRE(reachable[graph.getComponent(0)].getSetBits() == std::vector<size_t>{ 1, 2, 3 });
+  REQUIRE(reachable[graph.getComponent(1)].getSetBits() == std::vector<size_t>{ 1, 2, 3 });
+  REQUIRE(reachable[graph.getComponent(3)].getSetBits() == std::vector<size_t>{ 3 });
+
+  for (int node = 0; node < 5; node++) {
+    REQUIRE(graph.getReachableNodes(node) == reachable[graph.getComponent(node)]);
+  }
+}
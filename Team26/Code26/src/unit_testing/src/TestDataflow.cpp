@@ -0,0 +1,64 @@
+#include "catch.hpp"
+
+#include <vector>
+
+#include "BitVector.h"
+#include "Dataflow.h"
+
+TEST_CASE("BitVector", "[BitVector]") {
+  BitVector bits(130);
+  REQUIRE(bits.none());
+
+  bits.set(0);
+  bits.set(64);
+  bits.set(129);
+  REQUIRE(bits.test(0));
+  REQUIRE(bits.test(64));
+  REQUIRE(bits.test(129));
+  REQUIRE(!bits.test(1));
+  REQUIRE(bits.getSetBits() == std::vector<size_t>{ 0, 64, 129 });
+
+  BitVector other(130);
+  other.set(64);
+  REQUIRE(bits.intersects(other));
+  REQUIRE(!bits.unionWith(other));
+
+  other.set(100);
+  REQUIRE(bits.unionWith(other));
+  REQUIRE(bits.getSetBits() == std::vector<size_t>{ 0, 64, 100, 129 });
+
+  bits.subtract(other);
+  REQUIRE(bits.getSetBits() == std::vector<size_t>{ 0, 129 });
+  REQUIRE(!bits.intersects(other));
+
+  bits.reset(0);
+  bits.reset(129);
+  REQUIRE(bits.none());
+}
+
+TEST_CASE("Dataflow reaching definitions over a loop", "[Dataflow]") {
+  // 0: x = ...    (def 0)
+  // 1: while
+  // 2:   x = ...  (def 1)
+  // 3: ... = x
+  Dataflow::BitVectorProblem problem(4, 2);
+  problem.addEdge(0, 1);
+  problem.addEdge(1, 2);
+  problem.addEdge(2, 1);
+  problem.addEdge(1, 3);
+  problem.addGen(0, 0);
+  problem.addGen(2, 1);
+
+  BitVector defsOfX(2);
+  defsOfX.set(0);
+  defsOfX.set(1);
+  problem.addKill(0, defsOfX);
+  problem.addKill(2, defsOfX);
+
+  const Dataflow::Solution& solution = problem.solve();
+  REQUIRE(solution.in[0].none());
+  REQUIRE(solution.in[1].getSetBits() == std::vector<size_t>{ 0, 1 });
+  REQUIRE(solution.in[2].getSetBits() == std::vector<size_t>{ 0, 1 });
+  REQUIRE(solution.out[2].getSetBits() == std::vector<size_t>{ 1 });
+  REQUIRE(solution.in[3].getSetBits() == std::vector<size_t>{ 0, 1 });
+}
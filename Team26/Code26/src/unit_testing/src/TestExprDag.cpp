@@ -0,0 +1,47 @@
+#include "catch.hpp"
+
+#include <string>
+#include <unordered_map>
+
+#include "ExprDag.h"
+
+TEST_CASE("ExprDag", "[ExprDag]") {
+  std::unordered_map<std::string, int> names;
+  auto addName = [&names](const std::string& name) {
+    return names.emplace(name, (int)names.size()).first->second;
+  };
+  auto findName = [&names](const std::string& name) {
+    return names.count(name) == 0 ? -1 : names.at(name);
+  };
+
+  ExprDag dag;
+  // (a + b) * (a + b) and (a + b) * c share a + b and its leaves
+  const int square = dag.addPostfixExpr(" a b + a b + * ", addName);
+  REQUIRE(dag.getNumNodes() == 4);
+  const int product = dag.addPostfixExpr(" a b + c * ", addName);
+  REQUIRE(dag.getNumNodes() == 6);
+  REQUIRE(dag.addPostfixExpr(" a b + a b + * ", addName) == square);
+  REQUIRE(dag.getNumNodes() == 6);
+
+  const int sum = dag.findPostfixExpr(" a b + ", findName);
+  REQUIRE(sum == dag.addOperator('+', dag.addLeaf(names.at("a")), dag.addLeaf(names.at("b"))));
+  REQUIRE(dag.getNode(square).op == '*');
+  REQUIRE(dag.getNode(square).left == sum);
+  REQUIRE(dag.getNode(square).right == sum);
+
+  // Hashes depend on the structure only, not on the order nodes were added in
+  ExprDag otherDag;
+  otherDag.addPostfixExpr(" c ", addName);
+  REQUIRE(otherDag.getNode(otherDag.addPostfixExpr(" a b + ", addName)).hash == dag.getNode(sum).hash);
+
+  // Expressions not added are not found, and looking them up adds nothing
+  REQUIRE(dag.findPostfixExpr(" b a + ", findName) == -1);
+  REQUIRE(dag.findPostfixExpr(" a d + ", findName) == -1);
+  REQUIRE(dag.getNumNodes() == 6);
+
+  REQUIRE(dag.contains(square, sum));
+  REQUIRE(dag.contains(product, dag.findPostfixExpr(" c ", findName)));
+  REQUIRE(dag.contains(sum, sum));
+  REQUIRE_FALSE(dag.contains(square, dag.findPostfixExpr(" c ", findName)));
+  REQUIRE_FALSE(dag.contains(sum, product));
+}
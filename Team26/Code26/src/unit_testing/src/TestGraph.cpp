@@ -0,0 +1,55 @@
+#include "catch.hpp"
+
+#include <utility>
+#include <vector>
+
+#include "Graph.h"
+
+TEST_CASE("Graph", "[Graph]") {
+  // 0 -> 1 <-> 2 -> 3, 4 -> 0, 5 alone
+  const Graph graph(6, { { 0, 1 }, { 1, 2 }, { 2, 1 }, { 2, 3 }, { 4, 0 } });
+
+  REQUIRE(graph.getNumNodes() == 6);
+  REQUIRE(graph.getSuccessors(2).size() == 2);
+  REQUIRE(graph.getSuccessors(2)[0] == 1);
+  REQUIRE(graph.getPredecessors(1).size() == 2);
+  REQUIRE(graph.getSuccessors(5).empty());
+
+  // Nodes on or after the cycle are left out
+  REQUIRE(graph.getTopologicalOrder() == std::vector<int>{ 4, 5, 0 });
+
+  const std::vector<int>& sccs = graph.getStronglyConnectedComponents();
+  REQUIRE(sccs[1] == sccs[2]);
+  REQUIRE(sccs[3] < sccs[1]);
+  REQUIRE(sccs[1] < sccs[0]);
+  REQUIRE(sccs[0] < sccs[4]);
+
+  REQUIRE(graph.getConnectedComponents() == std::vector<int>{ 0, 0, 0, 0, 0, 1 });
+  REQUIRE(graph.getDepthFirstOrder(4) == std::vector<int>{ 4, 0, 1, 2, 3 });
+  REQUIRE(graph.getReachableNodes(0).getSetBits() == std::vector<size_t>{ 1, 2, 3 });
+  REQUIRE(graph.getReachableNodes(1).getSetBits() == std::vector<size_t>{ 1, 2, 3 });
+  REQUIRE(graph.getReachableNodes(3).none());
+}
+
+TEST_CASE("Graph topological order", "[Graph]") {
+  // Nodes of in-degree 0 in ascending order, then successors in the order of their edges
+  const Graph graph({ { 3, 2 }, { 2 }, {}, {} });
+  REQUIRE(graph.getTopologicalOrder() == std::vector<int>{ 0, 1, 3, 2 });
+}
+
+TEST_CASE("Graph algorithms do not recurse on long paths", "[Graph]") {
+  const int numNodes = 200000;
+  std::vector<std::pair<int, int>> edges;
+  for (int node = 0; node + 1 < numNodes; node++) {
+    edges.emplace_back(node, node + 1);
+  }
+  edges.emplace_back(numNodes - 1, 0);
+  const Graph graph(numNodes, edges);
+
+  REQUIRE(graph.getTopologicalOrder().empty());
+  const std::vector<int>& sccs = graph.getStronglyConnectedComponents();
+  REQUIRE(sccs.front() == 0);
+  REQUIRE(sccs.back() == 0);
+  REQUIRE(graph.getDepthFirstOrder(0).size() == (size_t)numNodes);
+  REQUIRE(graph.getReachableNodes(numNodes / 2).test(0));
+}
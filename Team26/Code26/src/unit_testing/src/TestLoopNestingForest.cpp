@@ -0,0 +1,88 @@
+#include "catch.hpp"
+
+#include <utility>
+#include <vector>
+
+#include "Cfg.h"
+#include "LoopNestingForest.h"
+
+namespace {
+  /**
+   * Builds the forest of the program
+   *   procedure p {
+   *   1   x = 1;
+   *   2   while (x > 0) {
+   *   3     if (x > 1) then {
+   *   4       x = x - 1; }
+   *         else {
+   *   5       x = x - 2;
+   *   6       y = x; } }
+   *   7   if (y > 0) then {
+   *   8     z = 1; }
+   *       else {
+   *   9     z = 2; }
+   *  10   print z; }
+   *   procedure q {
+   *  11   read x;
+   *  12   print x; }
+   */
+  Cfg::LoopNestingForest buildForest() {
+    Cfg::Cfg cfg;
+    const std::vector<std::pair<int, int>> edges = {
+      { 1, 2 }, { 2, 3 }, { 2, 7 }, { 3, 4 }, { 3, 5 }, { 4, 2 }, { 5, 6 }, { 6, 2 },
+      { 7, 8 }, { 7, 9 }, { 8, 10 }, { 9, 10 }, { 11, 12 }
+    };
+    for (const std::pair<int, int>& edge : edges) {
+      cfg.addEdge(edge.first, edge.second);
+    }
+    cfg.freeze();
+
+    const std::vector<int> stmtToParent = { 0, 0, 0, 2, 3, 3, 3, 0, 7, 7, 0, 0, 0 };
+    return Cfg::LoopNestingForest(cfg, stmtToParent, { 1, 11 });
+  }
+}
+
+TEST_CASE("LoopNestingForest checks Next*", "[LoopNestingForest]") {
+  const Cfg::LoopNestingForest forest = buildForest();
+
+  REQUIRE(forest.isNextT(1, 10));
+  REQUIRE(!forest.isNextT(1, 1));
+  REQUIRE(forest.isNextT(4, 4));
+  REQUIRE(forest.isNextT(4, 5));
+  REQUIRE(forest.isNextT(6, 3));
+  REQUIRE(!forest.isNextT(8, 9));
+  REQUIRE(!forest.isNextT(9, 8));
+  REQUIRE(forest.isNextT(8, 10));
+  REQUIRE(!forest.isNextT(10, 11));
+  REQUIRE(forest.isNextT(11, 12));
+  REQUIRE(!forest.isNextT(0, 1));
+  REQUIRE(!forest.isNextT(12, 13));
+}
+
+TEST_CASE("LoopNestingForest enumerates Next* as ranges", "[LoopNestingForest]") {
+  const Cfg::LoopNestingForest forest = buildForest();
+
+  REQUIRE(forest.getNextTRanges(1) == std::vector<Cfg::StmtRange>{ { 2, 10 } });
+  REQUIRE(forest.getNextTRanges(4) == std::vector<Cfg::StmtRange>{ { 2, 6 }, { 7, 10 } });
+  REQUIRE(forest.getNextTRanges(8) == std::vector<Cfg::StmtRange>{ { 10, 10 } });
+  REQUIRE(forest.getNextTRanges(12).empty());
+  REQUIRE(forest.getPrevTRanges(5) == std::vector<Cfg::StmtRange>{ { 1, 1 }, { 2, 6 } });
+  REQUIRE(forest.getPrevTRanges(9) == std::vector<Cfg::StmtRange>{ { 1, 7 } });
+  REQUIRE(forest.getPrevTRanges(11).empty());
+  REQUIRE(forest.getPrevTRanges(12) == std::vector<Cfg::StmtRange>{ { 11, 11 } });
+
+  // Enumeration agrees with the pairwise check
+  std::vector<std::pair<int, int>> enumerated;
+  forest.forEachNextT([&enumerated](int prev, int next) {
+    enumerated.emplace_back(prev, next);
+  });
+  std::vector<std::pair<int, int>> checked;
+  for (int prev = 1; prev <= 12; prev++) {
+    for (int next = 1; next <= 12; next++) {
+      if (forest.isNextT(prev, next)) {
+        checked.emplace_back(prev, next);
+      }
+    }
+  }
+  REQUIRE(enumerated == checked);
+}
@@ -263,11 +263,30 @@ TEST_CASE("[TestPkb] addPatternAssign") {
     pkb.addPatternAssign(5, "x", " x y * ");
     pkb.addPatternAssign(7, "y", " b c * a + ");
     auto dataCopy = pkb.getPatternAssignTable().getData();
-    REQUIRE(dataCopy.count({ pkb.getIntRefFromStmtNum(5), pkb.getIntRefFromEntity("x"), pkb.getIntRefFromEntity(" x y * ") }) == 1);
-    REQUIRE(dataCopy.count({ pkb.getIntRefFromStmtNum(7), pkb.getIntRefFromEntity("y"), pkb.getIntRefFromEntity(" b c * a + ") }) == 1);
+    REQUIRE(dataCopy.count({ pkb.getIntRefFromStmtNum(5), pkb.getIntRefFromEntity("x"), pkb.getExprFromPostfixExpr(" x y * ") }) == 1);
+    REQUIRE(dataCopy.count({ pkb.getIntRefFromStmtNum(7), pkb.getIntRefFromEntity("y"), pkb.getExprFromPostfixExpr(" b c * a + ") }) == 1);
   }
 }
 
+TEST_CASE("[TestPkb] getPatternAssignTableWithSubExpr") {
+  Pkb pkb;
+  pkb.addPatternAssign(5, "x", " x y * ");
+  pkb.addPatternAssign(7, "y", " x y * a + ");
+  pkb.addPatternAssign(8, "y", " x y * a + ");
+  pkb.addPatternAssign(9, "z", " y x * ");
+
+  const int product = pkb.getExprFromPostfixExpr(" x y * ");
+  const Table productTable = pkb.getPatternAssignTableWithSubExpr(product);
+  REQUIRE(productTable.size() == 3);
+  REQUIRE(productTable.contains({ pkb.getIntRefFromStmtNum(5), pkb.getIntRefFromEntity("x"), product }));
+  REQUIRE(productTable.contains({ pkb.getIntRefFromStmtNum(8), pkb.getIntRefFromEntity("y"),
+    pkb.getExprFromPostfixExpr(" x y * a + ") }));
+
+  // Variables are subexpressions too, unlike y + a in (x * y) + a
+  REQUIRE(pkb.getPatternAssignTableWithSubExpr(pkb.getExprFromPostfixExpr(" y ")).size() == 4);
+  REQUIRE(pkb.getPatternAssignTableWithSubExpr(pkb.getExprFromPostfixExpr(" y a + ")).size() == 0);
+}
+
 TEST_CASE("[TestPkb] addPatternIf") {
   Pkb pkb;
 
@@ -294,6 +313,31 @@ TEST_CASE("[TestPkb] addPatternWhile") {
   }
 }
 
+TEST_CASE("[TestPkb] Pattern tables by variable") {
+  Pkb pkb;
+  pkb.addPatternIf(3, "x");
+  pkb.addPatternIf(1, "x");
+  pkb.addPatternIf(1, "y");
+  pkb.addPatternWhile(2, "y");
+  pkb.addPatternAssign(4, "x", " y ");
+  pkb.addPatternAssign(5, "z", " y ");
+  const int x = pkb.getIntRefFromEntity("x");
+  const int y = pkb.getIntRefFromEntity("y");
+  const int z = pkb.getIntRefFromEntity("z");
+
+  const Table ifXTable = pkb.getPatternIfTableWithVars({ x });
+  REQUIRE(ifXTable.size() == 2);
+  REQUIRE(ifXTable.contains({ pkb.getIntRefFromStmtNum(1), x }));
+  REQUIRE(ifXTable.contains({ pkb.getIntRefFromStmtNum(3), x }));
+  REQUIRE(pkb.getPatternIfTableWithVars({ x, y, z }).getData() == pkb.getPatternIfTable().getData());
+  REQUIRE(pkb.getPatternWhileTableWithVars({ x, z }).size() == 0);
+  REQUIRE(pkb.getPatternWhileTableWithVars({ -1 }).size() == 0);
+
+  const Table assignTable = pkb.getPatternAssignLhsTableWithVars({ y, z });
+  REQUIRE(assignTable.size() == 1);
+  REQUIRE(assignTable.contains({ pkb.getIntRefFromStmtNum(5), z }));
+}
+
 TEST_CASE("[TestPkb] addCallProc") {
   Pkb pkb;
 
@@ -374,6 +418,7 @@ TEST_CASE("[TestPkb] CFG edges/Next") {
   pkb.addCfgEdge(1, 3);
   pkb.addCfgEdge(1, 4);
   pkb.addCfgEdge(4, 5);
+  pkb.freezeCfg();
 
   SECTION("Next relations") {
     Table nextTable = pkb.getNextTable();
@@ -385,8 +430,8 @@ TEST_CASE("[TestPkb] CFG edges/Next") {
   }
 
   SECTION("getNextStmtsFromCfg") {
-    std::vector<int> neighbours1 = pkb.getNextStmtsFromCfg(1);
-    std::vector<int> neighbours4 = pkb.getNextStmtsFromCfg(4);
+    Span<int> neighbours1 = pkb.getNextStmtsFromCfg(1);
+    Span<int> neighbours4 = pkb.getNextStmtsFromCfg(4);
     REQUIRE(std::find(neighbours1.begin(), neighbours1.end(), 2) != neighbours1.end());
     REQUIRE(std::find(neighbours1.begin(), neighbours1.end(), 3) != neighbours1.end());
     REQUIRE(std::find(neighbours1.begin(), neighbours1.end(), 4) != neighbours1.end());
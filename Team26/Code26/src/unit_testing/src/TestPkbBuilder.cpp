@@ -0,0 +1,70 @@
+#include "catch.hpp"
+
+#include <string>
+#include <vector>
+
+#include "Pkb.h"
+#include "PkbBuilder.h"
+#include "Table.h"
+
+TEST_CASE("[TestPkbBuilder] Facts are loaded on build") {
+  Pkb pkb;
+  PkbBuilder builder(pkb);
+  const int x = builder.addEntity("x");
+  const int mainProc = builder.addEntity("main");
+  builder.addProc(mainProc);
+  builder.addVar(x);
+  builder.addVar(x);
+  builder.addAssign(1);
+  builder.addRead(2);
+  builder.addReadVar(2, x);
+  builder.addFollows(1, 2);
+  builder.addModifiesS(1, x);
+  builder.addModifiesS(2, x);
+  builder.addModifiesS(1, x);
+  builder.addModifiesP(mainProc, x);
+  const int xPlusOne = builder.addExprOperator('+', builder.addExprLeaf(x), builder.addExprLeaf(builder.addEntity("1")));
+  builder.addPatternAssign(1, x, xPlusOne);
+  builder.addCfgEdge(1, 2);
+
+  REQUIRE(pkb.getVarTable().size() == 0);
+  REQUIRE(pkb.getModifiesSTable().size() == 0);
+
+  builder.build();
+  pkb.freezeCfg();
+
+  REQUIRE(pkb.getVarTable().size() == 1);
+  REQUIRE(pkb.getVarIntRefs().count(x) == 1);
+  REQUIRE(pkb.getProcIntRefs().count(mainProc) == 1);
+  REQUIRE(pkb.getStmtTable().size() == 2);
+  REQUIRE(pkb.getAssignIntRefs().count(pkb.getIntRefFromStmtNum(1)) == 1);
+  REQUIRE(pkb.getReadIntRefs().count(pkb.getIntRefFromStmtNum(2)) == 1);
+  REQUIRE(pkb.getVarNameFromReadStmtIntRef(pkb.getIntRefFromStmtNum(2)) == "x");
+  REQUIRE(pkb.getFollowsTable().contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(2) }));
+  REQUIRE(pkb.getModifiesSTable().size() == 2);
+  REQUIRE(pkb.getModifiesPTable().contains({ mainProc, x }));
+  REQUIRE(pkb.getPatternAssignTable().contains({ pkb.getIntRefFromStmtNum(1), x, xPlusOne }));
+  REQUIRE(pkb.getExprFromPostfixExpr(" x 1 + ") == xPlusOne);
+  REQUIRE(pkb.getNextTable().contains({ pkb.getIntRefFromStmtNum(1), pkb.getIntRefFromStmtNum(2) }));
+  REQUIRE(pkb.getNextStmtsFromCfg(1).size() == 1);
+}
+
+TEST_CASE("[TestPkbBuilder] Builds add to the facts already in the Pkb") {
+  Pkb pkb;
+  pkb.addUsesS(1, "x");
+
+  PkbBuilder builder(pkb);
+  const int x = builder.addEntity("x");
+  const int y = builder.addEntity("y");
+  builder.addUsesS(1, x);
+  builder.addUsesS(1, y);
+  builder.build();
+  builder.addUsesS(2, y);
+  builder.build();
+
+  const Table usesSTable = pkb.getUsesSTable();
+  REQUIRE(usesSTable.size() == 3);
+  REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(1), x }));
+  REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(1), y }));
+  REQUIRE(usesSTable.contains({ pkb.getIntRefFromStmtNum(2), y }));
+}
@@ -0,0 +1,48 @@
+#include "catch.hpp"
+
+#include <string>
+#include <vector>
+
+#include "Profiler.h"
+
+namespace {
+  struct FakeSource {
+    size_t rows = 0;
+
+    Profiler::TableSizes getTableSizes() const {
+      return { { "grownTable", rows }, { "fixedTable", 1 } };
+    }
+  };
+}
+
+TEST_CASE("Profiler", "[Profiler]") {
+  FakeSource source;
+
+  SECTION("Disabled profiler only runs phases") {
+    Profiler profiler;
+    bool isRun = false;
+    profiler.measure("phase", source, [&isRun]() { isRun = true; });
+    REQUIRE(isRun);
+    REQUIRE(profiler.getPhases().empty());
+  }
+
+  SECTION("Enabled profiler records phases and rows added") {
+    Profiler profiler(true);
+    profiler.measure("first", source, [&source]() { source.rows += 3; });
+    profiler.measure("second", source, []() {});
+
+    const std::vector<Profiler::Phase>& phases = profiler.getPhases();
+    REQUIRE(phases.size() == 2);
+    REQUIRE(phases[0].name == "first");
+    REQUIRE(phases[0].wallMs >= 0);
+    REQUIRE(phases[0].rowsAdded == Profiler::TableSizes{ { "grownTable", 3 } });
+    REQUIRE(phases[1].name == "second");
+    REQUIRE(phases[1].rowsAdded.empty());
+
+    const std::string& json = profiler.toJson();
+    REQUIRE(json.find("\"name\": \"first\"") != std::string::npos);
+    REQUIRE(json.find("\"grownTable\": 3") != std::string::npos);
+    REQUIRE(json.find("\"fixedTable\"") == std::string::npos);
+    REQUIRE(json.find("\"totalWallMs\"") != std::string::npos);
+  }
+}
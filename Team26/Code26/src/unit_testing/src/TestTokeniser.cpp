@@ -1,12 +1,18 @@
 #include "catch.hpp"
 
+#include <chrono>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <list>
 #include <sstream>
 #include <string>
+#include <vector>
 
+#include "MappedFile.h"
+#include "Span.h"
 #include "Token.h"
+#include "TokenCursor.h"
 #include "Tokeniser.h"
 
 namespace {
@@ -32,6 +38,51 @@ namespace {
   }
 
   Tokeniser tokeniser;
+
+  /**
+   * Generates a syntactically valid SIMPLE program of about the given size.
+   *
+   * @param minSize Minimum number of characters.
+   * @returns Text of the program.
+   */
+  std::string generateProgram(size_t minSize) {
+    std::string program;
+    for (int proc = 0; program.size() < minSize; proc++) {
+      program += "procedure p" + std::to_string(proc) + " {\n";
+      for (int i = 0; i < 100; i++) {
+        program += "  read x" + std::to_string(i) + ";\n"
+          "  while ((x != 0) && (y1 <= 1024)) {\n"
+          "    if (a > b) then { z = (x + 12) * y1 % 7; } else { print z; }\n"
+          "    y1 = y1 - 1 / x;\n"
+          "  }\n";
+      }
+      program += "}\n";
+    }
+    return program;
+  }
+
+  /**
+   * Measures how fast the tokeniser scans the given text and prints it.
+   *
+   * @param name Name of the text in the report.
+   * @param text The text to tokenise.
+   * @param minBytes Minimum number of characters to tokenise in total, repeating the text.
+   */
+  void reportThroughput(const std::string& name, const std::string& text, size_t minBytes) {
+    const Span<char> span(text.data(), text.data() + text.size());
+    const size_t repeats = minBytes / text.size() + 1;
+    size_t numTokens = 0;
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repeats; i++) {
+      numTokens += Tokeniser().consumingWhitespace().tokenise(span).size();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    const double megabytes = (double)(text.size() * repeats) / (1024 * 1024);
+    std::cout << name << ": " << megabytes / elapsed.count() << " MB/s, "
+      << numTokens / repeats << " tokens" << std::endl;
+  }
 }
 
 TEST_CASE("[TestTokeniser] Delimiter, single") {
@@ -184,4 +235,82 @@ TEST_CASE("[TestTokeniser] Whitespace character preserved") {
 
     ++expectedValuesItr;
   }
-}
\ No newline at end of file
+}
+
+TEST_CASE("[TestTokeniser] Tokens scanned in place point into the text") {
+  const std::string text = "x = 01;\n  if (x>=y) {";
+  const Span<char> span(text.data(), text.data() + text.size());
+  std::vector<SourceToken> tokens = Tokeniser().allowingLeadingZeroes().tokenise(span);
+
+  REQUIRE(tokens.size() == 11);
+  REQUIRE(tokens[2].type == TokenType::NUMBER);
+  REQUIRE(tokens[2].getValue(span) == "01");
+  REQUIRE(tokens[2].offset == 4);
+  REQUIRE(tokens[2].line == 1);
+  REQUIRE(tokens[2].column == 5);
+  REQUIRE(tokens[4].getValue(span) == "if");
+  REQUIRE(tokens[4].line == 2);
+  REQUIRE(tokens[4].column == 3);
+  REQUIRE(tokens[7].toToken(span) == Token{ TokenType::OPERATOR, ">=" });
+
+  REQUIRE_THROWS_AS(Tokeniser().notAllowingLeadingZeroes().tokenise(span), TokeniserException);
+
+  // Letters outside of ASCII are not recognised
+  const std::string accented = "caf\xc3\xa9";
+  REQUIRE_THROWS_AS(tokeniser.tokenise(Span<char>(accented.data(), accented.data() + 5)),
+    TokeniserException);
+}
+
+TEST_CASE("[TestTokeniser] Token cursor") {
+  const std::string text = "read x; }";
+  const Span<char> span(text.data(), text.data() + text.size());
+  TokenCursor cursor(span, Tokeniser().consumingWhitespace());
+
+  REQUIRE(cursor.peek() == Token{ TokenType::IDENTIFIER, "read" });
+  REQUIRE(cursor.peek(1) == Token{ TokenType::IDENTIFIER, "x" });
+  cursor.advance();
+  cursor.advance();
+  REQUIRE(cursor.peek() == Token{ TokenType::DELIMITER, ";" });
+  REQUIRE(cursor.hasToken(1));
+  cursor.advance();
+  REQUIRE_FALSE(cursor.hasToken(1));
+  cursor.advance();
+  REQUIRE_FALSE(cursor.hasToken());
+
+  // Tokens past the look-ahead are not tokenised yet
+  const std::string invalid = "x = 1; $";
+  TokenCursor invalidCursor(Span<char>(invalid.data(), invalid.data() + invalid.size()),
+    Tokeniser().consumingWhitespace());
+  REQUIRE(invalidCursor.peek(1) == Token{ TokenType::OPERATOR, "=" });
+  invalidCursor.advance();
+  invalidCursor.advance();
+  invalidCursor.advance();
+  REQUIRE_THROWS_AS(invalidCursor.hasToken(1), TokeniserException);
+}
+
+TEST_CASE("[TestTokeniser] Mapped file") {
+  const std::string path = "TestTokeniserMappedFile.txt";
+  std::ofstream(path) << "procedure p {\n  read x; }";
+
+  {
+    const MappedFile file(path);
+    REQUIRE(file.isOpen());
+    std::stringstream stream("procedure p {\n  read x; }");
+    const std::vector<SourceToken> tokens = tokeniser.consumingWhitespace().tokenise(file.getText());
+    REQUIRE(Tokeniser::toTokens(file.getText(), tokens) == tokeniser.tokenise(stream));
+  }
+  std::remove(path.c_str());
+
+  REQUIRE_FALSE(MappedFile(path).isOpen());
+}
+
+// Hidden from the default run; run with `unit_testing [benchmark]`
+TEST_CASE("[TestTokeniser] Throughput", "[.][benchmark]") {
+  const size_t minBytes = 64 * 1024 * 1024;
+  for (const std::string name : { "Stress100Procs", "StressDeepNesting", "StressLong" }) {
+    const MappedFile file(std::string(SPA_TESTS_DIR) + "/" + name + "_source.txt");
+    REQUIRE(file.isOpen());
+    reportThroughput(name, std::string(file.getText().begin(), file.getText().end()), minBytes);
+  }
+  reportThroughput("Synthetic", generateProgram(16 * 1024 * 1024), minBytes);
+}